@@ -0,0 +1,112 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/TextIOWithStream.hpp"
+#include "ControlPlane/StaticSchema.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Text;
+using namespace ControlPlane::Util;
+
+/** The same device as ControlPlaneExampleTextSchema, with its layout fixed at compile time.
+ *  The storage object and the descriptions are template arguments, so they need external linkage.
+ */
+struct InputProcessing
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct OutputProcessing
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct ProcessingSnapshot
+{
+    InputProcessing m_input[8];
+    OutputProcessing m_output[24];
+};
+
+ProcessingSnapshot processing_settings;
+
+extern constexpr StaticControlInfo gain_info{"gain", "Gain", AVDECC_AEM_CONTROL_TYPE_GAIN, AVDECC_CONTROL_VALUE_LINEAR_INT32};
+extern constexpr StaticControlInfo mute_info{"mute", "Mute", AVDECC_AEM_CONTROL_TYPE_MUTE, AVDECC_CONTROL_VALUE_LINEAR_UINT8};
+extern constexpr StaticChannelGroupInfo input_info{"input", "Input"};
+extern constexpr StaticChannelGroupInfo output_info{"output", "Output"};
+
+using InputGroup = StaticChannelGroup<ProcessingSnapshot,
+                                      processing_settings,
+                                      InputProcessing,
+                                      8,
+                                      &ProcessingSnapshot::m_input,
+                                      input_info,
+                                      StaticControl<InputProcessing, Gain, &InputProcessing::m_gain, gain_info>,
+                                      StaticControl<InputProcessing, Mute, &InputProcessing::m_mute, mute_info> >;
+
+using OutputGroup = StaticChannelGroup<ProcessingSnapshot,
+                                       processing_settings,
+                                       OutputProcessing,
+                                       24,
+                                       &ProcessingSnapshot::m_output,
+                                       output_info,
+                                       StaticControl<OutputProcessing, Gain, &OutputProcessing::m_gain, gain_info>,
+                                       StaticControl<OutputProcessing, Mute, &OutputProcessing::m_mute, mute_info> >;
+
+using ExampleLayout = StaticSchemaLayout<InputGroup, OutputGroup>;
+
+bool testInteractiveTextConsole( Schema &schema, ControlIdentityComparatorPtr write_access )
+{
+    std::istringstream inputs;
+
+    inputs.str(
+        "\n"
+        "/input/\\d+/gain\n"
+        "+/input/1/mute\n"
+        "+/input/2/mute\n"
+        "+/input/3/mute\n"
+        ":sleep\n"
+        "?/input/1/mute\n"
+        "?/input/1/gain\n"
+        "/input/\\d+/mute\n"
+        "+/input/\\d+/gain\n"
+        "+\n"
+        "/input/1/gain=-50.0\n"
+        "/input/1/gain\n"
+        "+/input/\\d+/mute\n"
+        ":sleep\n"
+        "+/input/2/mute\n"
+        "/input/2/mute=1\n"
+        "/input/2/gain=-10\n"
+        "/input/1/gain=-40.0\n"
+        ":sleep\n"
+        "-/input/\\d+/gain\n"
+        ":sleep\n"
+        ":exit\n" );
+
+    std::ostringstream result;
+
+    interactiveTextConsole( result, inputs, schema, write_access, true );
+
+    std::cout << result.str() << std::endl;
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    bool r = true;
+    {
+        ControlIdentityComparatorSetPtr write_access = std::make_shared<ControlIdentityComparatorSet>();
+
+        Schema schema( ExampleLayout::getTable() );
+        if ( argc > 1 )
+        {
+            interactiveTextConsole( std::cout, std::cin, schema, write_access );
+        }
+        else
+        {
+            testInteractiveTextConsole( schema, write_access );
+        }
+    }
+    return r;
+}
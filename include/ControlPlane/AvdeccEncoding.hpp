@@ -87,6 +87,26 @@ inline unsigned short integer_pow10( unsigned short &r, T2 exponent )
     return r;
 }
 
+///
+/// \brief pow10Double
+///
+/// The value of 10^exponent for a non negative exponent, at compile time.
+/// Every power up to 10^22 is exact in a double.
+///
+constexpr double pow10Double( int exponent ) { return exponent <= 0 ? 1.0 : 10.0 * pow10Double( exponent - 1 ); }
+
+///
+/// \brief pow10Constant
+///
+/// The value of 10^exponent for a non negative exponent as type T, at compile
+/// time. A float is rounded once from the exact double, as a literal is.
+///
+template <typename T>
+constexpr T pow10Constant( int exponent )
+{
+    return T( pow10Double( exponent ) );
+}
+
 ///
 /// \brief getEncodingMultiplier
 ///
@@ -193,6 +213,19 @@ enum class EncodingType : uint8_t
     ENCODING_STRING64
 };
 
+///
+/// \brief isEncodingTypeString
+/// \return true if t is one of the string encodings
+///
+bool isEncodingTypeString( EncodingType t );
+
+///
+/// \brief getEncodingTypeSize
+/// \return the number of bytes of a numeric encoding, or the maximum number
+///         of characters of a string encoding
+///
+size_t getEncodingTypeSize( EncodingType t );
+
 ///
 /// \brief EncodingTypeFor template traits class
 ///
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "World.hpp"
+#include "RangedValue.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// Conversion of arrays of float values to and from arrays of big endian
+/// int32 encoded values, the wire format of a bank of gains or of the
+/// control points of a matrix, many values at a time.
+///
+/// The kernels use AVX2 when the processor has it, otherwise SSE2 on x86,
+/// otherwise plain C++. Every kernel gives the same result, bit for bit, as
+/// RangedValue::getEncodedValue() and setFromEncodedValue() do for one
+/// value. The encoded output and input may have any alignment.
+///
+
+enum class BulkEncodingKernel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+///
+/// \brief getBulkEncodingKernel
+/// \return the kernel which the bulk functions use
+///
+BulkEncodingKernel getBulkEncodingKernel();
+
+///
+/// \brief setBulkEncodingKernel
+///
+/// Use kernel, or the next slower one which is compiled in and which the
+/// processor has if kernel is not, for comparing the kernels in tests and
+/// benchmarks
+///
+/// \return the kernel now in use
+///
+BulkEncodingKernel setBulkEncodingKernel( BulkEncodingKernel kernel );
+
+///
+/// \brief encodeInt32BigEndian
+///
+/// Multiply count values by multiplier and divide by divider, clamp to the
+/// range min_encoded to max_encoded, round half away from zero as roundf()
+/// does and store each as a big endian int32 at dest, which must hold
+/// 4 * count octets
+///
+void encodeInt32BigEndian( uint8_t *dest,
+                           float const *values,
+                           size_t count,
+                           float multiplier,
+                           float divider,
+                           int32_t min_encoded,
+                           int32_t max_encoded );
+
+///
+/// \brief decodeInt32BigEndian
+///
+/// Convert count big endian int32 values at src to float, multiplied by
+/// multiplier and divided by divider
+///
+void decodeInt32BigEndian( float *values, uint8_t const *src, size_t count, float multiplier, float divider );
+
+///
+/// The number of values gathered from or scattered to RangedValue objects
+/// on the stack per call of a kernel
+///
+static const size_t bulk_encoding_chunk = 256;
+
+///
+/// \brief encodeRangedValuesInt32BigEndian
+///
+/// Encode count RangedValues of one type, for example a std::array of Gain,
+/// to big endian int32 at dest, which must hold 4 * count octets. The values
+/// are read with the non virtual RangedT::getValue().
+///
+template <typename RangedT>
+void encodeRangedValuesInt32BigEndian( uint8_t *dest, RangedT const *values, size_t count )
+{
+    static_assert( std::is_same<typename RangedT::value_type, float>::value, "the value type must be float" );
+    static_assert( std::is_same<typename RangedT::encoded_type, int32_t>::value, "the encoded type must be int32_t" );
+
+    float chunk[bulk_encoding_chunk];
+    for ( size_t first = 0; first < count; first += bulk_encoding_chunk )
+    {
+        size_t n = std::min( count - first, bulk_encoding_chunk );
+        for ( size_t i = 0; i < n; ++i )
+        {
+            chunk[i] = values[first + i].getValue();
+        }
+        encodeInt32BigEndian( dest + first * 4,
+                              chunk,
+                              n,
+                              RangedT::encoding_multiplier,
+                              RangedT::encoding_divider,
+                              int32_t( RangedT::min_value ),
+                              int32_t( RangedT::max_value ) );
+    }
+}
+
+///
+/// \brief decodeRangedValuesInt32BigEndianWithClamp
+///
+/// Set count RangedValues of one type from big endian int32 at src, clamping
+/// each to its range as setFromEncodedValueWithClamp() does
+///
+/// \return the number of values which changed
+///
+template <typename RangedT>
+size_t decodeRangedValuesInt32BigEndianWithClamp( RangedT *values, uint8_t const *src, size_t count )
+{
+    static_assert( std::is_same<typename RangedT::value_type, float>::value, "the value type must be float" );
+    static_assert( std::is_same<typename RangedT::encoded_type, int32_t>::value, "the encoded type must be int32_t" );
+
+    size_t r = 0;
+    float chunk[bulk_encoding_chunk];
+    for ( size_t first = 0; first < count; first += bulk_encoding_chunk )
+    {
+        size_t n = std::min( count - first, bulk_encoding_chunk );
+        decodeInt32BigEndian( chunk, src + first * 4, n, RangedT::decoding_multiplier, RangedT::decoding_divider );
+        for ( size_t i = 0; i < n; ++i )
+        {
+            // most of a bank is usually unchanged, and a read is much cheaper than the atomic exchange of a write
+            if ( values[first + i].getValue() != chunk[i] )
+            {
+                r += values[first + i].setValueWithClamp( chunk[i] ) ? 1 : 0;
+            }
+        }
+    }
+    return r;
+}
+}
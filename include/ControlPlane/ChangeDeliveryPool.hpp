@@ -0,0 +1,136 @@
+#pragma once
+
+#include "World.hpp"
+#include "SpscRing.hpp"
+#include "ChangeNotificationState.hpp"
+#include "ChangeNotifierStats.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The ChangeDeliveryBatch struct
+///
+/// One notification which tick() has found to be due: the callback of the
+/// subscription and the changed controls to pass to it
+///
+struct ChangeDeliveryBatch
+{
+    Milliseconds m_time_in_milliseconds;
+    ControlIdentityComparatorPtr m_comparator;
+    ChangeNotificationCallback m_callback;
+    ControlIdentityBitmap m_changed_items;
+
+    /// the stats of the notifier and when the first of the changes was reported, if it keeps stats
+    ChangeNotifierStatsPtr m_stats;
+    std::chrono::steady_clock::time_point m_first_change_clock;
+};
+
+///
+/// \brief The ChangeDeliveryQueue class
+///
+/// The batches of one ChangeNotifier waiting to be delivered. The notifier's
+/// tick() is the only producer and at most one ChangeDeliveryPool worker at
+/// a time is the consumer, so the callbacks of one notifier run in order and
+/// never concurrently.
+///
+class ChangeDeliveryQueue
+{
+  public:
+    explicit ChangeDeliveryQueue( size_t capacity )
+        : m_ring( capacity ), m_scheduled( false ), m_closed( false ), m_callback_failures( 0 )
+    {
+    }
+
+    ///
+    /// \brief push
+    ///
+    /// Called by the producer only
+    ///
+    /// \return false if the queue is full, which leaves batch unchanged
+    ///
+    bool push( ChangeDeliveryBatch &&batch ) { return !m_closed && m_ring.push( std::move( batch ) ); }
+
+    bool empty() const { return m_ring.empty(); }
+
+    size_t size() const { return m_ring.size(); }
+
+    ///
+    /// \brief getCallbackFailures
+    /// \return the number of callbacks which threw an exception, which deliver() caught
+    ///
+    uint64_t getCallbackFailures() const { return m_callback_failures.load( std::memory_order_relaxed ); }
+
+    ///
+    /// \brief deliver
+    ///
+    /// Called by the consumer only. Run the callbacks of every queued batch.
+    ///
+    void deliver();
+
+    ///
+    /// \brief close
+    ///
+    /// Drop the queued batches and wait for a callback in progress on another thread to return
+    ///
+    void close();
+
+  private:
+    friend class ChangeDeliveryPool;
+
+    SpscRing<ChangeDeliveryBatch> m_ring;
+
+    /// set while the queue is in the ready list of the pool or being delivered
+    std::atomic<bool> m_scheduled;
+
+    std::atomic<bool> m_closed;
+
+    std::atomic<uint64_t> m_callback_failures;
+
+    /// held by the consumer while it runs callbacks, so that close() can wait for them
+    std::recursive_mutex m_delivery_mutex;
+};
+
+using ChangeDeliveryQueuePtr = shared_ptr<ChangeDeliveryQueue>;
+
+///
+/// \brief The ChangeDeliveryPool class
+///
+/// Worker threads which run the callbacks of asynchronous ChangeNotifiers,
+/// so that a slow subscriber does not stall tick() or the other subscribers.
+///
+/// A queue with batches is put in the ready list once; the worker which
+/// takes it delivers every batch it holds, then puts it back if more
+/// arrived meanwhile.
+///
+class ChangeDeliveryPool
+{
+  public:
+    explicit ChangeDeliveryPool( size_t num_threads = 1 );
+
+    ~ChangeDeliveryPool();
+
+    ChangeDeliveryPool( ChangeDeliveryPool const & ) = delete;
+    ChangeDeliveryPool &operator=( ChangeDeliveryPool const & ) = delete;
+
+    ///
+    /// \brief schedule
+    ///
+    /// Put the queue in the ready list unless it is already there or being delivered
+    ///
+    void schedule( ChangeDeliveryQueuePtr const &queue );
+
+    size_t getNumThreads() const { return m_threads.size(); }
+
+  private:
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::deque<ChangeDeliveryQueuePtr> m_ready;
+    std::mutex m_ready_mutex;
+    std::condition_variable m_ready_condition;
+    bool m_stopping;
+};
+
+using ChangeDeliveryPoolPtr = shared_ptr<ChangeDeliveryPool>;
+}
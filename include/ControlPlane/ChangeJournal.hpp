@@ -0,0 +1,85 @@
+#pragma once
+
+#include "World.hpp"
+#include "ControlIdentity.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The ChangeJournal class
+///
+/// A bounded ring of the most recent control changes of a Schema. Every
+/// change is given the next value of a monotonic sequence number, starting
+/// at 1, and is recorded by the identity of the control only.
+///
+/// A subscriber which remembers the last sequence number it has seen can
+/// ask for only the changes after it with readSince(), for instance after
+/// reconnecting, instead of reading every control again. Once more than
+/// the capacity of changes have been recorded after that sequence number
+/// the older ones are gone, and the subscriber has to read everything.
+///
+/// The values are not recorded, so that journaling stays cheap on every
+/// change; a subscriber reads the current value of each control it is
+/// given, which is the value it needs to catch up.
+///
+class ChangeJournal
+{
+  public:
+    struct Entry
+    {
+        uint64_t m_sequence;
+        ControlIdentityKey m_key;
+    };
+
+    explicit ChangeJournal( size_t capacity = 4096 ) : m_entries( std::max( capacity, size_t( 1 ) ) ), m_sequence( 0 ) {}
+
+    ///
+    /// \brief record
+    ///
+    /// Record a change of the control key
+    ///
+    /// \return the sequence number of the change
+    ///
+    uint64_t record( ControlIdentityKey key );
+
+    ///
+    /// \brief record
+    ///
+    /// Record a change of each of the controls in items, in order
+    ///
+    /// \return the sequence number of the last change
+    ///
+    uint64_t record( ControlIdentitySet const &items );
+
+    ///
+    /// \brief readSince
+    ///
+    /// Get the changes recorded after sequence, in sequence order. When
+    /// coalesce is true only the last change of each control is given.
+    ///
+    /// \param sequence The last sequence number the subscriber has seen, or 0 for none
+    /// \param entries Receives the changes
+    /// \param last_sequence Receives the sequence number to resume from next time
+    /// \param coalesce true to give only the last change of each control
+    /// \return false if changes after sequence have already been dropped from the ring, or
+    ///         sequence is newer than any change, in which case entries is left empty
+    ///
+    bool readSince( uint64_t sequence, std::vector<Entry> &entries, uint64_t &last_sequence, bool coalesce = true ) const;
+
+    ///
+    /// \brief getSequence
+    /// \return the sequence number of the last change recorded, or 0 if there has been none
+    ///
+    uint64_t getSequence() const;
+
+    size_t getCapacity() const { return m_entries.size(); }
+
+  private:
+    void recordLocked( ControlIdentityKey key );
+
+    std::vector<Entry> m_entries;
+    uint64_t m_sequence;
+    mutable std::mutex m_mutex;
+};
+}
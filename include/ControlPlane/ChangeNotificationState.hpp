@@ -2,12 +2,13 @@
 
 #include "World.hpp"
 #include "ControlIdentityComparator.hpp"
+#include "ControlIdentityBitmap.hpp"
 
 namespace ControlPlane
 {
 
 using ChangeNotificationCallback
-    = std::function<void(Milliseconds, ControlIdentityComparatorPtr const &, std::set<ControlIdentity> const &)>;
+    = std::function<void(Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &)>;
 
 class ChangeNotificationState
 {
@@ -17,7 +18,20 @@ class ChangeNotificationState
     Milliseconds m_last_change_time_in_milliseconds;
     Milliseconds m_last_change_acknowledged_time_in_milliseconds;
     ChangeNotificationCallback m_callback;
-    std::set<ControlIdentity> m_changed_items;
+    ControlIdentityBitmap m_changed_items;
+
+    /// the identity of the entry in the ChangeNotifier schedule which is still current, or 0 when not scheduled
+    uint64_t m_schedule_id;
+
+    /// when the subscription is next due to be visited by ChangeNotifier::tick
+    Milliseconds m_due_time_in_milliseconds;
+
+    /// how the ChangeNotifier indexed the subscription, and under which keys
+    ControlIdentityComparator::IndexType m_index_type;
+    ControlIdentitySet m_index_keys;
+
+    /// when the first of m_changed_items was reported, if the ChangeNotifier keeps stats
+    std::chrono::steady_clock::time_point m_first_change_clock;
 
     friend std::ostream &operator<<( std::ostream &o, ChangeNotificationState const &v );
 };
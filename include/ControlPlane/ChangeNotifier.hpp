@@ -3,19 +3,93 @@
 #include "World.hpp"
 #include "ControlIdentityComparator.hpp"
 #include "ChangeNotificationState.hpp"
+#include "ChangeDeliveryPool.hpp"
+#include "ChangeNotifierStats.hpp"
+#include "MeterGroup.hpp"
 
 namespace ControlPlane
 {
 
+///
+/// \brief The ChangeNotifier class
+///
+/// Holds subscriptions and calls their callbacks from tick(), when the
+/// changed controls of a subscription are at least its max update period
+/// old, or when its min update period has passed and every control it
+/// covers is refreshed.
+///
+/// Each subscription with pending changes or a periodic refresh has one
+/// current entry in a min-heap ordered by when it is next due, so tick()
+/// only visits the subscriptions which have work to do.
+///
+/// The subscriptions are indexed by the identities or descriptors their
+/// comparators contain, as described by ControlIdentityComparator::getIndexKeys(),
+/// so a changed control only visits the subscriptions which want it.
+///
+/// By default the callbacks are called from tick(). With setDeliveryPool()
+/// tick() only queues the due notifications, and a ChangeDeliveryPool worker
+/// calls the callbacks in order without holding the notifier's mutex.
+///
+/// With setStatsEnabled() the notifier counts the changes it is given and
+/// the subscriptions they match, and measures its callbacks; see
+/// ChangeNotifierStats.
+///
+/// Meter subscriptions bypass the changed control tracking: each one
+/// receives a frame of its MeterGroup every period, sampled from tick()
+/// whatever the min scan period, and its callback is always called from
+/// tick().
+///
 class ChangeNotifier
 {
   public:
     ChangeNotifier( Milliseconds min_scan_period_in_milliseconds = Milliseconds( 30 ) );
 
-    virtual ~ChangeNotifier() {}
+    virtual ~ChangeNotifier();
 
     uint64_t getIdentity() const { return m_identity; }
 
+    ///
+    /// \brief setValueIndex
+    ///
+    /// Use the value index of a Schema to assign the ordinals of the changed
+    /// control bitmaps of the subscriptions. Called by ChangeNotifierManager::addChangeNotifier().
+    ///
+    void setValueIndex( ControlIdentityIndex const *value_index );
+
+    ///
+    /// \brief setDeliveryPool
+    ///
+    /// Deliver the notifications on the workers of pool through a queue of
+    /// queue_capacity batches, or from tick() again if pool is null. When the
+    /// queue is full, a due subscription stays pending and its changes keep
+    /// merging until a later tick() finds room.
+    ///
+    void setDeliveryPool( ChangeDeliveryPoolPtr pool, size_t queue_capacity = 16 );
+
+    ///
+    /// \brief getCallbackFailures
+    /// \return the number of callbacks run by the delivery pool which threw an exception,
+    /// since the pool was set
+    ///
+    uint64_t getCallbackFailures() const;
+
+    ///
+    /// \brief setStatsEnabled
+    ///
+    /// Start keeping stats from zero, or stop keeping them
+    ///
+    void setStatsEnabled( bool enabled );
+
+    bool isStatsEnabled() const;
+
+    ///
+    /// \brief getStats
+    /// \return the stats kept since they were enabled or last reset, or all zero if they are not kept
+    ///
+    ChangeNotifierStats::Snapshot getStats() const;
+
+    void resetStats();
+
     void removeSubscription( ControlIdentityComparatorPtr sub );
 
     void addSubscription( ControlIdentityComparatorPtr sub,
@@ -24,14 +98,90 @@ class ChangeNotifier
                           Milliseconds current_time_in_milliseconds,
                           ChangeNotificationCallback callback );
 
-    void controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity descriptor );
+    ///
+    /// \brief addMeterSubscription
+    ///
+    /// Call callback with a frame of group every period_in_milliseconds,
+    /// starting with the first tick(), replacing any subscription to group
+    ///
+    void addMeterSubscription( MeterGroupPtr group,
+                               Milliseconds period_in_milliseconds,
+                               Milliseconds current_time_in_milliseconds,
+                               MeterFrameCallback callback );
+
+    void removeMeterSubscription( MeterGroupPtr group );
+
+    virtual void controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity descriptor );
 
-    void tick( Milliseconds current_timestamp_in_milliseconds );
+    ///
+    /// \brief controlsChanged
+    ///
+    /// Record a set of changed controls in one pass over the subscriptions
+    ///
+    virtual void controlsChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentitySet const &items );
+
+    virtual void tick( Milliseconds current_timestamp_in_milliseconds );
 
   protected:
     mutable std::recursive_mutex m_access_mutex;
 
   private:
+    using Subscriptions
+        = std::map<ControlIdentityComparatorPtr, ChangeNotificationState, ControlIdentityComparator_compare>;
+    using Subscription = Subscriptions::value_type;
+    using SubscriptionIndex = std::unordered_map<ControlIdentityKey, std::vector<Subscription *> >;
+
+    struct ScheduledNotification
+    {
+        Milliseconds m_due_time_in_milliseconds;
+        uint64_t m_schedule_id;
+        ControlIdentityComparatorPtr m_subscription;
+
+        bool operator>( ScheduledNotification const &other ) const
+        {
+            return m_due_time_in_milliseconds > other.m_due_time_in_milliseconds;
+        }
+    };
+
+    struct MeterSubscription
+    {
+        MeterGroupPtr m_group;
+        Milliseconds m_period_in_milliseconds;
+        Milliseconds m_due_time_in_milliseconds;
+        MeterFrameCallback m_callback;
+    };
+
+    void tickMeters( Milliseconds current_timestamp_in_milliseconds );
+
+    ///
+    /// \brief getDueTime
+    ///
+    /// \return true and the time that tick() must next visit the subscription, or false if there is nothing to do
+    ///
+    static bool getDueTime( ChangeNotificationState const &state, Milliseconds &due_time_in_milliseconds );
+
+    ///
+    /// \brief schedule
+    ///
+    /// Add an entry to the schedule for the subscription if its due time has changed
+    ///
+    void schedule( ControlIdentityComparatorPtr const &sub, ChangeNotificationState &state );
+
+    void indexSubscription( Subscription &sub );
+
+    void unindexSubscription( Subscription &sub );
+
+    ///
+    /// \brief recordChange
+    ///
+    /// Record a changed control in every subscription which contains it
+    ///
+    void recordChange( Milliseconds current_timestamp_in_milliseconds,
+                       ControlIdentityKey key,
+                       ControlIdentity const &control_identity );
+
+    void recordChange( Subscription &sub, Milliseconds current_timestamp_in_milliseconds, ControlIdentityKey key );
+
     static std::atomic<uint64_t> global_identity_count;
 
     uint64_t m_identity;
@@ -39,7 +189,28 @@ class ChangeNotifier
     Milliseconds m_min_scan_period_in_milliseconds;
     Milliseconds m_last_scan_time_in_milliseconds;
 
-    std::map<ControlIdentityComparatorPtr, ChangeNotificationState, ControlIdentityComparator_compare> m_subscriptions;
+    Subscriptions m_subscriptions;
+
+    std::vector<Subscription *> m_all_subscriptions;
+    std::vector<Subscription *> m_scan_subscriptions;
+    SubscriptionIndex m_identity_index;
+    SubscriptionIndex m_descriptor_index;
+
+    std::priority_queue<ScheduledNotification, std::vector<ScheduledNotification>, std::greater<ScheduledNotification> >
+        m_schedule;
+    uint64_t m_schedule_count;
+
+    ControlIdentityIndex const *m_value_index;
+
+    std::vector<MeterSubscription> m_meter_subscriptions;
+
+    ChangeNotifierStatsPtr m_stats;
+
+    /// when the changes being recorded were reported, if stats are kept
+    std::chrono::steady_clock::time_point m_change_clock;
+
+    ChangeDeliveryPoolPtr m_delivery_pool;
+    ChangeDeliveryQueuePtr m_delivery_queue;
 
     friend std::ostream &operator<<( std::ostream &o, const ChangeNotifier &v );
 };
@@ -2,6 +2,8 @@
 
 #include "World.hpp"
 #include "ChangeNotifier.hpp"
+#include "RealtimeChangeIngress.hpp"
+#include "ChangeJournal.hpp"
 
 namespace ControlPlane
 {
@@ -11,7 +13,22 @@ class ChangeNotifierManager
     friend class ChangeNotifierManagerHold;
 
   public:
-    ChangeNotifierManager() : m_hold_count( 0 ) {}
+    ///
+    /// \brief ChangeNotifierManager
+    ///
+    /// \param value_index the value index of the Schema, which assigns the ordinals of the changed control
+    /// bitmaps of the notifiers added
+    /// \param journal_capacity the number of the most recent changes to keep in the journal
+    ///
+    ChangeNotifierManager( ControlIdentityIndex const *value_index = nullptr, size_t journal_capacity = 4096 )
+        : m_hold_count( 0 )
+        , m_stats_enabled( false )
+        , m_held_changes( value_index )
+        , m_held_time_in_milliseconds( 0 )
+        , m_value_index( value_index )
+        , m_journal( journal_capacity )
+    {
+    }
 
     virtual ~ChangeNotifierManager() {}
 
@@ -23,22 +40,92 @@ class ChangeNotifierManager
 
     void controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity descriptor );
 
+    ///
+    /// \brief controlsChanged
+    ///
+    /// Pass a set of changed controls to the notifiers, or while a
+    /// ChangeNotifierManagerHold is alive, add them to the held changes
+    ///
+    void controlsChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentitySet const &items );
+
+    ///
+    /// \brief tick
+    ///
+    /// Drain the real time ingresses into the notifiers, then tick the notifiers unless held
+    ///
     void tick( Milliseconds current_timestamp_in_milliseconds );
 
+    ///
+    /// \brief addRealtimeIngress
+    ///
+    /// Create a ring for one real time thread to report changed controls through without locking
+    ///
+    RealtimeChangeIngressPtr addRealtimeIngress( size_t capacity = 1024 );
+
+    void removeRealtimeIngress( RealtimeChangeIngressPtr const &ingress );
+
+    ///
+    /// \brief setStatsEnabled
+    ///
+    /// Start or stop keeping stats in every notifier, including those added later
+    ///
+    void setStatsEnabled( bool enabled );
+
+    bool isStatsEnabled() const { return m_stats_enabled; }
+
+    ///
+    /// \brief getStats
+    /// \return the sum of the stats of every notifier
+    ///
+    ChangeNotifierStats::Snapshot getStats() const;
+
+    void resetStats();
+
+    ///
+    /// \brief getJournal
+    ///
+    /// Every change passed to controlChanged() or controlsChanged(), including
+    /// those drained from the real time ingresses, is recorded in the journal
+    /// before the notifiers see it
+    ///
+    ChangeJournal const &getJournal() const { return m_journal; }
+
     std::recursive_mutex &getMutex() const { return m_access_mutex; }
 
     std::map<uint64_t, ChangeNotifierPtr> const &getItems() const { return m_items; }
 
   private:
-    void incHoldCount() { ++m_hold_count; }
+    void incHoldCount();
 
-    void decHoldCount() { --m_hold_count; }
+    ///
+    /// \brief decHoldCount
+    ///
+    /// When the last hold is released, pass the held changes to the notifiers as one set
+    ///
+    void decHoldCount();
 
     std::map<uint64_t, ChangeNotifierPtr> m_items;
+    std::vector<RealtimeChangeIngressPtr> m_realtime_ingresses;
+    ControlIdentitySet m_realtime_changes;
     std::atomic<uint32_t> m_hold_count;
+    bool m_stats_enabled;
+    ControlIdentityBitmap m_held_changes;
+    Milliseconds m_held_time_in_milliseconds;
+    ControlIdentityIndex const *m_value_index;
+    ChangeJournal m_journal;
     mutable std::recursive_mutex m_access_mutex;
 };
 
+///
+/// \brief The ChangeNotifierManagerHold class
+///
+/// A scope which coalesces the changes made while it is alive. The changed
+/// controls are recorded once each in a bitmap instead of being passed to
+/// the notifiers, and ticks are skipped. When the last hold is released
+/// the controls are journaled and passed to the notifiers as one set, with
+/// the time of the last change, so each subscription gets one merged
+/// notification for the whole scope.
+///
 class ChangeNotifierManagerHold
 {
     ChangeNotifierManager &m_mgr;
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "World.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The StatsHistogram class
+///
+/// A histogram of unsigned samples in power of two buckets: bucket 0 counts
+/// the samples of 0, and bucket i the samples from 2^(i-1) to 2^i - 1, with
+/// the last bucket taking everything larger. record() is a few relaxed
+/// atomic adds, so it may be called from any thread without a lock.
+///
+class StatsHistogram
+{
+  public:
+    static const size_t num_buckets = 32;
+
+    struct Snapshot
+    {
+        uint64_t m_count;
+        uint64_t m_sum;
+        uint64_t m_max;
+        std::array<uint64_t, num_buckets> m_buckets;
+
+        ///
+        /// \brief getPercentile
+        /// \return the upper bound of the bucket holding the sample at fraction p of the count, or 0 if empty
+        ///
+        uint64_t getPercentile( double p ) const;
+
+        double getMean() const { return m_count ? double( m_sum ) / double( m_count ) : 0.0; }
+
+        Snapshot &operator+=( Snapshot const &other );
+    };
+
+    StatsHistogram() { reset(); }
+
+    StatsHistogram( StatsHistogram const & ) = delete;
+    StatsHistogram &operator=( StatsHistogram const & ) = delete;
+
+    void record( uint64_t v );
+
+    Snapshot getSnapshot() const;
+
+    void reset();
+
+    static size_t getBucket( uint64_t v );
+
+  private:
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+    std::array<std::atomic<uint64_t>, num_buckets> m_buckets;
+};
+
+std::ostream &operator<<( std::ostream &o, StatsHistogram::Snapshot const &v );
+
+///
+/// \brief The ChangeNotifierStats class
+///
+/// The counters and histograms of one ChangeNotifier, kept only while its
+/// instrumentation is enabled:
+///
+///  - changes ingested: controls reported to the notifier as changed
+///  - subscriptions matched: the sum over the changes of the subscriptions each one was recorded in
+///  - callbacks delivered: notifications and meter frames passed to callbacks
+///  - callback duration: the time each callback took, in microseconds
+///  - latency: from the first change of a notification being reported to its callback being called, in microseconds
+///  - queue depth: the batches waiting in the delivery queue after each tick() which queued one
+///
+class ChangeNotifierStats
+{
+  public:
+    struct Snapshot
+    {
+        uint64_t m_changes_ingested;
+        uint64_t m_subscriptions_matched;
+        uint64_t m_callbacks_delivered;
+        StatsHistogram::Snapshot m_callback_duration_in_microseconds;
+        StatsHistogram::Snapshot m_latency_in_microseconds;
+        StatsHistogram::Snapshot m_queue_depth;
+
+        Snapshot &operator+=( Snapshot const &other );
+    };
+
+    ChangeNotifierStats() { reset(); }
+
+    ChangeNotifierStats( ChangeNotifierStats const & ) = delete;
+    ChangeNotifierStats &operator=( ChangeNotifierStats const & ) = delete;
+
+    void changeIngested() { m_changes_ingested.fetch_add( 1, std::memory_order_relaxed ); }
+
+    void subscriptionMatched() { m_subscriptions_matched.fetch_add( 1, std::memory_order_relaxed ); }
+
+    ///
+    /// \brief callbackDelivered
+    ///
+    /// Record a callback which ran from start to end, for changes first reported at first_change,
+    /// or at the default time_point when there is no change to measure the latency of
+    ///
+    void callbackDelivered( std::chrono::steady_clock::time_point first_change,
+                            std::chrono::steady_clock::time_point start,
+                            std::chrono::steady_clock::time_point end );
+
+    void queueDepth( size_t depth ) { m_queue_depth.record( depth ); }
+
+    Snapshot getSnapshot() const;
+
+    void reset();
+
+  private:
+    std::atomic<uint64_t> m_changes_ingested;
+    std::atomic<uint64_t> m_subscriptions_matched;
+    std::atomic<uint64_t> m_callbacks_delivered;
+    StatsHistogram m_callback_duration_in_microseconds;
+    StatsHistogram m_latency_in_microseconds;
+    StatsHistogram m_queue_depth;
+};
+
+using ChangeNotifierStatsPtr = shared_ptr<ChangeNotifierStats>;
+
+std::ostream &operator<<( std::ostream &o, ChangeNotifierStats::Snapshot const &v );
+}
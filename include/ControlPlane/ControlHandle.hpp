@@ -0,0 +1,129 @@
+#pragma once
+
+#include "World.hpp"
+#include "ControlIdentity.hpp"
+#include "ChangeNotifierManager.hpp"
+#include "RealtimeChangeIngress.hpp"
+#include "SharedMutex.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The ControlHandle class
+///
+/// A control resolved once, by Schema::getControlHandle(), to its concrete
+/// RangedValue type. Reads and writes through the handle call the non
+/// virtual getValue() and setValue() of RangedT directly, so they inline
+/// and skip the identity lookup and the virtual setUnencodedValue() calls
+/// of Schema::setValue(). Changes are still reported to the
+/// ChangeNotifierManager.
+///
+/// setValue() and setValueWithClamp() take the Schema's access mutex
+/// exclusively, like Schema::setValue(). getValue() reads without a lock,
+/// so RangedT must use atomic storage, as the scalar and bool values do
+/// by default. A real time thread uses setValueRealtime(), which reports
+/// the change through its RealtimeChangeIngress instead.
+///
+/// A handle is valid for the lifetime of the Schema it came from.
+///
+template <typename RangedT>
+class ControlHandle
+{
+  public:
+    using ranged_value_type = RangedT;
+    using value_type = typename std::decay<decltype( std::declval<RangedT const &>().getValue() )>::type;
+
+    ControlHandle() : m_ranged_value( nullptr ), m_access_mutex( nullptr ), m_change_manager( nullptr ) {}
+
+    ControlHandle( RangedT *ranged_value,
+                   ControlIdentity const &identity,
+                   SharedMutex &access_mutex,
+                   ChangeNotifierManager &change_manager )
+        : m_ranged_value( ranged_value )
+        , m_identity( identity )
+        , m_key( identity )
+        , m_access_mutex( &access_mutex )
+        , m_change_manager( &change_manager )
+    {
+    }
+
+    bool isValid() const { return m_ranged_value != nullptr; }
+
+    ControlIdentity const &getIdentity() const { return m_identity; }
+
+    RangedT &getRangedValue() const { return *m_ranged_value; }
+
+    value_type getValue() const { return m_ranged_value->getValue(); }
+
+    ///
+    /// \brief setValue
+    ///
+    /// throws range_error if the value is out of range
+    ///
+    /// \return true if the value changed
+    ///
+    bool setValue( Milliseconds current_time_in_milliseconds, value_type v )
+    {
+        bool changed = false;
+        {
+            std::lock_guard<SharedMutex> lock( *m_access_mutex );
+            changed = m_ranged_value->setValue( v );
+        }
+        if ( changed )
+        {
+            m_change_manager->controlChanged( current_time_in_milliseconds, m_identity );
+        }
+        return changed;
+    }
+
+    ///
+    /// \brief setValueWithClamp
+    ///
+    /// Set the value, clamped to the range of RangedT
+    ///
+    /// \return true if the value changed
+    ///
+    bool setValueWithClamp( Milliseconds current_time_in_milliseconds, value_type v )
+    {
+        bool changed = false;
+        {
+            std::lock_guard<SharedMutex> lock( *m_access_mutex );
+            changed = m_ranged_value->setValueWithClamp( v );
+        }
+        if ( changed )
+        {
+            m_change_manager->controlChanged( current_time_in_milliseconds, m_identity );
+        }
+        return changed;
+    }
+
+    ///
+    /// \brief setValueRealtime
+    ///
+    /// Called by the real time thread which owns ingress. Write the atomic
+    /// storage without locking and push a change onto ingress, which the
+    /// ChangeNotifierManager drains in its next tick().
+    ///
+    /// throws range_error if the value is out of range
+    ///
+    /// \return true if the value changed
+    ///
+    bool setValueRealtime( RealtimeChangeIngress &ingress, value_type v )
+    {
+        bool changed = m_ranged_value->setValue( v );
+        if ( changed )
+        {
+            ingress.controlChanged( m_key );
+        }
+        return changed;
+    }
+
+  private:
+    RangedT *m_ranged_value;
+    ControlIdentity m_identity;
+    ControlIdentityKey m_key;
+    SharedMutex *m_access_mutex;
+    ChangeNotifierManager *m_change_manager;
+};
+}
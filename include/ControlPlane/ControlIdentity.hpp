@@ -74,4 +74,138 @@ inline bool operator==( ControlIdentity const &lhs, ControlIdentity const &rhs )
 inline bool operator>=( ControlIdentity const &lhs, ControlIdentity const &rhs ) { return compare( lhs, rhs ) >= 0; }
 
 inline bool operator>( ControlIdentity const &lhs, ControlIdentity const &rhs ) { return compare( lhs, rhs ) > 0; }
+
+///
+/// \brief The ControlIdentityKey struct
+///
+/// A ControlIdentity bit-packed into a single uint64_t so that ordering,
+/// equality and hashing are single integer operations. The integer order
+/// of the packed value matches the order of compare() on ControlIdentity.
+///
+/// Packed layout, most significant first:
+///   descriptor_type 8 bits (0xff represents 0xffff), descriptor_index 16 bits,
+///   section 3 bits, item 13 bits, h_pos 12 bits, w_pos 12 bits
+///
+/// Identities with fields outside of these widths are not packable and
+/// convert to the invalid key, which compares greater than every valid key.
+///
+struct ControlIdentityKey
+{
+    static const uint64_t invalid_value = ~uint64_t( 0 );
+
+    constexpr ControlIdentityKey() : m_value( invalid_value ) {}
+
+    ControlIdentityKey( ControlIdentity const &identity )
+        : m_value( isPackable( identity ) ? pack( identity ) : invalid_value )
+    {
+    }
+
+    constexpr explicit ControlIdentityKey( uint64_t value ) : m_value( value ) {}
+
+    static ControlIdentityKey fromValue( uint64_t value ) { return ControlIdentityKey( value ); }
+
+    static bool isPackable( ControlIdentity const &identity )
+    {
+        return ( identity.m_descriptor_type < 0xff || identity.m_descriptor_type == 0xffff )
+               && ( unsigned( identity.m_section ) < 0x7 ) && ( identity.m_item < 0x2000 ) && ( identity.m_h_pos < 0x1000 )
+               && ( identity.m_w_pos < 0x1000 );
+    }
+
+    static uint64_t pack( ControlIdentity const &identity )
+    {
+        return packFields( identity.m_descriptor_type,
+                           identity.m_descriptor_index,
+                           identity.m_section,
+                           identity.m_item,
+                           identity.m_h_pos,
+                           identity.m_w_pos );
+    }
+
+    ///
+    /// \brief packFields
+    ///
+    /// Pack the fields of an identity which is known to be packable, at compile time if the fields are constant
+    ///
+    static constexpr uint64_t packFields( DescriptorType descriptor_type,
+                                          DescriptorIndex descriptor_index,
+                                          ControlIdentity::Section section = ControlIdentity::SectionDescriptorLevel,
+                                          uint16_t item = 0,
+                                          uint16_t h_pos = 0,
+                                          uint16_t w_pos = 0 )
+    {
+        return ( ( descriptor_type == 0xffff ? uint64_t( 0xff ) : uint64_t( descriptor_type ) ) << 56 )
+               | ( uint64_t( descriptor_index ) << 40 ) | ( uint64_t( section ) << 37 ) | ( uint64_t( item ) << 24 )
+               | ( uint64_t( h_pos ) << 12 ) | uint64_t( w_pos );
+    }
+
+    bool isValid() const { return m_value != invalid_value; }
+
+    ///
+    /// \brief getDescriptorKey
+    ///
+    /// \return the key of the descriptor level identity of the same descriptor
+    ///
+    ControlIdentityKey getDescriptorKey() const { return ControlIdentityKey( m_value & ~( ( uint64_t( 1 ) << 40 ) - 1 ) ); }
+
+    uint64_t getValue() const { return m_value; }
+
+    ControlIdentity toIdentity() const
+    {
+        uint16_t descriptor_type = uint16_t( ( m_value >> 56 ) & 0xff );
+        return ControlIdentity( descriptor_type == 0xff ? 0xffff : descriptor_type,
+                                DescriptorIndex( ( m_value >> 40 ) & 0xffff ),
+                                ControlIdentity::Section( ( m_value >> 37 ) & 0x7 ),
+                                uint16_t( ( m_value >> 24 ) & 0x1fff ),
+                                uint16_t( ( m_value >> 12 ) & 0xfff ),
+                                uint16_t( m_value & 0xfff ) );
+    }
+
+    uint64_t m_value;
+};
+
+inline bool operator<( ControlIdentityKey lhs, ControlIdentityKey rhs ) { return lhs.m_value < rhs.m_value; }
+
+inline bool operator<=( ControlIdentityKey lhs, ControlIdentityKey rhs ) { return lhs.m_value <= rhs.m_value; }
+
+inline bool operator==( ControlIdentityKey lhs, ControlIdentityKey rhs ) { return lhs.m_value == rhs.m_value; }
+
+inline bool operator!=( ControlIdentityKey lhs, ControlIdentityKey rhs ) { return lhs.m_value != rhs.m_value; }
+
+inline bool operator>=( ControlIdentityKey lhs, ControlIdentityKey rhs ) { return lhs.m_value >= rhs.m_value; }
+
+inline bool operator>( ControlIdentityKey lhs, ControlIdentityKey rhs ) { return lhs.m_value > rhs.m_value; }
+
+inline std::ostream &operator<<( std::ostream &o, ControlIdentityKey const &v )
+{
+    if ( v.isValid() )
+    {
+        o << v.toIdentity();
+    }
+    else
+    {
+        o << "{ invalid }";
+    }
+    return o;
+}
+
+using ControlIdentitySet = std::set<ControlIdentityKey>;
+}
+
+namespace std
+{
+template <>
+struct hash<ControlPlane::ControlIdentityKey>
+{
+    size_t operator()( ControlPlane::ControlIdentityKey const &v ) const
+    {
+        // 64 bit finalizer from MurmurHash3 to spread the densely packed fields
+        uint64_t h = v.m_value;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return size_t( h );
+    }
+};
 }
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "World.hpp"
+#include "ControlIdentity.hpp"
+#include "ControlIdentityIndex.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The ControlIdentityBitmap class
+///
+/// A set of control identities held as one bit per entry of a Schema's
+/// value index, where the ordinal of an entry is its position in the
+/// index. Inserting an identity which is already covered by the bitmap,
+/// clearing it and iterating over it do not allocate, and insertAll()
+/// fills the whole bitmap at once.
+///
+/// The words only cover the range of ordinals which have been inserted,
+/// so a bitmap holding a few neighbouring controls stays small. Identities
+/// which are not in the index, or every identity when there is no index,
+/// are kept in a ControlIdentitySet after the bitmap.
+///
+/// Iteration is in ControlIdentityKey order for the identities in the index,
+/// followed by the others in order.
+///
+class ControlIdentityBitmap
+{
+  public:
+    class const_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ControlIdentityKey;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ControlIdentityKey const *;
+        using reference = ControlIdentityKey const &;
+
+        const_iterator() : m_bitmap( nullptr ), m_word( 0 ), m_bits( 0 ), m_current( nullptr ) {}
+
+        reference operator*() const { return *m_current; }
+
+        pointer operator->() const { return m_current; }
+
+        const_iterator &operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        const_iterator operator++( int )
+        {
+            const_iterator r = *this;
+            advance();
+            return r;
+        }
+
+        bool operator==( const_iterator const &other ) const { return m_current == other.m_current; }
+
+        bool operator!=( const_iterator const &other ) const { return m_current != other.m_current; }
+
+      private:
+        friend class ControlIdentityBitmap;
+
+        explicit const_iterator( ControlIdentityBitmap const *bitmap );
+
+        void advance();
+
+        ControlIdentityBitmap const *m_bitmap;
+
+        /// the word of the bitmap holding m_bits, or m_bitmap->m_words.size() once in the others set
+        size_t m_word;
+
+        /// the bits of the word which are still to be visited
+        uint64_t m_bits;
+
+        ControlIdentitySet::const_iterator m_other;
+        ControlIdentityKey const *m_current;
+    };
+
+    ControlIdentityBitmap() : ControlIdentityBitmap( nullptr ) {}
+
+    explicit ControlIdentityBitmap( ControlIdentityIndex const *index );
+
+    ///
+    /// \brief setIndex
+    ///
+    /// Change the index which assigns the ordinals, keeping the identities already held
+    ///
+    void setIndex( ControlIdentityIndex const *index );
+
+    ControlIdentityIndex const *getIndex() const { return m_index; }
+
+    void insert( ControlIdentityKey key );
+
+    ///
+    /// \brief insertAll
+    ///
+    /// Insert every identity in the index
+    ///
+    void insertAll();
+
+    ///
+    /// \brief insertEntries
+    ///
+    /// Insert the identities of a run of entries of the index, from first up to but not including last
+    ///
+    void insertEntries( ControlIdentityIndex::Entry const *first, ControlIdentityIndex::Entry const *last );
+
+    void clear();
+
+    bool empty() const { return m_count == 0 && m_others.empty(); }
+
+    size_t size() const { return m_count + m_others.size(); }
+
+    bool contains( ControlIdentityKey key ) const;
+
+    const_iterator begin() const { return const_iterator( this ); }
+
+    const_iterator end() const { return const_iterator(); }
+
+    friend std::ostream &operator<<( std::ostream &o, ControlIdentityBitmap const &v );
+
+  private:
+    void setBit( size_t ordinal );
+
+    ControlIdentityIndex const *m_index;
+
+    /// the bits of the ordinals from m_first_ordinal, 64 per word
+    std::vector<uint64_t> m_words;
+    size_t m_first_ordinal;
+
+    /// the range of words which may have bits set, so that clear() only touches those
+    size_t m_first_dirty_word;
+    size_t m_last_dirty_word;
+
+    /// the number of bits set
+    size_t m_count;
+
+    ControlIdentitySet m_others;
+};
+}
@@ -8,16 +8,83 @@ namespace ControlPlane
 {
 
 class ControlIdentityComparator;
+class ControlIdentityBitmap;
 using ControlIdentityComparatorPtr = std::shared_ptr<ControlIdentityComparator>;
 
 class ControlIdentityComparator
 {
   public:
+    ///
+    /// \brief The IndexType enum
+    ///
+    /// How a ChangeNotifier finds the subscriptions which contain a changed control
+    ///
+    enum class IndexType
+    {
+        /// contains no controls
+        None,
+        /// contains every control
+        All,
+        /// contains exactly the identities filled in by getIndexKeys()
+        Identities,
+        /// contains only controls of the descriptor level identities filled in by getIndexKeys(),
+        /// and containsControl() is asked about each of those
+        Descriptors,
+        /// containsControl() is asked about every changed control
+        Scan
+    };
+
+    ///
+    /// \brief The Kind enum
+    ///
+    /// Orders comparators of different classes in compare(), so that the
+    /// order does not depend on the typeid of the classes
+    ///
+    enum class Kind
+    {
+        None,
+        All,
+        Unique,
+        Set,
+        Range,
+        Prefix,
+        /// a class outside of the library, ordered after the others by typeid
+        Other
+    };
+
     virtual ~ControlIdentityComparator() {}
     virtual bool containsControl( ControlIdentity const &identity ) const = 0;
     virtual void print( std::ostream &o ) const = 0;
-    virtual void fillSet( std::set<ControlIdentity> &items ) const = 0;
+    virtual void fillSet( ControlIdentitySet &items ) const = 0;
     virtual int compare( ControlIdentityComparator const &other ) const = 0;
+
+    virtual Kind getKind() const { return Kind::Other; }
+
+    ///
+    /// \brief getIndexKeys
+    ///
+    /// Describe the controls this comparator contains so that a ChangeNotifier
+    /// can index its subscription. It is called once when the subscription is added.
+    ///
+    /// \param keys filled in with the identities or descriptor level identities, depending on the result
+    /// \return the IndexType
+    ///
+    virtual IndexType getIndexKeys( ControlIdentitySet &keys ) const { return IndexType::Scan; }
+
+    ///
+    /// \brief fillBitmap
+    ///
+    /// Insert every control this comparator contains into items, as fillSet() does
+    ///
+    virtual void fillBitmap( ControlIdentityBitmap &items ) const;
+
+  protected:
+    ///
+    /// \brief compareKind
+    ///
+    /// \return -1, 0 or 1 as the kind of this comparator orders before, the same as or after that of other
+    ///
+    int compareKind( ControlIdentityComparator const &other ) const;
 };
 
 class ControlIdentityComparator_compare
@@ -28,7 +95,7 @@ class ControlIdentityComparator_compare
     {
         bool r = false;
 
-        if ( lhs->compare( *rhs ) == -1 )
+        if ( lhs->compare( *rhs ) < 0 )
         {
             r = true;
         }
@@ -69,7 +136,7 @@ inline bool operator<( const ControlIdentityComparatorPtr &lhs, const ControlIde
 
 class ControlIdentityComparatorUnique : public ControlIdentityComparator
 {
-    ControlIdentity m_identity;
+    ControlIdentityKey m_identity;
 
   public:
     ControlIdentityComparatorUnique( ControlIdentity const &identity );
@@ -78,11 +145,15 @@ class ControlIdentityComparatorUnique : public ControlIdentityComparator
 
     bool containsControl( ControlIdentity const &identity ) const override;
 
-    void fillSet( std::set<ControlIdentity> &items ) const override;
+    void fillSet( ControlIdentitySet &items ) const override;
 
     int compare( ControlIdentityComparator const &other ) const override;
 
+    Kind getKind() const override { return Kind::Unique; }
+
     void print( std::ostream &o ) const override;
+
+    IndexType getIndexKeys( ControlIdentitySet &keys ) const override;
 };
 
 class Schema;
@@ -94,11 +165,15 @@ class ControlIdentityComparatorNone : public ControlIdentityComparator
 
     bool containsControl( ControlIdentity const & ) const override;
 
-    void fillSet( std::set<ControlIdentity> &items ) const override;
+    void fillSet( ControlIdentitySet &items ) const override;
 
     int compare( ControlIdentityComparator const &other ) const override;
 
+    Kind getKind() const override { return Kind::None; }
+
     void print( std::ostream &o ) const override;
+
+    IndexType getIndexKeys( ControlIdentitySet &keys ) const override;
 };
 
 class ControlIdentityComparatorAll : public ControlIdentityComparator
@@ -110,17 +185,29 @@ class ControlIdentityComparatorAll : public ControlIdentityComparator
 
     bool containsControl( ControlIdentity const & ) const override;
 
-    void fillSet( std::set<ControlIdentity> &items ) const override;
+    void fillSet( ControlIdentitySet &items ) const override;
+
+    void fillBitmap( ControlIdentityBitmap &items ) const override;
 
     int compare( ControlIdentityComparator const &other ) const override;
 
+    Kind getKind() const override { return Kind::All; }
+
     void print( std::ostream &o ) const override;
+
+    IndexType getIndexKeys( ControlIdentitySet &keys ) const override;
 };
 
+///
+/// \brief The ControlIdentityComparatorSet class
+///
+/// A ChangeNotifier indexes a subscription by the items of the set when the
+/// subscription is added, so add the subscription again after changing the items.
+///
 class ControlIdentityComparatorSet : public ControlIdentityComparator
 {
     mutable std::recursive_mutex m_mutex;
-    std::set<ControlIdentity> m_items;
+    ControlIdentitySet m_items;
 
   public:
     ControlIdentityComparatorSet() {}
@@ -133,23 +220,134 @@ class ControlIdentityComparatorSet : public ControlIdentityComparator
 
     void addItem( ControlIdentity const &item );
 
-    void addItems( std::set<ControlIdentity> const &items );
+    void addItems( ControlIdentitySet const &items );
 
     void removeItem( ControlIdentity const &item );
 
-    void removeItems( std::set<ControlIdentity> const &items );
+    void removeItems( ControlIdentitySet const &items );
 
     bool containsControl( ControlIdentity const &identity ) const override;
 
-    void fillSet( std::set<ControlIdentity> &items ) const override;
+    void fillSet( ControlIdentitySet &items ) const override;
 
     int compare( ControlIdentityComparator const &other_ ) const override;
 
+    Kind getKind() const override { return Kind::Set; }
+
     void print( std::ostream &o ) const override;
+
+    IndexType getIndexKeys( ControlIdentitySet &keys ) const override;
 };
 
 using ControlIdentityComparatorSetPtr = std::shared_ptr<ControlIdentityComparatorSet>;
 
+///
+/// \brief The ControlIdentityComparatorRange class
+///
+/// Contains the controls of one descriptor type and section whose descriptor
+/// index and item are within inclusive ranges, at any h_pos and w_pos, such as
+/// the items of a block of channels. containsControl() compares the fields,
+/// and fillSet() takes each matching run of keys straight from the schema's
+/// value index.
+///
+class ControlIdentityComparatorRange : public ControlIdentityComparator
+{
+    Schema const &m_schema;
+    DescriptorType m_descriptor_type;
+    DescriptorIndex m_first_index;
+    DescriptorIndex m_last_index;
+    ControlIdentity::Section m_section;
+    uint16_t m_first_item;
+    uint16_t m_last_item;
+
+    /// the largest number of descriptors getIndexKeys() lists before falling back to a scan
+    static const size_t max_indexed_descriptors = 1024;
+
+  public:
+    ///
+    /// \brief ControlIdentityComparatorRange
+    ///
+    /// throws std::range_error if the descriptor type or section can not be packed in a ControlIdentityKey.
+    /// Items past the largest packable item are ignored.
+    ///
+    ControlIdentityComparatorRange( Schema const &schema,
+                                    DescriptorType descriptor_type,
+                                    DescriptorIndex first_index,
+                                    DescriptorIndex last_index,
+                                    ControlIdentity::Section section = ControlIdentity::SectionDescriptorLevel,
+                                    uint16_t first_item = 0,
+                                    uint16_t last_item = 0xffff );
+
+    bool containsControl( ControlIdentity const &identity ) const override;
+
+    void fillSet( ControlIdentitySet &items ) const override;
+
+    void fillBitmap( ControlIdentityBitmap &items ) const override;
+
+    int compare( ControlIdentityComparator const &other ) const override;
+
+    Kind getKind() const override { return Kind::Range; }
+
+    void print( std::ostream &o ) const override;
+
+    IndexType getIndexKeys( ControlIdentitySet &keys ) const override;
+
+  private:
+    template <typename F>
+    void forEachEntry( F f ) const;
+};
+
+///
+/// \brief The ControlIdentityComparatorPrefix class
+///
+/// Contains the controls whose identity starts with the same fields as a
+/// given identity, down to a depth: every control of a descriptor type, of a
+/// descriptor, of a section of a descriptor, or of an item. These are the
+/// keys with the same leading bits, so containsControl() is a mask and
+/// compare, and fillSet() copies one contiguous run of the value index.
+///
+class ControlIdentityComparatorPrefix : public ControlIdentityComparator
+{
+  public:
+    enum class Depth
+    {
+        DescriptorType,
+        DescriptorIndex,
+        Section,
+        Item
+    };
+
+    ///
+    /// \brief ControlIdentityComparatorPrefix
+    ///
+    /// throws std::range_error if the identity can not be packed in a ControlIdentityKey.
+    /// The fields of the identity deeper than depth are ignored.
+    ///
+    ControlIdentityComparatorPrefix( Schema const &schema, ControlIdentity const &identity, Depth depth );
+
+    bool containsControl( ControlIdentity const &identity ) const override;
+
+    void fillSet( ControlIdentitySet &items ) const override;
+
+    void fillBitmap( ControlIdentityBitmap &items ) const override;
+
+    int compare( ControlIdentityComparator const &other ) const override;
+
+    Kind getKind() const override { return Kind::Prefix; }
+
+    void print( std::ostream &o ) const override;
+
+    IndexType getIndexKeys( ControlIdentitySet &keys ) const override;
+
+  private:
+    static uint64_t getMask( Depth depth );
+
+    Schema const &m_schema;
+    Depth m_depth;
+    uint64_t m_mask;
+    uint64_t m_prefix;
+};
+
 inline std::ostream &operator<<( std::ostream &o, ControlIdentityComparatorPtr const &v )
 {
     v->print( o );
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "World.hpp"
+#include "RangedValue.hpp"
+#include "ControlIdentity.hpp"
+
+namespace ControlPlane
+{
+
+namespace Descriptor
+{
+class DescriptorBase;
+}
+
+///
+/// \brief The ControlIdentityIndex class
+///
+/// An immutable, flat lookup table from a ControlIdentity to the
+/// resolved RangedValueBase and DescriptorBase that it refers to.
+///
+/// Entries are added with add() and then compile() sorts them into
+/// one contiguous array keyed by a packed 64 bit form of the
+/// ControlIdentity (see ControlIdentityKey), so that find() is a binary
+/// search over integers instead of a std::map walk.
+///
+/// Alternatively adopt() makes the index refer to an external array which
+/// is already sorted, such as the table generated by a StaticSchemaLayout,
+/// without copying it.
+///
+class ControlIdentityIndex
+{
+  public:
+    struct Entry
+    {
+        ControlIdentityKey m_key;
+        RangedValueBase *m_ranged_value;
+        Descriptor::DescriptorBase *m_descriptor;
+    };
+
+    ///
+    /// \brief The Entries struct
+    ///
+    /// The contiguous range of compiled entries
+    ///
+    struct Entries
+    {
+        Entry const *m_begin;
+        Entry const *m_end;
+
+        Entry const *begin() const { return m_begin; }
+        Entry const *end() const { return m_end; }
+        Entry const *data() const { return m_begin; }
+        size_t size() const { return size_t( m_end - m_begin ); }
+        bool empty() const { return m_begin == m_end; }
+        Entry const &operator[]( size_t i ) const { return m_begin[i]; }
+    };
+
+    ControlIdentityIndex() : m_begin( nullptr ), m_size( 0 ) {}
+
+    ControlIdentityIndex( ControlIdentityIndex const & ) = delete;
+
+    ControlIdentityIndex &operator=( ControlIdentityIndex const & ) = delete;
+
+    void clear();
+
+    ///
+    /// \brief add
+    ///
+    /// Add an entry to the index. The index is not searchable until compile() is called.
+    ///
+    /// throws std::range_error if the identity can not be packed
+    ///
+    void add( ControlIdentityKey key, RangedValueBase *ranged_value, Descriptor::DescriptorBase *descriptor );
+
+    ///
+    /// \brief compile
+    ///
+    /// Sort the entries and remove any duplicate identities, keeping the last one added
+    ///
+    void compile();
+
+    ///
+    /// \brief adopt
+    ///
+    /// Refer to an external array of entries instead of the added ones. The
+    /// entries must already be sorted by key without duplicates, and must
+    /// outlive the index.
+    ///
+    void adopt( Entry const *entries, size_t num_entries );
+
+    ///
+    /// \brief find
+    ///
+    /// \param key The packed ControlIdentity to look up
+    /// \return pointer to the Entry, or nullptr if the identity is not in the index
+    ///
+    Entry const *find( ControlIdentityKey key ) const;
+
+    ///
+    /// \brief lowerBound
+    ///
+    /// \param key The packed ControlIdentity to search for
+    /// \return pointer to the first Entry whose key is not less than key, or the end of the entries
+    ///
+    Entry const *lowerBound( ControlIdentityKey key ) const;
+
+    size_t size() const { return m_size; }
+
+    Entries getEntries() const { return Entries{m_begin, m_begin + m_size}; }
+
+  private:
+    std::vector<Entry> m_entries;
+    Entry const *m_begin;
+    size_t m_size;
+};
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "World.hpp"
+#include "ControlIdentity.hpp"
+#include "RangedValue.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The ControlValueChange class
+///
+/// One entry of a batch of value writes: the identity of the control and
+/// the unencoded value to set it to
+///
+class ControlValueChange
+{
+  public:
+    enum class Kind
+    {
+        Bool,
+        Int64,
+        UInt64,
+        Double,
+        String
+    };
+
+    ControlValueChange() : m_kind( Kind::Double ), m_int( 0 ), m_double( 0.0 ) {}
+
+    ControlValueChange( ControlIdentity const &identity, bool v )
+        : m_identity( identity ), m_kind( Kind::Bool ), m_int( v ? 1 : 0 ), m_double( 0.0 )
+    {
+    }
+
+    ControlValueChange( ControlIdentity const &identity, int64_t v )
+        : m_identity( identity ), m_kind( Kind::Int64 ), m_int( uint64_t( v ) ), m_double( 0.0 )
+    {
+    }
+
+    ControlValueChange( ControlIdentity const &identity, uint64_t v )
+        : m_identity( identity ), m_kind( Kind::UInt64 ), m_int( v ), m_double( 0.0 )
+    {
+    }
+
+    ControlValueChange( ControlIdentity const &identity, int v ) : ControlValueChange( identity, int64_t( v ) ) {}
+
+    ControlValueChange( ControlIdentity const &identity, double v )
+        : m_identity( identity ), m_kind( Kind::Double ), m_int( 0 ), m_double( v )
+    {
+    }
+
+    ControlValueChange( ControlIdentity const &identity, float v ) : ControlValueChange( identity, double( v ) ) {}
+
+    ControlValueChange( ControlIdentity const &identity, string const &v )
+        : m_identity( identity ), m_kind( Kind::String ), m_int( 0 ), m_double( 0.0 ), m_string( v )
+    {
+    }
+
+    ControlValueChange( ControlIdentity const &identity, const char *v ) : ControlValueChange( identity, string( v ) ) {}
+
+    ///
+    /// \brief capture
+    ///
+    /// Make a change which would restore the current value of v
+    ///
+    /// \param identity The identity of the control
+    /// \param v The value to capture
+    /// \return The ControlValueChange
+    ///
+    static ControlValueChange capture( ControlIdentity const &identity, RangedValueBase const &v );
+
+    ///
+    /// \brief applyTo
+    ///
+    /// Set the value. May throw range_error if the value is out of range
+    ///
+    /// \param v The value to set
+    /// \param force true to skip the range check
+    /// \return true if the value changed
+    ///
+    bool applyTo( RangedValueBase &v, bool force = false ) const;
+
+    ///
+    /// \brief validate
+    ///
+    /// Check the value against the range of v without writing it
+    ///
+    /// \param v The value the change would be applied to
+    /// \return false if applyTo( v ) would throw range_error
+    ///
+    bool validate( RangedValueBase const &v ) const;
+
+    ControlIdentity const &getIdentity() const { return m_identity; }
+
+    Kind getKind() const { return m_kind; }
+
+    bool getBool() const { return m_int != 0; }
+
+    int64_t getInt64() const { return int64_t( m_int ); }
+
+    uint64_t getUInt64() const { return m_int; }
+
+    double getDouble() const { return m_double; }
+
+    string const &getString() const { return m_string; }
+
+  private:
+    ControlIdentity m_identity;
+    Kind m_kind;
+    uint64_t m_int;
+    double m_double;
+    string m_string;
+};
+
+std::ostream &operator<<( std::ostream &o, ControlValueChange const &v );
+}
@@ -55,11 +55,14 @@ class Control : public DescriptorBase
 
     virtual uint16_t getHeight() const override { return 1; }
 
-    ControlValue &getValue( size_t item_num, size_t w, size_t h ) override { return m_control_point_values[item_num]; }
+    RangedValueBase *getRangedValue( size_t item_num, size_t w, size_t h ) const override
+    {
+        return m_control_point_values[item_num].m_ranged_value;
+    }
 
-    const ControlValue &getValue( size_t item_num, size_t w, size_t h ) const override
+    string const &getValueName( size_t item_num, size_t w, size_t h ) const override
     {
-        return m_control_point_values[item_num];
+        return m_control_point_values[item_num].m_name;
     }
 
     void fillWriteAccess( ControlIdentityComparatorSetPtr &write_access ) override {}
@@ -20,7 +20,7 @@ using DescriptorProperties = std::vector<ControlValue>;
 using DescriptorNames = std::vector<ControlValue>;
 using DescriptorPtr = shared_ptr<DescriptorBase>;
 using DescriptorAddressMap = map<SchemaAddressElement, std::pair<DescriptorPtr, ControlIdentity> >;
-using DescriptorAvdeccMap = map<ControlIdentity, DescriptorPtr>;
+using DescriptorAvdeccMap = map<ControlIdentityKey, DescriptorPtr>;
 using DescriptorVector = std::vector<DescriptorPtr>;
 using DescriptorMap = std::map<DescriptorType, DescriptorVector>;
 
@@ -97,14 +97,19 @@ class DescriptorBase : public std::enable_shared_from_this<DescriptorBase>
 
     virtual uint16_t getHeight() const { return 0; }
 
-    virtual ControlValue &getValue( size_t item_num, size_t w = 0, size_t h = 0 )
+    virtual RangedValueBase *getRangedValue( size_t item_num, size_t w = 0, size_t h = 0 ) const
     {
-        throw std::runtime_error( "no getValue for descriptor" );
+        throw std::runtime_error( "no getRangedValue for descriptor" );
     }
 
-    virtual const ControlValue &getValue( size_t item_num, size_t w = 0, size_t h = 0 ) const
+    virtual string const &getValueName( size_t item_num, size_t w = 0, size_t h = 0 ) const
     {
-        throw std::runtime_error( "no getValue for descriptor" );
+        throw std::runtime_error( "no getValueName for descriptor" );
+    }
+
+    ControlValue getValue( size_t item_num, size_t w = 0, size_t h = 0 ) const
+    {
+        return ControlValue( getValueName( item_num, w, h ), getRangedValue( item_num, w, h ) );
     }
 
     ControlIdentity getControlIdentityForProperty( std::string const &item_name ) const
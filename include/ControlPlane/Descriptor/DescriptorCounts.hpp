@@ -11,6 +11,8 @@ namespace Descriptor
 class DescriptorCounts
 {
   public:
+    DescriptorCounts() { m_descriptor_index_for_type.fill( 0 ); }
+
     uint16_t getCountForDescriptorTypeAndIncrement( uint16_t descriptor_type )
     {
         return m_descriptor_index_for_type[descriptor_type]++;
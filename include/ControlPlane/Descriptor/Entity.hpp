@@ -28,9 +28,9 @@ class Entity : public DescriptorBase
 
     uint16_t getHeight() const override { return 1; }
 
-    ControlValue &getValue( size_t item_num, size_t w, size_t h ) override;
+    RangedValueBase *getRangedValue( size_t item_num, size_t w, size_t h ) const override;
 
-    const ControlValue &getValue( size_t item_num, size_t w, size_t h ) const override;
+    string const &getValueName( size_t item_num, size_t w, size_t h ) const override;
 
     void fillWriteAccess( ControlIdentityComparatorSetPtr &write_access ) override;
 
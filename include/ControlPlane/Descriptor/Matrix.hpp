@@ -3,12 +3,25 @@
 #include "../World.hpp"
 #include "Descriptors.hpp"
 #include "MatrixSignal.hpp"
+#include "../MatrixValues.hpp"
 
 namespace ControlPlane
 {
 namespace Descriptor
 {
 
+///
+/// \brief The Matrix class
+///
+/// A width by height grid of cells, each holding getNumValues() values.
+/// The values are stored by kind, as one MatrixValues per value of a cell,
+/// so the name of a kind is held once and the values of a kind are found
+/// by column and row stride rather than through a vector per cell.
+///
+/// Add the rows with addRow(), then either add each kind as a whole with
+/// addValues(), or add the cells in row major order with addColumn() and
+/// addValue().
+///
 class Matrix : public DescriptorBase
 {
   public:
@@ -19,6 +32,10 @@ class Matrix : public DescriptorBase
         , m_avdecc_control_type( avdecc_control_type )
         , m_avdecc_control_value_type( avdecc_control_value_type )
         , m_current_matrix_signal_descriptor( makeMatrixSignal() )
+        , m_width( 0 )
+        , m_height( 0 )
+        , m_column( 0 )
+        , m_item( 0 )
     {
         addChildDescriptor( m_current_matrix_signal_descriptor );
     }
@@ -27,7 +44,21 @@ class Matrix : public DescriptorBase
 
     void addRow( DescriptorPtr source_signal, uint16_t source_signal_output )
     {
-        m_control_point_values.emplace_back();
+        for ( auto const &values : m_values )
+        {
+            if ( values.isArray() )
+            {
+                throw std::runtime_error( "Matrix rows must be added before addValues()" );
+            }
+        }
+        if ( ++m_height == 2 )
+        {
+            for ( auto &values : m_values )
+            {
+                values.setRowStride( m_width );
+            }
+        }
+        m_column = 0;
         if ( !m_current_matrix_signal_descriptor->addSignal( source_signal, source_signal_output ) )
         {
             m_current_matrix_signal_descriptor = makeMatrixSignal();
@@ -35,35 +66,132 @@ class Matrix : public DescriptorBase
         }
     }
 
-    void addColumn() { m_control_point_values.back().emplace_back(); }
+    void addColumn()
+    {
+        if ( m_height == 1 )
+        {
+            ++m_width;
+        }
+        if ( ++m_column > m_width )
+        {
+            throw std::runtime_error( "Matrix row is wider than the first row" );
+        }
+        m_item = 0;
+    }
+
+    void addValue( ControlValue v )
+    {
+        if ( m_height == 1 && m_column == 1 )
+        {
+            m_values.emplace_back( v.m_name );
+        }
+        if ( m_item >= m_values.size() )
+        {
+            throw std::runtime_error( "Matrix cell has more values than the first cell" );
+        }
+        m_values[m_item++].addValue( v.m_ranged_value );
+    }
+
+    ///
+    /// \brief addValues
+    ///
+    /// Add a kind of value held in the caller's array of count RangedT, with
+    /// the value of column w, row h at first[h * row_stride + w * column_stride].
+    /// throws runtime_error if the array is too small for width columns of
+    /// getHeight() rows.
+    ///
+    template <typename RangedT>
+    void addValues( string name, RangedT *first, size_t count, uint16_t width, size_t row_stride, size_t column_stride = 1 )
+    {
+        setWidth( width );
+        if ( m_height == 0 || ( width > 0 && ( m_height - 1 ) * row_stride + ( width - 1 ) * column_stride >= count ) )
+        {
+            throw std::runtime_error( "Matrix values array is too small for the rows and columns" );
+        }
+        m_values.emplace_back( name, first, row_stride, column_stride );
+    }
 
-    void addValue( ControlValue v ) { m_control_point_values.back().back().push_back( v ); }
+    ///
+    /// \brief addValues
+    ///
+    /// Add a kind of value held in a row major array of width * getHeight()
+    /// RangedT owned by the matrix
+    ///
+    /// \return the first value of the array
+    ///
+    template <typename RangedT>
+    RangedT *addValues( string name, uint16_t width )
+    {
+        setWidth( width );
+        if ( m_height == 0 )
+        {
+            throw std::runtime_error( "Matrix rows must be added before addValues()" );
+        }
+        std::shared_ptr<vector<RangedT> > storage = std::make_shared<vector<RangedT> >( size_t( width ) * m_height );
+        RangedT *r = storage->data();
+        m_values.emplace_back( name, r, width, 1, storage );
+        return r;
+    }
 
     uint64_t getAvdeccControlType() const override { return m_avdecc_control_type; }
 
     uint16_t getAvdeccControlValueType() const override { return m_avdecc_control_value_type; }
 
-    virtual uint16_t getNumValues() const override { return (uint16_t)m_control_point_values.back().back().size(); }
-
-    virtual uint16_t getWidth() const override { return (uint16_t)m_control_point_values.back().size(); }
+    virtual uint16_t getNumValues() const override { return (uint16_t)m_values.size(); }
 
-    virtual uint16_t getHeight() const override { return (uint16_t)m_control_point_values.size(); }
+    virtual uint16_t getWidth() const override { return m_width; }
 
-    ControlValue &getValue( size_t item_num, size_t w, size_t h ) override { return m_control_point_values[h][w][item_num]; }
+    virtual uint16_t getHeight() const override { return m_height; }
 
-    const ControlValue &getValue( size_t item_num, size_t w, size_t h ) const override
+    RangedValueBase *getRangedValue( size_t item_num, size_t w, size_t h ) const override
     {
-        return m_control_point_values[h][w][item_num];
+        return m_values[item_num].getRangedValue( w, h );
     }
 
+    string const &getValueName( size_t item_num, size_t w, size_t h ) const override { return m_values[item_num].getName(); }
+
+    MatrixValues const &getValues( size_t item_num ) const { return m_values.at( item_num ); }
+
     void fillWriteAccess( ControlIdentityComparatorSetPtr &write_access ) override {}
 
     void storeToPDU( FixedBuffer &pdu ) const override;
 
+    ///
+    /// \brief storeValuesToPDU
+    ///
+    /// Append the encoded values of kind item_num for the region of
+    /// region_width columns by region_height rows starting at column, row,
+    /// in row major order as in a GET_MATRIX response
+    ///
+    void storeValuesToPDU( FixedBuffer &pdu,
+                           size_t item_num,
+                           uint16_t column,
+                           uint16_t row,
+                           uint16_t region_width,
+                           uint16_t region_height ) const;
+
     uint64_t m_avdecc_control_type;
     uint16_t m_avdecc_control_value_type;
-    vector<vector<vector<ControlValue> > > m_control_point_values;
     MatrixSignalPtr m_current_matrix_signal_descriptor;
+
+  private:
+    void setWidth( uint16_t width )
+    {
+        if ( m_values.empty() && m_column == 0 )
+        {
+            m_width = width;
+        }
+        else if ( width != m_width )
+        {
+            throw std::runtime_error( "Matrix values have a different width" );
+        }
+    }
+
+    vector<MatrixValues> m_values;
+    uint16_t m_width;
+    uint16_t m_height;
+    uint16_t m_column;
+    size_t m_item;
 };
 
 template <typename... T>
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "World.hpp"
+#include "RangedValue.hpp"
+#include "BulkEncoding.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The IsBulkEncodableInt32 struct
+///
+/// true_type for a RangedValue with a float value, an int32_t encoding and
+/// a compile time range, which encodeRangedValuesInt32BigEndian() accepts
+///
+template <typename RangedT, typename Enable = void>
+struct IsBulkEncodableInt32 : std::false_type
+{
+};
+
+template <typename RangedT>
+struct IsBulkEncodableInt32<RangedT,
+                            typename std::enable_if<std::is_same<typename RangedT::value_type, float>::value
+                                                    && std::is_same<typename RangedT::encoded_type, int32_t>::value
+                                                    && ( RangedT::min_value <= RangedT::max_value )>::type>
+    : std::true_type
+{
+};
+
+///
+/// \brief The MatrixValues class
+///
+/// One value kind of a Matrix, for example the gain of every cross point:
+/// a single name shared by every cell and the RangedValue of each cell,
+/// addressed by column and row.
+///
+/// A kind made from a typed array holds a pointer to the first RangedValue
+/// and the row and column strides in values, so a cell is found with
+/// arithmetic rather than through a pointer per cell, and getRow() gives
+/// typed access to a row in place. The array is either the caller's, or
+/// owned by the kind through storage. A kind made with the name only is
+/// filled one cell at a time with addValue(), in row major order, for
+/// values which are not in one array.
+///
+class MatrixValues
+{
+  public:
+    using EncodeRowFunction = void ( * )( uint8_t *dest, RangedValueBase const *first, size_t count );
+
+    explicit MatrixValues( string name )
+        : m_name( name )
+        , m_type( nullptr )
+        , m_first( nullptr )
+        , m_first_base( nullptr )
+        , m_row_stride( 0 )
+        , m_column_stride( 1 )
+        , m_row_stride_bytes( 0 )
+        , m_column_stride_bytes( 0 )
+        , m_encode_row( nullptr )
+    {
+    }
+
+    template <typename RangedT>
+    MatrixValues( string name,
+                  RangedT *first,
+                  size_t row_stride,
+                  size_t column_stride,
+                  std::shared_ptr<void> storage = std::shared_ptr<void>() )
+        : m_name( name )
+        , m_type( &typeid( RangedT ) )
+        , m_first( first )
+        , m_first_base( reinterpret_cast<uint8_t *>( static_cast<RangedValueBase *>( first ) ) )
+        , m_row_stride( row_stride )
+        , m_column_stride( column_stride )
+        , m_row_stride_bytes( row_stride * sizeof( RangedT ) )
+        , m_column_stride_bytes( column_stride * sizeof( RangedT ) )
+        , m_encode_row( getEncodeRowFunction<RangedT>( IsBulkEncodableInt32<RangedT>() ) )
+        , m_storage( storage )
+    {
+    }
+
+    string const &getName() const { return m_name; }
+
+    ///
+    /// \brief isArray
+    /// \return true if the kind was made from a typed array rather than filled with addValue()
+    ///
+    bool isArray() const { return m_first_base != nullptr; }
+
+    ///
+    /// \brief getRangedValue
+    /// \return the RangedValue of the cell at column w, row h
+    ///
+    RangedValueBase *getRangedValue( size_t w, size_t h ) const
+    {
+        RangedValueBase *r;
+        if ( m_first_base )
+        {
+            r = reinterpret_cast<RangedValueBase *>( m_first_base + h * m_row_stride_bytes + w * m_column_stride_bytes );
+        }
+        else
+        {
+            r = m_values[h * m_row_stride + w * m_column_stride];
+        }
+        return r;
+    }
+
+    ///
+    /// \brief getRow
+    /// \return the first value of row h, if the kind is an array of RangedT,
+    /// otherwise nullptr. The values of the row are getColumnStride() apart.
+    ///
+    template <typename RangedT>
+    RangedT *getRow( size_t h ) const
+    {
+        RangedT *r = nullptr;
+        if ( m_type && *m_type == typeid( RangedT ) )
+        {
+            r = static_cast<RangedT *>( m_first ) + h * m_row_stride;
+        }
+        return r;
+    }
+
+    size_t getRowStride() const { return m_row_stride; }
+
+    size_t getColumnStride() const { return m_column_stride; }
+
+    ///
+    /// \brief setRowStride
+    ///
+    /// Set the row stride of a kind filled with addValue(), once the
+    /// width of the matrix is known
+    ///
+    void setRowStride( size_t row_stride )
+    {
+        if ( !m_first_base )
+        {
+            m_row_stride = row_stride;
+        }
+    }
+
+    void addValue( RangedValueBase *v ) { m_values.push_back( v ); }
+
+    ///
+    /// \brief getEncodeRowFunction
+    /// \return a function which bulk encodes count adjacent values of
+    /// a row to big endian int32, or nullptr if the kind has no such function
+    ///
+    EncodeRowFunction getEncodeRowFunction() const { return m_column_stride == 1 ? m_encode_row : nullptr; }
+
+  private:
+    template <typename RangedT>
+    static void encodeRow( uint8_t *dest, RangedValueBase const *first, size_t count )
+    {
+        encodeRangedValuesInt32BigEndian( dest, static_cast<RangedT const *>( first ), count );
+    }
+
+    template <typename RangedT>
+    static EncodeRowFunction getEncodeRowFunction( std::true_type )
+    {
+        return &encodeRow<RangedT>;
+    }
+
+    template <typename RangedT>
+    static EncodeRowFunction getEncodeRowFunction( std::false_type )
+    {
+        return nullptr;
+    }
+
+    string m_name;
+    std::type_info const *m_type;
+    void *m_first;
+    uint8_t *m_first_base;
+    size_t m_row_stride;
+    size_t m_column_stride;
+    size_t m_row_stride_bytes;
+    size_t m_column_stride_bytes;
+    EncodeRowFunction m_encode_row;
+    std::shared_ptr<void> m_storage;
+    vector<RangedValueBase *> m_values;
+};
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "World.hpp"
+#include "SharedMutex.hpp"
+#include "RangedValue.hpp"
+#include "ControlIdentity.hpp"
+
+namespace ControlPlane
+{
+
+class Schema;
+
+///
+/// \brief The MeterFrame struct
+///
+/// The levels of every meter of a MeterGroup sampled at one time, as the
+/// int8 encoded dBFS of each meter in the order of the group
+///
+struct MeterFrame
+{
+    Milliseconds m_time_in_milliseconds;
+
+    /// counts the frames sampled by the group, so a subscriber can tell how many it skipped
+    uint64_t m_sequence;
+
+    std::vector<int8_t> m_levels;
+};
+
+using MeterFramePtr = shared_ptr<MeterFrame const>;
+
+using MeterFrameCallback = std::function<void( MeterFrame const &frame )>;
+
+///
+/// \brief The MeterGroup class
+///
+/// A group of read only meter values, such as VuMeterDbFsPeak, which
+/// change on every audio block and are delivered as a whole at a fixed
+/// rate instead of as individual changed controls. The RangedValues are
+/// resolved once by the constructor, so sample() only reads each encoded
+/// level into a frame, without taking the schema's lock.
+///
+/// A group is sampled at most once per time stamp, and every subscriber
+/// of the group at that time shares the frame. The group refers to the
+/// values of the Schema and must not outlive it.
+///
+class MeterGroup
+{
+  public:
+    ///
+    /// \brief MeterGroup
+    ///
+    /// The meters are the listed controls, in order
+    ///
+    /// throws SchemaErrorNoSuchControlIdentity if a control is not in the schema
+    /// throws SchemaErrorNotAMeter if a control is not read only and int8 encoded
+    ///
+    MeterGroup( Schema const &schema, std::vector<ControlIdentity> const &meters );
+
+    ///
+    /// \brief MeterGroup
+    ///
+    /// The meters are the count consecutive values of the schema's value index
+    /// which start at first, such as the items of a meter control or the
+    /// controls of one meter bridge
+    ///
+    /// throws SchemaErrorNoSuchControlIdentity if first is not in the schema or
+    /// there are fewer than count values from first
+    /// throws SchemaErrorNotAMeter if a value is not read only and int8 encoded
+    ///
+    MeterGroup( Schema const &schema, ControlIdentity const &first, size_t count );
+
+    MeterGroup( MeterGroup const & ) = delete;
+    MeterGroup &operator=( MeterGroup const & ) = delete;
+
+    size_t size() const { return m_values.size(); }
+
+    std::vector<ControlIdentityKey> const &getMeters() const { return m_meters; }
+
+    ///
+    /// \brief sample
+    ///
+    /// \return the frame sampled at current_time_in_milliseconds, reading the meters only the first time it is asked for
+    ///
+    MeterFramePtr sample( Milliseconds current_time_in_milliseconds );
+
+  private:
+    void addMeter( ControlIdentityKey key, RangedValueBase const *ranged_value );
+
+    std::vector<ControlIdentityKey> m_meters;
+    std::vector<RangedValueBase const *> m_values;
+
+    std::mutex m_frame_mutex;
+    MeterFramePtr m_frame;
+    uint64_t m_sequence;
+};
+
+using MeterGroupPtr = shared_ptr<MeterGroup>;
+}
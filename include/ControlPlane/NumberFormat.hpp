@@ -0,0 +1,171 @@
+#pragma once
+
+#include "World.hpp"
+
+namespace ControlPlane
+{
+namespace Util
+{
+
+///
+/// Number formatting and parsing into and out of caller provided buffers,
+/// in the style of std::to_chars and std::from_chars, for the string paths
+/// of the RangedValue classes and the text protocol.
+///
+/// The output is the same as writing the value to a std::ostream with the
+/// default flags: floating point values as printf's "%.6g" and integers in
+/// decimal. The parsers accept what reading the value from a std::istream
+/// does: leading white space, then the longest prefix which is a number.
+///
+
+///
+/// The size of a buffer which can hold any number written by the format
+/// functions, with its terminating nul
+///
+static const size_t max_number_length = 32;
+
+///
+/// \brief formatSigned
+///
+/// Write v in decimal to buf, which must hold max_number_length characters
+///
+/// \return the number of characters written, not counting the terminating nul
+///
+size_t formatSigned( char *buf, int64_t v );
+
+///
+/// \brief formatUnsigned
+///
+/// Write v in decimal to buf, which must hold max_number_length characters
+///
+/// \return the number of characters written, not counting the terminating nul
+///
+size_t formatUnsigned( char *buf, uint64_t v );
+
+///
+/// \brief formatHex
+///
+/// Write v in lower case hexadecimal without a prefix to buf, which must
+/// hold max_number_length characters
+///
+/// \return the number of characters written, not counting the terminating nul
+///
+size_t formatHex( char *buf, uint64_t v );
+
+///
+/// \brief formatFloating
+///
+/// Write v as "%.6g" would to buf, which must hold max_number_length characters.
+///
+/// The values of a RangedValue are multiples of 10^multiplier_power, so
+/// a value which is one to within the rounding of its type is written from
+/// its integer multiple without going through printf.
+///
+/// \return the number of characters written, not counting the terminating nul
+///
+size_t formatFloating( char *buf, double v, int multiplier_power = 0 );
+
+///
+/// \brief formatNumber
+///
+/// Write an arithmetic value with formatFloating(), formatSigned() or
+/// formatUnsigned() as suits its type
+///
+template <typename T>
+size_t formatNumber( char *buf, T v, int multiplier_power = 0 )
+{
+    return std::is_floating_point<T>::value ? formatFloating( buf, double( v ), multiplier_power )
+                                            : std::is_signed<T>::value ? formatSigned( buf, int64_t( v ) )
+                                                                       : formatUnsigned( buf, uint64_t( v ) );
+}
+
+///
+/// \brief appendNumber
+///
+/// Append an arithmetic value to s as formatNumber() writes it
+///
+template <typename T>
+string &appendNumber( string &s, T v, int multiplier_power = 0 )
+{
+    char buf[max_number_length];
+    return s.append( buf, formatNumber( buf, v, multiplier_power ) );
+}
+
+///
+/// \brief parseSigned
+///
+/// Parse a decimal integer from the characters from first up to last,
+/// saturating at the limits of int64_t
+///
+/// \return a pointer past the characters used, or first with v set to 0 if there is no number
+///
+const char *parseSigned( const char *first, const char *last, int64_t &v );
+
+///
+/// \brief parseUnsigned
+///
+/// Parse a decimal integer from the characters from first up to last,
+/// saturating at the largest uint64_t. A negative number gives 0.
+///
+/// \return a pointer past the characters used, or first with v set to 0 if there is no number
+///
+const char *parseUnsigned( const char *first, const char *last, uint64_t &v );
+
+///
+/// \brief parseHex
+///
+/// Parse a hexadecimal integer, with or without a 0x prefix, from the
+/// characters from first up to last, saturating at the largest uint64_t
+///
+/// \return a pointer past the characters used, or first with v set to 0 if there is no number
+///
+const char *parseHex( const char *first, const char *last, uint64_t &v );
+
+///
+/// \brief parseNumber
+///
+/// Parse a decimal floating point number with an optional fraction and
+/// exponent from the characters from first up to last. Numbers of up to
+/// 7 significant digits for float, or 15 for double, with small exponents
+/// are converted exactly without going through strtod.
+///
+/// \return a pointer past the characters used, or first with v set to 0 if there is no number
+///
+const char *parseNumber( const char *first, const char *last, float &v );
+
+const char *parseNumber( const char *first, const char *last, double &v );
+
+///
+/// \brief parseNumber
+///
+/// Parse an integer of any type with parseSigned() or parseUnsigned(),
+/// saturating at the limits of the type
+///
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, const char *>::type
+    parseNumber( const char *first, const char *last, T &v )
+{
+    const char *r;
+    if ( std::is_signed<T>::value )
+    {
+        int64_t wide;
+        r = parseSigned( first, last, wide );
+        wide = std::max( wide, int64_t( std::numeric_limits<T>::min() ) );
+        v = T( std::min( wide, int64_t( std::numeric_limits<T>::max() ) ) );
+    }
+    else
+    {
+        uint64_t wide;
+        r = parseUnsigned( first, last, wide );
+        v = T( std::min( wide, uint64_t( std::numeric_limits<T>::max() ) ) );
+    }
+    return r;
+}
+
+template <typename T>
+const char *parseNumber( string const &s, T &v )
+{
+    return parseNumber( s.data(), s.data() + s.size(), v );
+}
+}
+}
@@ -4,6 +4,8 @@
 #include "AvdeccString.hpp"
 #include "AvdeccUnits.hpp"
 #include "AvdeccEncoding.hpp"
+#include "RangedValueStorage.hpp"
+#include "NumberFormat.hpp"
 
 namespace ControlPlane
 {
@@ -106,6 +108,33 @@ class RangedValueBase
     ///
     virtual bool setUnencodedValueUInt64( uint64_t v, bool force = false ) = 0;
 
+    ///
+    /// \brief isUnencodedValueInRangeDouble
+    ///
+    /// Check a value before setting it, without writing anything
+    ///
+    /// \return false if setUnencodedValueDouble( v ) would throw range_error
+    ///
+    virtual bool isUnencodedValueInRangeDouble( double v ) const { return true; }
+
+    ///
+    /// \brief isUnencodedValueInRangeInt64
+    /// \return false if setUnencodedValueInt64( v ) would throw range_error
+    ///
+    virtual bool isUnencodedValueInRangeInt64( int64_t v ) const { return true; }
+
+    ///
+    /// \brief isUnencodedValueInRangeUInt64
+    /// \return false if setUnencodedValueUInt64( v ) would throw range_error
+    ///
+    virtual bool isUnencodedValueInRangeUInt64( uint64_t v ) const { return true; }
+
+    ///
+    /// \brief isUnencodedValueInRangeString
+    /// \return false if setUnencodedValueString( v ) would throw range_error
+    ///
+    virtual bool isUnencodedValueInRangeString( string const &v ) const { return true; }
+
     ///
     /// \brief getUnencodedValueString
     ///
@@ -195,6 +224,27 @@ class RangedValueBase
     virtual float getEncodedValueFloat() const = 0;
     virtual double getEncodedValueDouble() const = 0;
 
+    ///
+    /// \brief getEncodedValueBits
+    ///
+    /// Get the numeric encoded value as raw bits, in the low
+    /// getEncodingTypeSize( getEncodingType() ) bytes. Floating point
+    /// encodings give their IEEE 754 representation.
+    ///
+    /// \return the bits, or 0 for a string encoding
+    ///
+    uint64_t getEncodedValueBits() const;
+
+    ///
+    /// \brief setFromEncodedValueBitsWithClamp
+    ///
+    /// Set the value from raw encoded bits as given by getEncodedValueBits(),
+    /// clamping to the range of the value
+    ///
+    /// \return true if the value changed
+    ///
+    bool setFromEncodedValueBitsWithClamp( uint64_t bits );
+
     virtual void setFromEncodedValueAvdeccString( const AvdeccString *storage ) = 0;
     virtual bool setFromEncodedValueInt8( int8_t v ) = 0;
     virtual bool setFromEncodedValueUInt8( uint8_t v ) = 0;
@@ -290,6 +340,28 @@ class RangedValueBase
     void getUnencodedValue( string *v ) const { *v = getUnencodedValueString( false ); }
 
     void getUnencodedValue( uint64_t *v ) const { *v = getUnencodedValueUInt64(); }
+
+  protected:
+    ///
+    /// \brief formatUnencodedNumber
+    ///
+    /// Format v with Util::formatNumber(), followed by the suffix of units if enable_units is set
+    ///
+    template <typename T>
+    static string formatUnencodedNumber( T v, int multiplier_power, UnitsCode units, bool enable_units )
+    {
+        char buf[Util::max_number_length];
+        string r( buf, Util::formatNumber( buf, v, multiplier_power ) );
+        if ( enable_units )
+        {
+            const char *suffix = getAvdeccUnitsSuffix( units );
+            if ( suffix && *suffix )
+            {
+                r.append( " " ).append( suffix );
+            }
+        }
+        return r;
+    }
 };
 
 /// \brief the RangedValue class
@@ -298,6 +370,11 @@ class RangedValueBase
 /// step size
 /// and with the capability to encode/decode into a fixed point integer type
 ///
+/// The value is held by StorageT, which defaults to RangedValueAtomicStorage
+/// so that the value can be read without a lock while it is being set.
+/// RangedValuePlainStorage may be given instead when all access is
+/// externally serialized.
+///
 template <UnitsCode UnitsValue,
           int64_t MinValue,
           int64_t MaxValue,
@@ -305,7 +382,8 @@ template <UnitsCode UnitsValue,
           int64_t StepValue = 1,
           int MultiplierPowerValue = 0,
           typename EncodedT = int32_t,
-          typename ValueT = float>
+          typename ValueT = float,
+          template <typename> class StorageT = RangedValueAtomicStorage>
 class RangedValue : public RangedValueBase
 {
     static_assert( MinValue <= DefaultValue, "MinValue is not less than or equal to DefaultValue" );
@@ -325,6 +403,20 @@ class RangedValue : public RangedValueBase
     static const int64_t default_value = DefaultValue;
     static const int multiplier_power = MultiplierPowerValue;
 
+    /// the factors between the unencoded and encoded values, which depend only on multiplier_power
+    static constexpr value_type encoding_multiplier
+        = multiplier_power < 0 ? pow10Constant<value_type>( -multiplier_power ) : value_type( 1 );
+    static constexpr value_type encoding_divider
+        = multiplier_power > 0 ? pow10Constant<value_type>( multiplier_power ) : value_type( 1 );
+    static constexpr value_type decoding_multiplier = encoding_divider;
+    static constexpr value_type decoding_divider = encoding_multiplier;
+
+    /// the unencoded range, default and step, decoded once at compile time
+    static constexpr value_type unencoded_min_value = value_type( MinValue ) * decoding_multiplier / decoding_divider;
+    static constexpr value_type unencoded_max_value = value_type( MaxValue ) * decoding_multiplier / decoding_divider;
+    static constexpr value_type unencoded_default_value = value_type( DefaultValue ) * decoding_multiplier / decoding_divider;
+    static constexpr value_type unencoded_step_value = value_type( StepValue ) * decoding_multiplier / decoding_divider;
+
     ///
     /// \brief Value Constructor
     ///
@@ -368,7 +460,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \brief operator value_type
     ///
-    operator value_type() const { return m_value; }
+    operator value_type() const { return m_value.load(); }
 
     bool isReadOnly() const override { return false; }
 
@@ -407,20 +499,8 @@ class RangedValue : public RangedValueBase
             {
                 throw std::range_error( "setValue() too large" );
             }
-            if ( m_value != v )
-            {
-                m_value = v;
-                r = true;
-            }
-        }
-        else
-        {
-            if ( m_value != v )
-            {
-                m_value = v;
-                r = true;
-            }
         }
+        r = m_value.exchange( v ) != v;
         return r;
     }
 
@@ -446,11 +526,7 @@ class RangedValue : public RangedValueBase
             v = getMaxValue();
         }
 
-        if ( m_value != v )
-        {
-            m_value = v;
-            r = true;
-        }
+        r = m_value.exchange( v ) != v;
         return r;
     }
 
@@ -460,9 +536,8 @@ class RangedValue : public RangedValueBase
 
     bool setUnencodedValueString( string const &v, bool force ) override
     {
-        std::istringstream buf( v );
         value_type actual;
-        buf >> actual;
+        Util::parseNumber( v, actual );
         return setUnencodedValue( actual );
     }
 
@@ -481,90 +556,59 @@ class RangedValue : public RangedValueBase
 
     bool setUnencodedValueUInt64( uint64_t v, bool force ) override { return setValue( (value_type)v, force ); }
 
+    bool isUnencodedValueInRangeDouble( double v ) const override { return isInRange( (value_type)v ); }
+
+    bool isUnencodedValueInRangeInt64( int64_t v ) const override { return isInRange( (value_type)v ); }
+
+    bool isUnencodedValueInRangeUInt64( uint64_t v ) const override { return isInRange( (value_type)v ); }
+
+    bool isUnencodedValueInRangeString( string const &v ) const override
+    {
+        value_type actual;
+        Util::parseNumber( v, actual );
+        return isInRange( actual );
+    }
+
+    ///
+    /// \brief isInRange
+    /// \return true if setValue( v ) would not throw range_error
+    ///
+    bool isInRange( value_type v ) const { return !( v < getMinValue() ) && !( v > getMaxValue() ); }
+
     string getUnencodedValueString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedMinimumString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getMinValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getMinValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedMaximumString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getMaxValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getMaxValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedStepString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getStepValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getStepValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedDefaultString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getDefaultValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getDefaultValue(), multiplier_power, units, enable_units );
     }
 
-    bool getUnencodedValueBool() const override { return m_value != value_type(); }
+    bool getUnencodedValueBool() const override { return m_value.load() != value_type(); }
 
-    float getUnencodedValueFloat() const override { return (float)m_value; }
+    float getUnencodedValueFloat() const override { return (float)m_value.load(); }
 
-    double getUnencodedValueDouble() const override { return (double)m_value; }
+    double getUnencodedValueDouble() const override { return (double)m_value.load(); }
 
-    int64_t getUnencodedValueInt64() const override { return (int64_t)m_value; }
+    int64_t getUnencodedValueInt64() const override { return (int64_t)m_value.load(); }
 
-    uint64_t getUnencodedValueUInt64() const override { return (uint64_t)m_value; }
+    uint64_t getUnencodedValueUInt64() const override { return (uint64_t)m_value.load(); }
 
     float getUnencodedMinimumFloat() const override { return (float)getMinValue(); }
 
@@ -584,17 +628,18 @@ class RangedValue : public RangedValueBase
     ///
     bool incValue() override
     {
-        bool r = false;
-        value_type new_value = m_value + getStepValue();
-        if ( new_value > getMaxValue() )
-        {
-            new_value = getMaxValue();
-        }
-        if ( m_value != new_value )
+        value_type current = m_value.load();
+        value_type new_value;
+        do
         {
-            m_value = new_value;
-            r = true;
-        }
+            new_value = current + getStepValue();
+            if ( new_value > getMaxValue() )
+            {
+                new_value = getMaxValue();
+            }
+        } while ( current != new_value && !m_value.compareExchange( current, new_value ) );
+
+        bool r = current != new_value;
         return r;
     }
 
@@ -608,17 +653,18 @@ class RangedValue : public RangedValueBase
     ///
     bool decValue() override
     {
-        bool r = false;
-        value_type new_value = m_value - getStepValue();
-        if ( new_value > getMaxValue() )
+        value_type current = m_value.load();
+        value_type new_value;
+        do
         {
-            new_value = getMaxValue();
-        }
-        if ( m_value != new_value )
-        {
-            m_value = new_value;
-            r = true;
-        }
+            new_value = current - getStepValue();
+            if ( new_value < getMinValue() )
+            {
+                new_value = getMinValue();
+            }
+        } while ( current != new_value && !m_value.compareExchange( current, new_value ) );
+
+        bool r = current != new_value;
         return r;
     }
 
@@ -629,7 +675,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the value
     ///
-    value_type getValue() const { return m_value; }
+    value_type getValue() const { return m_value.load(); }
 
     ///
     /// \brief getMinValue
@@ -638,13 +684,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the minimum value
     ///
-    value_type getMinValue() const
-    {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( min_value ) * decoding_multiplier / decoding_divider;
-        return v;
-    }
+    value_type getMinValue() const { return unencoded_min_value; }
 
     ///
     /// \brief getMaxValue
@@ -653,13 +693,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the maximum value
     ///
-    value_type getMaxValue() const
-    {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( max_value ) * decoding_multiplier / decoding_divider;
-        return v;
-    }
+    value_type getMaxValue() const { return unencoded_max_value; }
 
     ///
     /// \brief getDefaultValue
@@ -668,13 +702,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the default value
     ///
-    value_type getDefaultValue() const
-    {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( default_value ) * decoding_multiplier / decoding_divider;
-        return v;
-    }
+    value_type getDefaultValue() const { return unencoded_default_value; }
 
     ///
     /// \brief getStepValue
@@ -683,13 +711,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the step value
     ///
-    value_type getStepValue() const
-    {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( step_value ) * decoding_multiplier / decoding_divider;
-        return v;
-    }
+    value_type getStepValue() const { return unencoded_step_value; }
 
     ///
     /// \brief getEncodingMultiplier
@@ -701,15 +723,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return The value to multiply with
     ///
-    value_type getEncodingMultiplier() const
-    {
-        value_type r = 1;
-        if ( multiplier_power < 0 )
-        {
-            r = integer_pow10<value_type>( r, -multiplier_power );
-        }
-        return r;
-    }
+    value_type getEncodingMultiplier() const { return encoding_multiplier; }
 
     ///
     /// \brief getEncodingDivider
@@ -721,15 +735,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the value to divide with
     ///
-    value_type getEncodingDivider() const
-    {
-        value_type r = 1;
-        if ( multiplier_power > 0 )
-        {
-            r = integer_pow10<value_type>( r, multiplier_power );
-        }
-        return r;
-    }
+    value_type getEncodingDivider() const { return encoding_divider; }
 
     ///
     /// \brief getDecodingMultiplier
@@ -741,15 +747,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return The value to multiply with
     ///
-    value_type getDecodingMultiplier() const
-    {
-        value_type r = 1;
-        if ( multiplier_power > 0 )
-        {
-            r = integer_pow10<value_type>( r, multiplier_power );
-        }
-        return r;
-    }
+    value_type getDecodingMultiplier() const { return decoding_multiplier; }
 
     ///
     /// \brief getDecodingDivider
@@ -761,15 +759,7 @@ class RangedValue : public RangedValueBase
     ///
     /// \return the value to divide with
     ///
-    value_type getDecodingDivider() const
-    {
-        value_type r = 1;
-        if ( multiplier_power < 0 )
-        {
-            r = integer_pow10<value_type>( r, -multiplier_power );
-        }
-        return r;
-    }
+    value_type getDecodingDivider() const { return decoding_divider; }
 
     ///
     /// Default template function to help round integer types
@@ -815,28 +805,38 @@ class RangedValue : public RangedValueBase
     template <typename T>
     void getEncodedValue( T *dest ) const
     {
-        value_type encoding_multiplier = getEncodingMultiplier();
-        value_type encoding_divider = getEncodingDivider();
-        value_type v = ( getValue() * encoding_multiplier / encoding_divider );
-        value_type rounded_v;
-
-        if ( !std::is_floating_point<T>::value && std::is_floating_point<value_type>::value )
-        {
-            rounded_v = valueRound( v );
-        }
-        else
-        {
-            rounded_v = v;
-        }
-        if ( getMaxValue() * encoding_multiplier > (value_type)std::numeric_limits<T>::max() )
+        // both checks are constant for each T, so only a T which cannot hold the range keeps a throw
+        if ( !isMaxEncodableAs<T>() )
         {
             throw std::domain_error( "Max Value too large for encoding" );
         }
-        if ( getMinValue() * encoding_multiplier < (value_type)std::numeric_limits<T>::min() )
+        if ( !isMinEncodableAs<T>() )
         {
             throw std::domain_error( "Min Value too small for encoding" );
         }
-        *dest = static_cast<T>( rounded_v );
+        value_type v = getValue() * encoding_multiplier / encoding_divider;
+        bool round = !std::is_floating_point<T>::value && std::is_floating_point<value_type>::value;
+        *dest = static_cast<T>( round ? valueRound( v ) : v );
+    }
+
+    ///
+    /// \brief isMaxEncodableAs
+    /// \return true if the maximum value encodes without overflowing T
+    ///
+    template <typename T>
+    static constexpr bool isMaxEncodableAs()
+    {
+        return !( unencoded_max_value * encoding_multiplier > (value_type)std::numeric_limits<T>::max() );
+    }
+
+    ///
+    /// \brief isMinEncodableAs
+    /// \return true if the minimum value encodes without overflowing T
+    ///
+    template <typename T>
+    static constexpr bool isMinEncodableAs()
+    {
+        return !( unencoded_min_value * encoding_multiplier < (value_type)std::numeric_limits<T>::lowest() );
     }
 
     void getEncodedValueAvdeccString( AvdeccString *storage ) const override
@@ -927,10 +927,7 @@ class RangedValue : public RangedValueBase
     template <typename T>
     bool setFromEncodedValue( T encoded_v )
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( encoded_v ) * decoding_multiplier / decoding_divider;
-        return setValue( v );
+        return setValue( value_type( encoded_v ) * decoding_multiplier / decoding_divider );
     }
 
     bool setFromEncodedValue( bool encoded_v ) { return setValue( encoded_v ); }
@@ -938,8 +935,9 @@ class RangedValue : public RangedValueBase
     void setFromEncodedValueAvdeccString( const AvdeccString *storage ) override
     {
         string s = storage->get();
-        std::istringstream buf( s );
-        buf >> m_value;
+        value_type v = value_type();
+        Util::parseNumber( s, v );
+        m_value.store( v );
     }
 
     bool setFromEncodedValueInt8( int8_t v ) override { return setFromEncodedValue( v ); }
@@ -974,10 +972,7 @@ class RangedValue : public RangedValueBase
     template <typename T>
     bool setFromEncodedValueWithClamp( T encoded_v )
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( encoded_v ) * decoding_multiplier / decoding_divider;
-        return setValueWithClamp( v );
+        return setValueWithClamp( value_type( encoded_v ) * decoding_multiplier / decoding_divider );
     }
 
     bool setFromEncodedValueWithClampInt8( int8_t v ) override { return setFromEncodedValueWithClamp( v ); }
@@ -1041,13 +1036,19 @@ class RangedValue : public RangedValueBase
 
     const char *getUnitsSuffix() const override { return getAvdeccUnitsSuffix( getUnitsCode() ); }
 
+    ///
+    /// \brief isLockFree
+    /// \return true if the value can be read and written without a lock
+    ///
+    bool isLockFree() const { return m_value.isLockFree(); }
+
   private:
     ///
     /// \brief m_value
     ///
     /// The actual non-encoded value
     ///
-    value_type m_value;
+    StorageT<value_type> m_value;
 };
 
 template <UnitsCode UnitsValue,
@@ -1056,8 +1057,9 @@ template <UnitsCode UnitsValue,
           int64_t DefaultValue,
           int64_t StepValue,
           int MultiplierPowerValue,
-          typename EncodedT>
-class RangedValue<UnitsValue, MinValue, MaxValue, DefaultValue, StepValue, MultiplierPowerValue, EncodedT, string>
+          typename EncodedT,
+          template <typename> class StorageT>
+class RangedValue<UnitsValue, MinValue, MaxValue, DefaultValue, StepValue, MultiplierPowerValue, EncodedT, string, StorageT>
     : public RangedValueBase
 {
     static_assert( MinValue <= DefaultValue, "MinValue is not less than or equal to DefaultValue" );
@@ -1185,45 +1187,40 @@ class RangedValue<UnitsValue, MinValue, MaxValue, DefaultValue, StepValue, Multi
 
     bool setUnencodedValueFloat( float v, bool force = false ) override
     {
-        std::ostringstream buf;
-        buf << v;
-        return setValue( buf.str() );
+        string buf;
+        return setValue( Util::appendNumber( buf, v ) );
     }
 
     bool setUnencodedValueDouble( double v, bool force = false ) override
     {
-        std::ostringstream buf;
-        buf << v;
-        return setValue( buf.str() );
+        string buf;
+        return setValue( Util::appendNumber( buf, v ) );
     }
 
     bool setUnencodedValueInt64( int64_t v, bool force = false ) override
     {
-        std::ostringstream buf;
-        buf << v;
-        return setValue( buf.str() );
+        string buf;
+        return setValue( Util::appendNumber( buf, v ) );
     }
 
     bool setUnencodedValueUInt64( uint64_t v, bool force = false ) override
     {
-        std::ostringstream buf;
-        buf << v;
-        return setValue( buf.str() );
+        string buf;
+        return setValue( Util::appendNumber( buf, v ) );
     }
 
     string getUnencodedValueString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getValue();
+        string r = getValue();
         if ( enable_units )
         {
             const char *suffix = getAvdeccUnitsSuffix( units );
             if ( suffix && *suffix )
             {
-                buf << " " << suffix;
+                r.append( " " ).append( suffix );
             }
         }
-        return buf.str();
+        return r;
     }
 
     string getUnencodedMinimumString( bool enable_units ) const override { return ""; }
@@ -1238,33 +1235,29 @@ class RangedValue<UnitsValue, MinValue, MaxValue, DefaultValue, StepValue, Multi
 
     float getUnencodedValueFloat() const override
     {
-        std::istringstream buf( m_value );
         float v;
-        buf >> v;
+        Util::parseNumber( m_value, v );
         return v;
     }
 
     double getUnencodedValueDouble() const override
     {
-        std::istringstream buf( m_value );
         double v;
-        buf >> v;
+        Util::parseNumber( m_value, v );
         return v;
     }
 
     int64_t getUnencodedValueInt64() const override
     {
-        std::istringstream buf( m_value );
         int64_t v;
-        buf >> v;
+        Util::parseNumber( m_value, v );
         return v;
     }
 
     uint64_t getUnencodedValueUInt64() const override
     {
-        std::istringstream buf( m_value );
         uint64_t v;
-        buf >> v;
+        Util::parseNumber( m_value, v );
         return v;
     }
 
@@ -1433,8 +1426,7 @@ class RangedValue<UnitsValue, MinValue, MaxValue, DefaultValue, StepValue, Multi
     template <typename T>
     void getEncodedValue( T *dest ) const
     {
-        std::istringstream buf( m_value );
-        buf >> *dest;
+        Util::parseNumber( m_value, *dest );
     }
 
     void getEncodedValueAvdeccString( AvdeccString *storage ) const override { storage->set( m_value ); }
@@ -1520,9 +1512,8 @@ class RangedValue<UnitsValue, MinValue, MaxValue, DefaultValue, StepValue, Multi
     template <typename T>
     bool setFromEncodedValue( T encoded_v )
     {
-        std::ostringstream buf;
-        buf << encoded_v;
-        return setValue( buf.str() );
+        string buf;
+        return setValue( Util::appendNumber( buf, encoded_v ) );
     }
 
     void setFromEncodedValueAvdeccString( const AvdeccString *storage ) override { m_value = storage->get(); }
@@ -1685,15 +1676,8 @@ class RangedValueEUI64 : public RangedValueBase
     ///
     bool setUnencodedValueString( string const &sv, bool force = false ) override
     {
-        std::string svp = sv;
-        if ( svp[0] == '0' && svp[1] == 'x' )
-        {
-            svp = svp.substr( 2 );
-        }
-        std::istringstream is( svp );
-        is >> std::hex;
         uint64_t v = 0;
-        is >> v;
+        Util::parseHex( sv.data(), sv.data() + sv.size(), v );
         return setValue( v, force );
     }
 
@@ -1769,10 +1753,8 @@ class RangedValueEUI64 : public RangedValueBase
     ///
     string getUnencodedValueString( bool enable_units = true ) const override
     {
-        std::ostringstream ss;
-        ss << "0x" << std::hex;
-        ss << m_value;
-        return ss.str();
+        char buf[Util::max_number_length];
+        return string( "0x" ).append( buf, Util::formatHex( buf, m_value ) );
     }
 
     string getUnencodedMinimumString( bool enable_units = true ) const override { return "0"; }
@@ -1986,10 +1968,21 @@ class RangedValueEUI64 : public RangedValueBase
     void getUnencodedValue( uint64_t *v ) const { *v = getUnencodedValueUInt64(); }
 };
 
-template <bool DefaultValue = false, bool MinValue = false, bool MaxValue = true, bool ReadOnly = false>
+///
+/// \brief The RangedValueBool class
+///
+/// A holder for a boolean value. The value is held by StorageT, which
+/// defaults to RangedValueAtomicStorage so that it can be read without a
+/// lock while it is being set.
+///
+template <bool DefaultValue = false,
+          bool MinValue = false,
+          bool MaxValue = true,
+          bool ReadOnly = false,
+          template <typename> class StorageT = RangedValueAtomicStorage>
 class RangedValueBool : public RangedValueBase
 {
-    bool m_value;
+    StorageT<bool> m_value;
 
   public:
     using ranged_value_type = RangedValueBool;
@@ -2000,9 +1993,16 @@ class RangedValueBool : public RangedValueBase
 
     bool isReadOnly() const override { return ReadOnly; }
 
-    operator bool() const { return m_value; }
+    operator bool() const { return m_value.load(); }
+
+    bool getValue() const { return m_value.load(); }
+
+    ///
+    /// \brief isLockFree
+    /// \return true if the value can be read and written without a lock
+    ///
+    bool isLockFree() const { return m_value.isLockFree(); }
 
-    bool getValue() const { return m_value; }
     ///
     /// \brief getUnitsCode
     ///
@@ -2025,13 +2025,9 @@ class RangedValueBool : public RangedValueBase
     bool setValue( bool v, bool force = false )
     {
         bool r = false;
-        if ( m_value != v )
+        if ( v == MinValue || v == MaxValue || force == true )
         {
-            if ( v == MinValue || v == MaxValue || force == true )
-            {
-                m_value = v;
-                r = true;
-            }
+            r = m_value.exchange( v ) != v;
         }
         return r;
     }
@@ -2130,10 +2126,7 @@ class RangedValueBool : public RangedValueBase
     ///
     string getUnencodedValueString( bool enable_units = true ) const override
     {
-        std::ostringstream ss;
-        ss << std::boolalpha;
-        ss << m_value;
-        return ss.str();
+        return m_value.load() ? "true" : "false";
     }
 
     string getUnencodedMinimumString( bool enable_units = true ) const override { return MaxValue == true ? "true" : "false"; }
@@ -2151,31 +2144,31 @@ class RangedValueBool : public RangedValueBase
     /// \brief getUnencodedValueBool
     /// \return the unencoded value as a bool
     ///
-    bool getUnencodedValueBool() const override { return m_value; }
+    bool getUnencodedValueBool() const override { return m_value.load(); }
 
     ///
     /// \brief getUnencodedValueFloat
     /// \return the unencoded value as a float
     ///
-    float getUnencodedValueFloat() const override { return m_value == true ? 1.0f : 0.0f; }
+    float getUnencodedValueFloat() const override { return m_value.load() == true ? 1.0f : 0.0f; }
 
     ///
     /// \brief getUnencodedValueDouble
     /// \return the unencoded value as a double
     ///
-    double getUnencodedValueDouble() const override { return m_value == true ? 1.0 : 0.0; }
+    double getUnencodedValueDouble() const override { return m_value.load() == true ? 1.0 : 0.0; }
 
     ///
     /// \brief getUnencodedValueInt64
     /// \return the unencoded value as an int64_t
     ///
-    int64_t getUnencodedValueInt64() const override { return m_value == true ? 1 : 0; }
+    int64_t getUnencodedValueInt64() const override { return m_value.load() == true ? 1 : 0; }
 
     ///
     /// \brief getUnencodedValueUInt64
     /// \return the unencoded value as a uint64_t
     ///
-    uint64_t getUnencodedValueUInt64() const override { return m_value == true ? 1 : 0; }
+    uint64_t getUnencodedValueUInt64() const override { return m_value.load() == true ? 1 : 0; }
 
     float getUnencodedMinimumFloat() const override { return MinValue == true ? 1.0f : 0.0f; }
 
@@ -2205,25 +2198,25 @@ class RangedValueBool : public RangedValueBase
 
     void getEncodedValueAvdeccString( AvdeccString *storage ) const override { storage->set( getUnencodedValueString() ); }
 
-    int8_t getEncodedValueInt8() const override { return m_value == true ? -1 : 0; }
+    int8_t getEncodedValueInt8() const override { return m_value.load() == true ? -1 : 0; }
 
-    uint8_t getEncodedValueUInt8() const override { return m_value == true ? 0xff : 0; }
+    uint8_t getEncodedValueUInt8() const override { return m_value.load() == true ? 0xff : 0; }
 
-    int16_t getEncodedValueInt16() const override { return m_value == true ? 0xff : 0; }
+    int16_t getEncodedValueInt16() const override { return m_value.load() == true ? 0xff : 0; }
 
-    uint16_t getEncodedValueUInt16() const override { return m_value == true ? 0xff : 0; }
+    uint16_t getEncodedValueUInt16() const override { return m_value.load() == true ? 0xff : 0; }
 
-    int32_t getEncodedValueInt32() const override { return m_value == true ? 0xff : 0; }
+    int32_t getEncodedValueInt32() const override { return m_value.load() == true ? 0xff : 0; }
 
-    uint32_t getEncodedValueUInt32() const override { return m_value == true ? 0xff : 0; }
+    uint32_t getEncodedValueUInt32() const override { return m_value.load() == true ? 0xff : 0; }
 
-    int64_t getEncodedValueInt64() const override { return m_value == true ? 0xff : 0; }
+    int64_t getEncodedValueInt64() const override { return m_value.load() == true ? 0xff : 0; }
 
-    uint64_t getEncodedValueUInt64() const override { return m_value == true ? 0xff : 0; }
+    uint64_t getEncodedValueUInt64() const override { return m_value.load() == true ? 0xff : 0; }
 
-    float getEncodedValueFloat() const override { return m_value == true ? 255.0f : 0.0f; }
+    float getEncodedValueFloat() const override { return m_value.load() == true ? 255.0f : 0.0f; }
 
-    double getEncodedValueDouble() const override { return m_value == true ? 255.0 : 0; }
+    double getEncodedValueDouble() const override { return m_value.load() == true ? 255.0 : 0; }
 
     void setFromEncodedValueAvdeccString( const AvdeccString *storage ) override { setUnencodedValueString( storage->get() ); }
 
@@ -2359,6 +2352,14 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     static const UnitsCode units = UnitsValue;
     static const int multiplier_power = MultiplierPowerValue;
 
+    /// the factors between the unencoded and encoded values, which depend only on multiplier_power
+    static constexpr value_type encoding_multiplier
+        = multiplier_power < 0 ? pow10Constant<value_type>( -multiplier_power ) : value_type( 1 );
+    static constexpr value_type encoding_divider
+        = multiplier_power > 0 ? pow10Constant<value_type>( multiplier_power ) : value_type( 1 );
+    static constexpr value_type decoding_multiplier = encoding_divider;
+    static constexpr value_type decoding_divider = encoding_multiplier;
+
     void setMinMaxStepDefault( EncodedT min_v, EncodedT max_v, EncodedT step_v, EncodedT default_v )
     {
         min_value = min_v;
@@ -2513,9 +2514,8 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
 
     bool setUnencodedValueString( string const &v, bool force ) override
     {
-        std::istringstream buf( v );
         value_type actual;
-        buf >> actual;
+        Util::parseNumber( v, actual );
         return setUnencodedValue( actual );
     }
 
@@ -2534,79 +2534,48 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
 
     bool setUnencodedValueUInt64( uint64_t v, bool force ) override { return setValue( (value_type)v, force ); }
 
+    bool isUnencodedValueInRangeDouble( double v ) const override { return isInRange( (value_type)v ); }
+
+    bool isUnencodedValueInRangeInt64( int64_t v ) const override { return isInRange( (value_type)v ); }
+
+    bool isUnencodedValueInRangeUInt64( uint64_t v ) const override { return isInRange( (value_type)v ); }
+
+    bool isUnencodedValueInRangeString( string const &v ) const override
+    {
+        value_type actual;
+        Util::parseNumber( v, actual );
+        return isInRange( actual );
+    }
+
+    ///
+    /// \brief isInRange
+    /// \return true if setValue( v ) would not throw range_error
+    ///
+    bool isInRange( value_type v ) const { return !( v < getMinValue() ) && !( v > getMaxValue() ); }
+
     string getUnencodedValueString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedMinimumString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getMinValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getMinValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedMaximumString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getMaxValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getMaxValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedStepString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getStepValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getStepValue(), multiplier_power, units, enable_units );
     }
 
     string getUnencodedDefaultString( bool enable_units ) const override
     {
-        std::ostringstream buf;
-        buf << getDefaultValue();
-        if ( enable_units )
-        {
-            const char *suffix = getAvdeccUnitsSuffix( units );
-            if ( suffix && *suffix )
-            {
-                buf << " " << suffix;
-            }
-        }
-        return buf.str();
+        return formatUnencodedNumber( getDefaultValue(), multiplier_power, units, enable_units );
     }
 
     bool getUnencodedValueBool() const override { return m_value != value_type(); }
@@ -2693,10 +2662,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     value_type getMinValue() const
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( min_value ) * decoding_multiplier / decoding_divider;
-        return v;
+        return value_type( min_value ) * decoding_multiplier / decoding_divider;
     }
 
     ///
@@ -2708,10 +2674,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     value_type getMaxValue() const
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( max_value ) * decoding_multiplier / decoding_divider;
-        return v;
+        return value_type( max_value ) * decoding_multiplier / decoding_divider;
     }
 
     ///
@@ -2723,10 +2686,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     value_type getDefaultValue() const
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( default_value ) * decoding_multiplier / decoding_divider;
-        return v;
+        return value_type( default_value ) * decoding_multiplier / decoding_divider;
     }
 
     ///
@@ -2738,10 +2698,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     value_type getStepValue() const
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( step_value ) * decoding_multiplier / decoding_divider;
-        return v;
+        return value_type( step_value ) * decoding_multiplier / decoding_divider;
     }
 
     ///
@@ -2754,15 +2711,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     /// \return The value to multiply with
     ///
-    value_type getEncodingMultiplier() const
-    {
-        value_type r = 1;
-        if ( multiplier_power < 0 )
-        {
-            r = integer_pow10<value_type>( r, -multiplier_power );
-        }
-        return r;
-    }
+    value_type getEncodingMultiplier() const { return encoding_multiplier; }
 
     ///
     /// \brief getEncodingDivider
@@ -2774,15 +2723,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     /// \return the value to divide with
     ///
-    value_type getEncodingDivider() const
-    {
-        value_type r = 1;
-        if ( multiplier_power > 0 )
-        {
-            r = integer_pow10<value_type>( r, multiplier_power );
-        }
-        return r;
-    }
+    value_type getEncodingDivider() const { return encoding_divider; }
 
     ///
     /// \brief getDecodingMultiplier
@@ -2794,15 +2735,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     /// \return The value to multiply with
     ///
-    value_type getDecodingMultiplier() const
-    {
-        value_type r = 1;
-        if ( multiplier_power > 0 )
-        {
-            r = integer_pow10<value_type>( r, multiplier_power );
-        }
-        return r;
-    }
+    value_type getDecodingMultiplier() const { return decoding_multiplier; }
 
     ///
     /// \brief getDecodingDivider
@@ -2814,15 +2747,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     /// \return the value to divide with
     ///
-    value_type getDecodingDivider() const
-    {
-        value_type r = 1;
-        if ( multiplier_power < 0 )
-        {
-            r = integer_pow10<value_type>( r, -multiplier_power );
-        }
-        return r;
-    }
+    value_type getDecodingDivider() const { return decoding_divider; }
 
     ///
     /// Default template function to help round integer types
@@ -2868,8 +2793,6 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     template <typename T>
     void getEncodedValue( T *dest ) const
     {
-        value_type encoding_multiplier = getEncodingMultiplier();
-        value_type encoding_divider = getEncodingDivider();
         value_type v = ( getValue() * encoding_multiplier / encoding_divider );
         value_type rounded_v;
 
@@ -2885,7 +2808,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
         {
             throw std::domain_error( "Max Value too large for encoding" );
         }
-        if ( getMinValue() * encoding_multiplier < (value_type)std::numeric_limits<T>::min() )
+        if ( getMinValue() * encoding_multiplier < (value_type)std::numeric_limits<T>::lowest() )
         {
             throw std::domain_error( "Min Value too small for encoding" );
         }
@@ -2980,10 +2903,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     template <typename T>
     bool setFromEncodedValue( T encoded_v )
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( encoded_v ) * decoding_multiplier / decoding_divider;
-        return setValue( v );
+        return setValue( value_type( encoded_v ) * decoding_multiplier / decoding_divider );
     }
 
     bool setFromEncodedValue( bool encoded_v ) { return setValue( encoded_v ); }
@@ -2991,8 +2911,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     void setFromEncodedValueAvdeccString( const AvdeccString *storage ) override
     {
         string s = storage->get();
-        std::istringstream buf( s );
-        buf >> m_value;
+        Util::parseNumber( s, m_value );
     }
 
     bool setFromEncodedValueInt8( int8_t v ) override { return setFromEncodedValue( v ); }
@@ -3027,10 +2946,7 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     template <typename T>
     bool setFromEncodedValueWithClamp( T encoded_v )
     {
-        value_type decoding_multiplier = getDecodingMultiplier();
-        value_type decoding_divider = getDecodingDivider();
-        value_type v = value_type( encoded_v ) * decoding_multiplier / decoding_divider;
-        return setValueWithClamp( v );
+        return setValueWithClamp( value_type( encoded_v ) * decoding_multiplier / decoding_divider );
     }
 
     bool setFromEncodedValueWithClampInt8( int8_t v ) override { return setFromEncodedValueWithClamp( v ); }
@@ -3102,4 +3018,19 @@ class RangedValueWithDynamicRangesFloat : public RangedValueBase
     ///
     value_type m_value;
 };
+
+///
+/// \brief The RangedValueReadOnly class
+///
+/// A RangedT which the schema treats as read only, such as a meter level
+/// which only the audio processing sets. The owner still sets it directly.
+///
+template <typename RangedT>
+class RangedValueReadOnly : public RangedT
+{
+  public:
+    using RangedT::RangedT;
+
+    bool isReadOnly() const override { return true; }
+};
 }
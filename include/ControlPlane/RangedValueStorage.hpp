@@ -0,0 +1,117 @@
+#pragma once
+
+#include "World.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The RangedValueAtomicStorage class
+///
+/// Storage policy for the scalar RangedValue templates which keeps the
+/// value in a std::atomic. A reader such as an audio callback can load the
+/// value without taking any lock while control sessions store new values.
+///
+/// Loads are acquire, stores are release. Read-modify-write updates such as
+/// incValue() use compareExchange() in a retry loop.
+///
+template <typename T>
+class RangedValueAtomicStorage
+{
+    std::atomic<T> m_value;
+
+  public:
+    using value_type = T;
+
+    RangedValueAtomicStorage() : m_value( T() ) {}
+
+    RangedValueAtomicStorage( T v ) : m_value( v ) {}
+
+    RangedValueAtomicStorage( RangedValueAtomicStorage const &other ) : m_value( other.load() ) {}
+
+    RangedValueAtomicStorage &operator=( RangedValueAtomicStorage const &other )
+    {
+        store( other.load() );
+        return *this;
+    }
+
+    T load() const { return m_value.load( std::memory_order_acquire ); }
+
+    void store( T v ) { m_value.store( v, std::memory_order_release ); }
+
+    ///
+    /// \brief exchange
+    ///
+    /// Store a new value
+    ///
+    /// \param v The new value
+    /// \return The previous value
+    ///
+    T exchange( T v ) { return m_value.exchange( v, std::memory_order_acq_rel ); }
+
+    ///
+    /// \brief compareExchange
+    ///
+    /// Store desired only if the current value is still expected
+    ///
+    /// \param expected The value the caller based desired on. Updated to
+    ///                 the current value on failure
+    /// \param desired The new value
+    /// \return true if desired was stored
+    ///
+    bool compareExchange( T &expected, T desired )
+    {
+        return m_value.compare_exchange_weak( expected, desired, std::memory_order_acq_rel, std::memory_order_acquire );
+    }
+
+    bool isLockFree() const { return m_value.is_lock_free(); }
+};
+
+///
+/// \brief The RangedValuePlainStorage class
+///
+/// Storage policy for the scalar RangedValue templates which keeps the
+/// value as a plain member. Consistency relies on external locking such
+/// as the Schema access mutex.
+///
+template <typename T>
+class RangedValuePlainStorage
+{
+    T m_value;
+
+  public:
+    using value_type = T;
+
+    RangedValuePlainStorage() : m_value( T() ) {}
+
+    RangedValuePlainStorage( T v ) : m_value( v ) {}
+
+    T load() const { return m_value; }
+
+    void store( T v ) { m_value = v; }
+
+    T exchange( T v )
+    {
+        T r = m_value;
+        m_value = v;
+        return r;
+    }
+
+    bool compareExchange( T &expected, T desired )
+    {
+        bool r = false;
+        if ( m_value == expected )
+        {
+            m_value = desired;
+            r = true;
+        }
+        else
+        {
+            expected = m_value;
+        }
+        return r;
+    }
+
+    bool isLockFree() const { return false; }
+};
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "World.hpp"
+#include "SpscRing.hpp"
+#include "ControlIdentity.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The RealtimeChangeIngress class
+///
+/// A wait-free path for a real time thread, such as the DSP thread, to
+/// report changed controls. The real time thread writes the values itself
+/// through the atomic storage of its RangedValues, then calls
+/// controlChanged(), which only pushes the identity onto a ring; it never
+/// locks, allocates or visits a notifier.
+///
+/// ChangeNotifierManager::tick() drains every ingress on its own thread and
+/// passes the changes to its notifiers as one set, with the time of the tick.
+///
+/// Each ingress has exactly one producer thread; give each real time thread
+/// its own.
+///
+class RealtimeChangeIngress
+{
+  public:
+    explicit RealtimeChangeIngress( size_t capacity = 1024 ) : m_ring( capacity ), m_dropped_count( 0 ) {}
+
+    ///
+    /// \brief controlChanged
+    ///
+    /// Called by the real time thread only
+    ///
+    /// \return false if the ring is full and the change was dropped; report it again in the next block
+    ///
+    bool controlChanged( ControlIdentityKey key )
+    {
+        bool r = m_ring.push( key );
+        if ( !r )
+        {
+            m_dropped_count.fetch_add( 1, std::memory_order_relaxed );
+        }
+        return r;
+    }
+
+    ///
+    /// \brief drain
+    ///
+    /// Called by the ChangeNotifierManager only. Move every queued change into items.
+    ///
+    /// \return the number of changes taken from the ring
+    ///
+    size_t drain( ControlIdentitySet &items );
+
+    size_t getCapacity() const { return m_ring.capacity(); }
+
+    uint64_t getDroppedCount() const { return m_dropped_count.load( std::memory_order_relaxed ); }
+
+  private:
+    SpscRing<ControlIdentityKey> m_ring;
+    std::atomic<uint64_t> m_dropped_count;
+};
+
+using RealtimeChangeIngressPtr = shared_ptr<RealtimeChangeIngress>;
+}
@@ -6,6 +6,12 @@
 #include "ControlContainer.hpp"
 #include "ChangeNotification.hpp"
 #include "ChangeNotifierManager.hpp"
+#include "ControlIdentityIndex.hpp"
+#include "SchemaAddressTrie.hpp"
+#include "SharedMutex.hpp"
+#include "ControlValueChange.hpp"
+#include "StaticSchema.hpp"
+#include "ControlHandle.hpp"
 
 namespace ControlPlane
 {
@@ -66,6 +72,27 @@ class SchemaErrorReadOnly : public SchemaError
     }
 };
 
+class SchemaErrorWrongValueType : public SchemaError
+{
+  public:
+    ControlIdentity m_identity;
+
+    SchemaErrorWrongValueType( ControlIdentity const &identity )
+        : SchemaError( Util::formstring( "SchemaErrorWrongValueType :", identity ) ), m_identity( identity )
+    {
+    }
+};
+
+class SchemaErrorNotAMeter : public SchemaError
+{
+  public:
+    ControlIdentityKey m_key;
+
+    SchemaErrorNotAMeter( ControlIdentityKey key ) : SchemaError( Util::formstring( "SchemaErrorNotAMeter :", key ) ), m_key( key )
+    {
+    }
+};
+
 class SchemaErrorNoSuchDescriptorForAddress : public SchemaError
 {
   public:
@@ -78,15 +105,87 @@ class SchemaErrorNoSuchDescriptorForAddress : public SchemaError
     }
 };
 
+///
+/// \brief The Schema class
+///
+/// The address, identity and descriptor tables are built once by the
+/// constructor and are immutable afterwards, so lookups take no lock.
+/// Reading a value takes the access mutex in shared mode so that readers
+/// run in parallel, and writing a value takes it exclusively. Change
+/// notification is delivered after the exclusive lock is released.
+///
+/// Scalar and bool values use atomic storage, so a real time thread may
+/// read and write them directly, for example through Gain::getValue(),
+/// without any lock. It reports the values it writes through a
+/// RealtimeChangeIngress from getChangeManager().addRealtimeIngress().
+/// Other code that reads RangedValueBase objects obtained from
+/// getRangedValueForControlIdentity() directly should hold getMutex()
+/// with a SharedLockGuard, and must not call getValue() or setValue()
+/// while holding it.
+///
+/// Code which knows the concrete type of a control, such as automation
+/// and DSP glue, resolves it once with getControlHandle() and then reads
+/// and writes it without virtual calls or lookups.
+///
+/// Every change reported to the ChangeNotifierManager gets the next number
+/// of a sequence and is kept in its ChangeJournal, so a subscriber can
+/// resume from the last sequence number it saw.
+///
+/// A Schema constructed from a StaticSchemaTable adopts the generated value
+/// index and builds only the address trie. The descriptors, the
+/// ControlContainer hierarchy and the address maps are built once, the
+/// first time getDescriptor(), getTop(), getAddressMap() or
+/// getIdentityMap() is called.
+///
 class Schema
 {
     void collectDescriptors();
 
+    void collectStaticDescriptors();
+
+    ///
+    /// \brief collectAddresses
+    ///
+    /// Build the descriptor, address and identity maps from the ControlContainer
+    /// hierarchy, and add the value index entries when index_values is set
+    ///
+    void collectAddresses( bool index_values );
+
+    void compileDescriptorIndex();
+
+    void requireDescriptors() const;
+
+    RangedValueBase *resolveRangedValueForControlIdentity( ControlIdentity const &identity,
+                                                           int item_num,
+                                                           int w_pos,
+                                                           int h_pos ) const;
+
+    static RangedValueBase *resolveRangedValue(
+        Descriptor::DescriptorBase const &descriptor, ControlIdentity const &identity, int item_num, int w_pos, int h_pos );
+
   public:
-    Schema( ControlContainerPtr top_level ) : m_top_level( top_level ) { collectDescriptors(); }
+    Schema( ControlContainerPtr top_level );
+
+    ///
+    /// \brief Schema
+    ///
+    /// Construct from the tables generated by a StaticSchemaLayout, which must
+    /// outlive the Schema
+    ///
+    explicit Schema( StaticSchemaTable const &table );
 
     ControlIdentity getIdentityForAddress( SchemaAddress const &address ) const;
 
+    ///
+    /// \brief getIdentityForPath
+    ///
+    /// Resolve a separator delimited address such as "/input/1/gain" directly,
+    /// without building a SchemaAddress
+    ///
+    /// throws SchemaErrorNoSuchDescriptorForAddress if the path is not found
+    ///
+    ControlIdentity getIdentityForPath( std::string const &path, char separator = '/' ) const;
+
     DescriptorPtr const getDescriptor( ControlIdentity const &identity ) const;
 
     DescriptorPtr getDescriptor( ControlIdentity const &identity );
@@ -111,10 +210,12 @@ class Schema
                    int w_pos = 0,
                    int h_pos = 0 )
     {
-        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
         bool changed = false;
         RangedValueBase *ranged_value = getRangedValueForControlIdentity( write_validator, identity, item_num, w_pos, h_pos );
-        changed = ranged_value->setUnencodedValue( value );
+        {
+            std::lock_guard<SharedMutex> lock( m_access_mutex );
+            changed = ranged_value->setUnencodedValue( value );
+        }
         if ( changed )
         {
             m_change_manager.controlChanged( current_time_in_milliseconds, identity );
@@ -130,10 +231,12 @@ class Schema
                    int w_pos = 0,
                    int h_pos = 0 )
     {
-        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
         bool changed = false;
         RangedValueBase *ranged_value = getRangedValueForControlIdentity( write_validator, identity, item_num, w_pos, h_pos );
-        changed = ranged_value->setUnencodedValueString( value );
+        {
+            std::lock_guard<SharedMutex> lock( m_access_mutex );
+            changed = ranged_value->setUnencodedValueString( value );
+        }
         if ( changed )
         {
             m_change_manager.controlChanged( current_time_in_milliseconds, identity );
@@ -150,44 +253,138 @@ class Schema
                    int w_pos = 0,
                    int h_pos = 0 )
     {
-        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
         return setValue(
             write_validator, current_time_in_milliseconds, value, getIdentityForAddress( address ), item_num, w_pos, h_pos );
     }
 
+    ///
+    /// \brief getControlHandle
+    ///
+    /// Resolve a control once to a handle which reads and writes its RangedT
+    /// directly. The write access is checked against write_validator here,
+    /// not on each write through the handle.
+    ///
+    /// throws SchemaErrorReadOnly if write_validator contains the control, and
+    /// SchemaErrorWrongValueType if the value of the control is not a RangedT
+    ///
+    template <typename RangedT>
+    ControlHandle<RangedT> getControlHandle( ControlIdentityComparatorPtr write_validator,
+                                             ControlIdentity const &identity,
+                                             int item_num = 0,
+                                             int w_pos = 0,
+                                             int h_pos = 0 )
+    {
+        RangedT *ranged_value
+            = dynamic_cast<RangedT *>( getRangedValueForControlIdentity( write_validator, identity, item_num, w_pos, h_pos ) );
+        if ( !ranged_value )
+        {
+            throw SchemaErrorWrongValueType( identity );
+        }
+        return ControlHandle<RangedT>( ranged_value, identity, m_access_mutex, m_change_manager );
+    }
+
+    template <typename RangedT>
+    ControlHandle<RangedT> getControlHandle( ControlIdentityComparatorPtr write_validator, SchemaAddress const &address )
+    {
+        return getControlHandle<RangedT>( write_validator, getIdentityForAddress( address ) );
+    }
+
+    template <typename RangedT>
+    ControlHandle<RangedT> getControlHandle( ControlIdentityComparatorPtr write_validator, std::string const &path )
+    {
+        return getControlHandle<RangedT>( write_validator, getIdentityForPath( path ) );
+    }
+
+    ///
+    /// \brief applyBatch
+    ///
+    /// Set many values as one transaction. Every identity is resolved and
+    /// checked against write_validator, and every value is checked against
+    /// the range of its control with ControlValueChange::validate(), before
+    /// anything is written; an out of range value throws range_error. Then
+    /// all of the values are written under a single exclusive lock. If a
+    /// write still throws, the values already written are restored and the
+    /// exception is rethrown. The change notifiers are told about all of the
+    /// changed controls in one pass after the lock is released.
+    ///
+    /// \param write_validator The comparator of read only controls, or nullptr
+    /// \param current_time_in_milliseconds The current time
+    /// \param changes pointer to the first change
+    /// \param num_changes the number of changes
+    /// \return The number of values which changed
+    ///
+    size_t applyBatch( ControlIdentityComparatorPtr write_validator,
+                       Milliseconds current_time_in_milliseconds,
+                       ControlValueChange const *changes,
+                       size_t num_changes );
+
+    size_t applyBatch( ControlIdentityComparatorPtr write_validator,
+                       Milliseconds current_time_in_milliseconds,
+                       std::vector<ControlValueChange> const &changes )
+    {
+        return applyBatch( write_validator, current_time_in_milliseconds, changes.data(), changes.size() );
+    }
+
     template <typename T>
     void getValue( T *value, ControlIdentity const &identity, int item_num = 0, int w_pos = 0, int h_pos = 0 ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
         RangedValueBase const *ranged_value = getRangedValueForControlIdentity( identity, item_num, w_pos, h_pos );
+        SharedLockGuard lock( m_access_mutex );
         ranged_value->getUnencodedValue( value );
     }
 
     template <typename T>
     void getValue( T *value, SchemaAddress const &address, int item_num = 0, int w_pos = 0, int h_pos = 0 ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
         getValue( value, getIdentityForAddress( address ), item_num, w_pos, h_pos );
     }
 
     ChangeNotifierManager &getChangeManager() { return m_change_manager; }
     ChangeNotifierManager const &getChangeManager() const { return m_change_manager; }
 
-    std::recursive_mutex &getMutex() const { return m_access_mutex; }
+    SharedMutex &getMutex() const { return m_access_mutex; }
+
+    ControlContainerPtr getTop()
+    {
+        requireDescriptors();
+        return m_top_level;
+    }
+
+    ControlContainerPtr const getTop() const
+    {
+        requireDescriptors();
+        return m_top_level;
+    }
+
+    std::map<SchemaAddress, ControlIdentity> const &getAddressMap() const
+    {
+        requireDescriptors();
+        return m_address_map;
+    }
+
+    std::map<ControlIdentityKey, SchemaAddress> const &getIdentityMap() const
+    {
+        requireDescriptors();
+        return m_identity_map;
+    }
 
-    ControlContainerPtr getTop() { return m_top_level; }
+    bool isStatic() const { return m_static_table.m_entries != nullptr; }
 
-    ControlContainerPtr const getTop() const { return m_top_level; }
+    ControlIdentityIndex const &getValueIndex() const { return m_value_index; }
 
-    std::map<SchemaAddress, ControlIdentity> const &getAddressMap() const { return m_address_map; }
-    std::map<ControlIdentity, SchemaAddress> const &getIdentityMap() const { return m_identity_map; }
+    SchemaAddressTrie const &getAddressTrie() const { return m_address_trie; }
 
   protected:
     ControlContainerPtr m_top_level;
     DescriptorAvdeccMap m_descriptor_avdecc_map;
     std::map<SchemaAddress, ControlIdentity> m_address_map;
-    std::map<ControlIdentity, SchemaAddress> m_identity_map;
+    std::map<ControlIdentityKey, SchemaAddress> m_identity_map;
+    ControlIdentityIndex m_descriptor_index;
+    ControlIdentityIndex m_value_index;
+    SchemaAddressTrie m_address_trie;
     ChangeNotifierManager m_change_manager;
-    mutable std::recursive_mutex m_access_mutex;
+    mutable SharedMutex m_access_mutex;
+    StaticSchemaTable m_static_table;
+    mutable std::once_flag m_descriptors_collected;
 };
 }
@@ -17,7 +17,7 @@ class SchemaAdaptorBase
 
     ChangeNotifierManager const &getChangeManager() const { return m_target.getChangeManager(); }
 
-    std::recursive_mutex &getMutex() const { return m_target.getMutex(); }
+    SharedMutex &getMutex() const { return m_target.getMutex(); }
 
     ControlContainerPtr getTop() { return m_target.getTop(); }
 
@@ -87,11 +87,10 @@ class SchemaAdaptor : public SchemaAdaptorBase
 
     std::map<AddressT, ControlIdentity> const &getAddressMap() const { return m_address_map; }
 
-    std::map<ControlIdentity, AddressT> const &getIdentityMap() const { return m_identity_map; }
+    std::map<ControlIdentityKey, AddressT> const &getIdentityMap() const { return m_identity_map; }
 
     EncodingType getEncodingTypeForAddress( AddressT const &address, int item_num = 0, int w_pos = 0, int h_pos = 0 ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( m_target.getMutex() );
         ControlIdentity identity;
         lookupIdentityForAddress( identity, address );
         RangedValueBase const *v = m_target.getRangedValueForControlIdentity( identity, item_num, w_pos, h_pos );
@@ -100,7 +99,6 @@ class SchemaAdaptor : public SchemaAdaptorBase
 
     EncodingType getStorageTypeForAddress( AddressT const &address, int item_num = 0, int w_pos = 0, int h_pos = 0 ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( m_target.getMutex() );
         ControlIdentity identity;
         lookupIdentityForAddress( identity, address );
         RangedValueBase const *v = m_target.getRangedValueForControlIdentity( identity, item_num, w_pos, h_pos );
@@ -122,7 +120,6 @@ class SchemaAdaptor : public SchemaAdaptorBase
     template <typename T>
     void getValue( T *value, AddressT const &address, int item_num = 0, int w_pos = 0, int h_pos = 0 ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( m_target.getMutex() );
         ControlIdentity identity;
         lookupIdentityForAddress( identity, address );
 
@@ -138,7 +135,6 @@ class SchemaAdaptor : public SchemaAdaptorBase
                    int w_pos = 0,
                    int h_pos = 0 )
     {
-        std::lock_guard<std::recursive_mutex> lock( m_target.getMutex() );
         try
         {
             ControlIdentity identity;
@@ -151,10 +147,37 @@ class SchemaAdaptor : public SchemaAdaptorBase
         }
     }
 
-    void lookupIdentityForAddress( ControlIdentity &identity, const AddressT &address ) const
+    ///
+    /// \brief addToBatch
+    ///
+    /// Append a change for the value at address to a batch for applyBatch()
+    ///
+    template <typename T>
+    void addToBatch( std::vector<ControlValueChange> &batch, AddressT const &address, T value ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( getMutex() );
+        ControlIdentity identity;
+        lookupIdentityForAddress( identity, address );
+        batch.push_back( ControlValueChange( identity, value ) );
+    }
 
+    size_t applyBatch( ControlIdentityComparatorPtr write_validator,
+                       Milliseconds current_time_in_milliseconds,
+                       std::vector<ControlValueChange> const &changes )
+    {
+        try
+        {
+            return m_target.applyBatch( write_validator, current_time_in_milliseconds, changes );
+        }
+        catch ( SchemaErrorReadOnly const &e )
+        {
+            AddressT address;
+            lookupAddressForIdentity( address, e.m_identity );
+            throw SchemaAdaptorErrorReadOnly( e.m_identity, address );
+        }
+    }
+
+    void lookupIdentityForAddress( ControlIdentity &identity, const AddressT &address ) const
+    {
         ControlIdentity r;
         auto i = m_address_map.find( address );
         if ( i != m_address_map.end() )
@@ -170,8 +193,11 @@ class SchemaAdaptor : public SchemaAdaptorBase
 
     void lookupAddressForIdentity( AddressT &address, const ControlIdentity &identity ) const
     {
-        std::lock_guard<std::recursive_mutex> lock( getMutex() );
+        lookupAddressForIdentity( address, ControlIdentityKey( identity ) );
+    }
 
+    void lookupAddressForIdentity( AddressT &address, ControlIdentityKey identity ) const
+    {
         AddressT r;
         auto i = m_identity_map.find( identity );
         if ( i != m_identity_map.end() )
@@ -213,7 +239,7 @@ class SchemaAdaptor : public SchemaAdaptorBase
                 range,
                 max_update_period_in_milliseconds,
                 min_update_period_in_milliseconds,
-                [=]( Milliseconds cur_time, ControlIdentityComparatorPtr const &r, std::set<ControlIdentity> const &items )
+                [=]( Milliseconds cur_time, ControlIdentityComparatorPtr const &r, ControlIdentityBitmap const &items )
                 {
                     std::set<AddressT> address_items;
                     for ( auto &i : items )
@@ -241,7 +267,7 @@ class SchemaAdaptor : public SchemaAdaptorBase
                 max_update_period_in_milliseconds,
                 min_update_period_in_milliseconds,
                 current_timestamp_in_milliseconds,
-                [=]( Milliseconds cur_time, ControlIdentityComparatorPtr const &r, std::set<ControlIdentity> const &items )
+                [=]( Milliseconds cur_time, ControlIdentityComparatorPtr const &r, ControlIdentityBitmap const &items )
                 {
                     std::set<AddressT> address_items;
                     for ( auto &i : items )
@@ -312,7 +338,7 @@ class SchemaAdaptor : public SchemaAdaptorBase
     }
 
     std::map<AddressT, ControlIdentity> m_address_map;
-    std::map<ControlIdentity, AddressT> m_identity_map;
+    std::map<ControlIdentityKey, AddressT> m_identity_map;
 };
 
 bool getAddressForIdentity( ControlIdentity &address,
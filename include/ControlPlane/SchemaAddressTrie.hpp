@@ -0,0 +1,136 @@
+#pragma once
+
+#include "World.hpp"
+#include "ControlIdentity.hpp"
+#include "ControlContainer.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The SchemaAddressTrie class
+///
+/// A prefix tree of every SchemaAddress in a ControlContainer hierarchy.
+///
+/// Each distinct SchemaAddressElement is interned once into an integer
+/// Atom, and a whole path is then a compact sequence of Atoms. Resolving
+/// an address walks one trie edge per element, so the cost is O(depth)
+/// and no heap allocation is done on lookup.
+///
+class SchemaAddressTrie
+{
+  public:
+    using Atom = uint32_t;
+    using AtomPath = std::vector<Atom>;
+
+    static const Atom no_atom = 0xffffffff;
+
+    SchemaAddressTrie() { clear(); }
+
+    void clear();
+
+    ///
+    /// \brief reserve
+    ///
+    /// Make room for about num_addresses addresses, so that building a large
+    /// trie does not repeatedly grow the node array and rehash the edges
+    ///
+    void reserve( size_t num_addresses );
+
+    ///
+    /// \brief build
+    ///
+    /// Clear the trie and rebuild it from all of the control points
+    /// held in the top level container and its children
+    ///
+    /// \param top The top level ControlContainer
+    ///
+    void build( ControlContainer const &top );
+
+    ///
+    /// \brief insert
+    ///
+    /// Add a single address to the trie, interning any new elements
+    ///
+    void insert( SchemaAddress const &address, ControlIdentity const &identity );
+
+    ///
+    /// \brief insert
+    ///
+    /// Add a single address given as an array of nul terminated elements,
+    /// without building a SchemaAddress
+    ///
+    void insert( const char *const *path, size_t depth, ControlIdentityKey key );
+
+    ///
+    /// \brief findAtom
+    ///
+    /// \param s pointer to the first character of the element
+    /// \param length number of characters in the element
+    /// \return The Atom for the element, or no_atom if the element was never interned
+    ///
+    Atom findAtom( const char *s, size_t length ) const;
+
+    Atom findAtom( SchemaAddressElement const &element ) const { return findAtom( element.data(), element.length() ); }
+
+    SchemaAddressElement const &getAtomString( Atom atom ) const { return m_atom_strings.at( atom ); }
+
+    ///
+    /// \brief toAtomPath
+    ///
+    /// Convert an address to its interned form
+    ///
+    /// \return false if any element of the address was never interned
+    ///
+    bool toAtomPath( SchemaAddress const &address, AtomPath *result ) const;
+
+    bool find( SchemaAddress const &address, ControlIdentity *identity ) const;
+
+    bool find( AtomPath const &path, ControlIdentity *identity ) const;
+
+    ///
+    /// \brief findPath
+    ///
+    /// Resolve a separator delimited path such as "/input/1/gain" without
+    /// splitting it into a SchemaAddress first. Empty elements are skipped.
+    ///
+    /// \param path pointer to the first character of the path
+    /// \param length number of characters in the path
+    /// \param separator the separator between elements
+    /// \param identity the resulting identity
+    /// \return true if the path was found
+    ///
+    bool findPath( const char *path, size_t length, char separator, ControlIdentity *identity ) const;
+
+    size_t getNumAtoms() const { return m_atom_strings.size(); }
+
+    size_t getNumNodes() const { return m_nodes.size(); }
+
+  private:
+    static uint32_t hashElement( const char *s, size_t length );
+
+    Atom intern( const char *s, size_t length );
+
+    Atom intern( SchemaAddressElement const &element ) { return intern( element.data(), element.length() ); }
+
+    uint32_t findChild( uint32_t node, Atom atom ) const;
+
+    uint32_t addChild( uint32_t node, Atom atom );
+
+    void buildNode( uint32_t node, ControlContainer const &container );
+
+    static uint64_t edgeKey( uint32_t node, Atom atom ) { return ( uint64_t( node ) << 32 ) | atom; }
+
+    static const uint32_t no_node = 0xffffffff;
+
+    std::vector<SchemaAddressElement> m_atom_strings;
+
+    /// open addressed hash table of atom + 1, zero for an empty slot
+    std::vector<uint32_t> m_atom_slots;
+
+    /// the identity held at each node, or the invalid key for interior nodes
+    std::vector<ControlIdentityKey> m_nodes;
+
+    std::unordered_map<uint64_t, uint32_t> m_edges;
+};
+}
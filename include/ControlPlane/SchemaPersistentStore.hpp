@@ -0,0 +1,177 @@
+#pragma once
+
+#include "World.hpp"
+#include "Schema.hpp"
+#include "ChangeNotifier.hpp"
+
+namespace ControlPlane
+{
+
+class SchemaErrorPersistentStore : public SchemaError
+{
+  public:
+    SchemaErrorPersistentStore( const std::string &e ) : SchemaError( Util::formstring( "SchemaErrorPersistentStore:", e ) )
+    {
+    }
+};
+
+///
+/// \brief The SchemaPersistentStore class
+///
+/// Keeps every value of a Schema in a memory mapped file with a fixed
+/// layout, so that state survives a restart without replaying text
+/// commands.
+///
+/// The file is a FileHeader followed by one slot per entry of the Schema
+/// value index, in ControlIdentityKey order. Each slot is a SlotHeader
+/// holding the key, EncodingType and encoding multiplier, followed by the
+/// raw encoded bits of a numeric value or the characters of a string
+/// value. The FileHeader holds a hash of the schema layout; when it
+/// matches, open() loads the values directly from the slots without any
+/// parsing.
+///
+/// When the hash does not match, for example after a firmware update,
+/// open() copies over the values whose identity and encoding are unchanged,
+/// and then rewrites the file in the new layout. A new file is written to
+/// a temporary file beside it, slots first and the FileHeader last, and
+/// renamed over the old one once it is on disk, so a crash leaves either
+/// the old file or the complete new one.
+///
+/// Once added to the Schema's ChangeNotifierManager, every changed value is
+/// written into its slot as it changes. The dirty pages are flushed by
+/// tick() at most once per sync period, with adjacent dirty pages
+/// coalesced into a single msync. tick() only starts the write back, so
+/// that notification never waits for the disk; close() waits for it.
+///
+class SchemaPersistentStore : public ChangeNotifier
+{
+  public:
+    enum class OpenResult
+    {
+        /// the file matched the schema and its values were loaded
+        Loaded,
+        /// the file had a different layout, matching values were loaded and the file rewritten
+        Migrated,
+        /// there was no usable file, so it was created from the live values
+        Created
+    };
+
+    static const uint32_t version = 1;
+
+    struct FileHeader
+    {
+        char m_magic[4];
+        uint32_t m_byte_order;
+        uint32_t m_version;
+        uint32_t m_num_slots;
+        uint64_t m_schema_hash;
+        uint64_t m_file_size;
+        uint8_t m_reserved[32];
+    };
+
+    struct SlotHeader
+    {
+        uint64_t m_key;
+        uint8_t m_encoding_type;
+        int8_t m_multiplier_power;
+        uint16_t m_length;
+        uint32_t m_capacity;
+    };
+
+    SchemaPersistentStore( Schema &schema, std::string const &path, Milliseconds sync_period = Milliseconds( 100 ) );
+
+    virtual ~SchemaPersistentStore();
+
+    ///
+    /// \brief open
+    ///
+    /// Open or create the file, map it and load the stored values into the
+    /// schema. The changed controls are passed to the change notifiers.
+    ///
+    /// throws SchemaErrorPersistentStore if the file can not be created or mapped
+    ///
+    OpenResult open( Milliseconds current_time_in_milliseconds = Milliseconds( 0 ) );
+
+    ///
+    /// \brief close
+    ///
+    /// Flush and unmap the file
+    ///
+    void close();
+
+    bool isOpen() const { return m_map != nullptr; }
+
+    ///
+    /// \brief sync
+    ///
+    /// Flush the dirty pages of the mapping to the file now, waiting until
+    /// they are on disk if wait is true
+    ///
+    void sync( bool wait = false );
+
+    ///
+    /// \brief getLastSyncRangeCount
+    /// \return the number of contiguous ranges flushed by the last sync()
+    ///
+    size_t getLastSyncRangeCount() const { return m_last_sync_range_count; }
+
+    ///
+    /// \brief computeSchemaHash
+    ///
+    /// \return a hash of the identities, encodings and ranges of every value in the schema
+    ///
+    static uint64_t computeSchemaHash( Schema const &schema );
+
+    void controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity control_identity ) override;
+
+    void controlsChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentitySet const &items ) override;
+
+    void tick( Milliseconds current_timestamp_in_milliseconds ) override;
+
+  private:
+    static size_t getSlotCapacity( EncodingType t );
+
+    void computeLayout();
+
+    bool loadExisting( std::vector<uint8_t> const &contents, ControlIdentitySet &changed_items );
+
+    void loadSlots( uint8_t const *slots, size_t slots_size, size_t num_slots, ControlIdentitySet &changed_items );
+
+    void createFile();
+
+    void mapFile( std::string const &path );
+
+    void unmapFile();
+
+    void writeSlot( size_t ordinal );
+
+    void writeSlotForIdentity( ControlIdentityKey key );
+
+    void markDirty( size_t offset, size_t length );
+
+    Schema &m_schema;
+    std::string m_path;
+    Milliseconds m_sync_period;
+    Milliseconds m_last_sync_time;
+
+    uint64_t m_schema_hash;
+    std::vector<size_t> m_slot_offsets;
+    size_t m_file_size;
+
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_fd;
+#endif
+    uint8_t *m_map;
+
+    size_t m_page_size;
+    std::vector<bool> m_dirty_pages;
+    size_t m_first_dirty_page;
+    size_t m_last_dirty_page;
+    size_t m_last_sync_range_count;
+};
+
+using SchemaPersistentStorePtr = shared_ptr<SchemaPersistentStore>;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "World.hpp"
+#include "Schema.hpp"
+#include "ControlIdentityComparator.hpp"
+
+namespace ControlPlane
+{
+
+class SchemaErrorSnapshot : public SchemaError
+{
+  public:
+    SchemaErrorSnapshot( const std::string &e ) : SchemaError( Util::formstring( "SchemaErrorSnapshot:", e ) ) {}
+};
+
+///
+/// \brief The SchemaSnapshot class
+///
+/// The encoded values of a set of controls in a Schema, held in a compact
+/// binary blob in ControlIdentity order so that it can be stored and
+/// recalled as a scene.
+///
+/// The blob is a header of the magic "CPSS", a version byte and a 32 bit
+/// item count, followed by one record per control of the 64 bit packed
+/// ControlIdentityKey, the EncodingType byte and the encoded value. Numeric
+/// values are stored in their transport width and strings as a 16 bit
+/// length and the characters. All multi-byte fields are big endian.
+///
+class SchemaSnapshot
+{
+  public:
+    static const uint8_t version = 1;
+
+    SchemaSnapshot() : m_num_items( 0 ) {}
+
+    ///
+    /// \brief SchemaSnapshot
+    ///
+    /// Construct from a previously saved blob.
+    ///
+    /// throws SchemaErrorSnapshot if the blob is malformed
+    ///
+    explicit SchemaSnapshot( std::vector<uint8_t> blob );
+
+    ///
+    /// \brief capture
+    ///
+    /// Capture the encoded value of every control in the schema, or of only
+    /// the controls which selection contains
+    ///
+    /// \param schema The schema to capture
+    /// \param selection The controls to capture, or nullptr for all of them
+    /// \return The snapshot
+    ///
+    static SchemaSnapshot capture( Schema const &schema, ControlIdentityComparatorPtr selection = nullptr );
+
+    ///
+    /// \brief restore
+    ///
+    /// Write the captured values back to the schema. Each value is compared
+    /// with the live encoded value first and only the controls which differ
+    /// are written, under a single exclusive lock, and then passed to the
+    /// change notifiers as one set. Controls which are read only, which
+    /// write_validator contains, or which no longer exist in the schema are
+    /// skipped. Values are clamped to the current range of each control.
+    ///
+    /// \param schema The schema to restore into
+    /// \param write_validator The comparator of read only controls, or nullptr
+    /// \param current_time_in_milliseconds The current time
+    /// \return The number of controls which changed
+    ///
+    size_t restore( Schema &schema,
+                    ControlIdentityComparatorPtr write_validator,
+                    Milliseconds current_time_in_milliseconds ) const;
+
+    std::vector<uint8_t> const &getBlob() const { return m_blob; }
+
+    size_t getNumItems() const { return m_num_items; }
+
+  private:
+    static const size_t header_size = 9;
+
+    void validate() const;
+
+    std::vector<uint8_t> m_blob;
+    size_t m_num_items;
+};
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "World.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The SharedMutex class
+///
+/// A reader/writer lock. Any number of readers may hold the lock at
+/// once with lock_shared(), while lock() waits for all readers to leave
+/// and holds the lock exclusively. A waiting writer stops new readers
+/// from entering so that a steady stream of readers can not starve it.
+///
+/// The lock is not recursive in either mode; the holder must not try to
+/// take it again.
+///
+/// Satisfies the Lockable requirements so std::lock_guard<SharedMutex>
+/// can be used for exclusive access, and SharedLockGuard for shared access.
+///
+class SharedMutex
+{
+  public:
+    SharedMutex() : m_state( 0 ) {}
+
+    SharedMutex( SharedMutex const & ) = delete;
+    SharedMutex &operator=( SharedMutex const & ) = delete;
+
+    void lock()
+    {
+        for ( ;; )
+        {
+            uint32_t s = m_state.load( std::memory_order_relaxed );
+            if ( ( s & writer_bit ) == 0 )
+            {
+                if ( ( s & reader_mask ) == 0 )
+                {
+                    if ( m_state.compare_exchange_weak( s, writer_bit, std::memory_order_acquire ) )
+                    {
+                        break;
+                    }
+                    continue;
+                }
+                else if ( ( s & writer_waiting_bit ) == 0 )
+                {
+                    m_state.compare_exchange_weak( s, s | writer_waiting_bit, std::memory_order_relaxed );
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    bool try_lock()
+    {
+        uint32_t s = m_state.load( std::memory_order_relaxed );
+        return ( s & ( writer_bit | reader_mask ) ) == 0
+               && m_state.compare_exchange_strong( s, writer_bit, std::memory_order_acquire );
+    }
+
+    void unlock() { m_state.fetch_and( ~writer_bit, std::memory_order_release ); }
+
+    void lock_shared()
+    {
+        for ( ;; )
+        {
+            uint32_t s = m_state.load( std::memory_order_relaxed );
+            if ( ( s & ( writer_bit | writer_waiting_bit ) ) == 0 )
+            {
+                if ( m_state.compare_exchange_weak( s, s + 1, std::memory_order_acquire ) )
+                {
+                    break;
+                }
+                continue;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    bool try_lock_shared()
+    {
+        uint32_t s = m_state.load( std::memory_order_relaxed );
+        return ( s & ( writer_bit | writer_waiting_bit ) ) == 0
+               && m_state.compare_exchange_strong( s, s + 1, std::memory_order_acquire );
+    }
+
+    void unlock_shared() { m_state.fetch_sub( 1, std::memory_order_release ); }
+
+  private:
+    static const uint32_t writer_bit = 0x80000000;
+    static const uint32_t writer_waiting_bit = 0x40000000;
+    static const uint32_t reader_mask = 0x3fffffff;
+
+    std::atomic<uint32_t> m_state;
+};
+
+///
+/// \brief The SharedLockGuard class
+///
+/// Holds a SharedMutex in shared mode for the lifetime of the object
+///
+class SharedLockGuard
+{
+    SharedMutex &m_mutex;
+
+  public:
+    explicit SharedLockGuard( SharedMutex &mutex ) : m_mutex( mutex ) { m_mutex.lock_shared(); }
+
+    ~SharedLockGuard() { m_mutex.unlock_shared(); }
+
+    SharedLockGuard( SharedLockGuard const & ) = delete;
+    SharedLockGuard &operator=( SharedLockGuard const & ) = delete;
+};
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "World.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The SpscRing class
+///
+/// A bounded, wait-free queue for exactly one producer thread and one
+/// consumer thread. push() and pop() never lock or allocate; the slots are
+/// allocated once by the constructor. The capacity is rounded up to a
+/// power of two.
+///
+/// The producer only writes m_tail and the consumer only writes m_head, so
+/// each side does one acquire load of the other's index and one release
+/// store of its own.
+///
+template <typename T>
+class SpscRing
+{
+  public:
+    explicit SpscRing( size_t capacity ) : m_slots( roundUpToPowerOfTwo( capacity ) ), m_head( 0 ), m_tail( 0 )
+    {
+        m_mask = m_slots.size() - 1;
+    }
+
+    SpscRing( SpscRing const & ) = delete;
+    SpscRing &operator=( SpscRing const & ) = delete;
+
+    ///
+    /// \brief push
+    ///
+    /// Called by the producer only
+    ///
+    /// \return false if the ring is full, in which case v is left unchanged
+    ///
+    bool push( T &&v )
+    {
+        bool r = false;
+        size_t tail = m_tail.load( std::memory_order_relaxed );
+        if ( tail - m_head.load( std::memory_order_acquire ) < m_slots.size() )
+        {
+            m_slots[tail & m_mask] = std::move( v );
+            m_tail.store( tail + 1, std::memory_order_release );
+            r = true;
+        }
+        return r;
+    }
+
+    bool push( T const &v )
+    {
+        T copy( v );
+        return push( std::move( copy ) );
+    }
+
+    ///
+    /// \brief pop
+    ///
+    /// Called by the consumer only
+    ///
+    /// \return false if the ring is empty
+    ///
+    bool pop( T &v )
+    {
+        bool r = false;
+        size_t head = m_head.load( std::memory_order_relaxed );
+        if ( head != m_tail.load( std::memory_order_acquire ) )
+        {
+            v = std::move( m_slots[head & m_mask] );
+            m_head.store( head + 1, std::memory_order_release );
+            r = true;
+        }
+        return r;
+    }
+
+    bool empty() const { return m_head.load( std::memory_order_acquire ) == m_tail.load( std::memory_order_acquire ); }
+
+    size_t size() const { return m_tail.load( std::memory_order_acquire ) - m_head.load( std::memory_order_acquire ); }
+
+    size_t capacity() const { return m_slots.size(); }
+
+  private:
+    static size_t roundUpToPowerOfTwo( size_t n )
+    {
+        size_t r = 1;
+        while ( r < n )
+        {
+            r <<= 1;
+        }
+        return r;
+    }
+
+    std::vector<T> m_slots;
+    size_t m_mask;
+
+    // the consumer and producer indexes are padded onto separate cache lines so the two threads do not share one
+    char m_head_padding[64];
+    std::atomic<size_t> m_head;
+    char m_tail_padding[64];
+    std::atomic<size_t> m_tail;
+};
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "World.hpp"
+#include "Avdecc.hpp"
+#include "RangedValue.hpp"
+#include "ControlIdentity.hpp"
+#include "ControlIdentityIndex.hpp"
+
+namespace ControlPlane
+{
+
+///
+/// \brief The StaticControlInfo struct
+///
+/// Describes one control that every channel of a StaticChannelGroup holds
+///
+struct StaticControlInfo
+{
+    /// the last element of the address and the name of the ControlValue, such as "gain"
+    const char *m_name;
+
+    /// appended to the channel description to describe the control, such as "Gain"
+    const char *m_description;
+
+    uint64_t m_control_type;
+    uint16_t m_control_value_type;
+};
+
+///
+/// \brief The StaticChannelGroupInfo struct
+///
+/// Describes a group of identical channels, such as the inputs of a device
+///
+struct StaticChannelGroupInfo
+{
+    /// the first element of the address, such as "input"
+    const char *m_name;
+
+    /// followed by the channel number to describe a channel, such as "Input"
+    const char *m_description;
+};
+
+///
+/// \brief The StaticSchemaAddress struct
+///
+/// The address and descriptor details of one entry of a StaticSchemaTable.
+/// The address is the group name, the channel name and the control name.
+///
+struct StaticSchemaAddress
+{
+    static const size_t depth = 3;
+
+    StaticChannelGroupInfo const *m_group;
+    const char *m_channel_name;
+    StaticControlInfo const *m_control;
+};
+
+///
+/// \brief The StaticSchemaTable struct
+///
+/// The tables generated by a StaticSchemaLayout: the value index entries
+/// sorted by ControlIdentityKey, and the address of each entry in the same
+/// order. Both arrays have static storage duration.
+///
+struct StaticSchemaTable
+{
+    ControlIdentityIndex::Entry const *m_entries;
+    StaticSchemaAddress const *m_addresses;
+    size_t m_num_entries;
+};
+
+template <size_t... Is>
+struct StaticIndices
+{
+};
+
+template <typename FirstT, typename SecondT>
+struct StaticIndicesConcat;
+
+template <size_t... FirstIs, size_t... SecondIs>
+struct StaticIndicesConcat<StaticIndices<FirstIs...>, StaticIndices<SecondIs...> >
+{
+    using type = StaticIndices<FirstIs..., ( sizeof...( FirstIs ) + SecondIs )...>;
+};
+
+///
+/// \brief The MakeStaticIndices struct
+///
+/// StaticIndices<0, 1, ... N - 1>, built by halving so that the template
+/// depth is logarithmic in N
+///
+template <size_t N>
+struct MakeStaticIndices
+{
+    using type = typename StaticIndicesConcat<typename MakeStaticIndices<N / 2>::type,
+                                              typename MakeStaticIndices<N - N / 2>::type>::type;
+};
+
+template <>
+struct MakeStaticIndices<0>
+{
+    using type = StaticIndices<>;
+};
+
+template <>
+struct MakeStaticIndices<1>
+{
+    using type = StaticIndices<0>;
+};
+
+///
+/// \brief The StaticDecimal struct
+///
+/// StaticDecimal<N>::value is the decimal representation of N, for N > 0,
+/// as a nul terminated array in read only data
+///
+template <size_t N, char... DigitsT>
+struct StaticDecimal : StaticDecimal<N / 10, char( '0' + N % 10 ), DigitsT...>
+{
+};
+
+template <char... DigitsT>
+struct StaticDecimal<0, DigitsT...>
+{
+    static const char value[sizeof...( DigitsT ) + 1];
+};
+
+template <char... DigitsT>
+const char StaticDecimal<0, DigitsT...>::value[sizeof...( DigitsT ) + 1] = {DigitsT..., '\0'};
+
+template <size_t I, typename FirstT, typename... RestT>
+struct StaticTypeAt : StaticTypeAt<I - 1, RestT...>
+{
+};
+
+template <typename FirstT, typename... RestT>
+struct StaticTypeAt<0, FirstT, RestT...>
+{
+    using type = FirstT;
+};
+
+template <size_t... ValuesT>
+struct StaticSum;
+
+template <>
+struct StaticSum<>
+{
+    static const size_t value = 0;
+};
+
+template <size_t FirstT, size_t... RestT>
+struct StaticSum<FirstT, RestT...>
+{
+    static const size_t value = FirstT + StaticSum<RestT...>::value;
+};
+
+///
+/// \brief The StaticControl struct
+///
+/// One control of each channel of a StaticChannelGroup: the ChannelT member
+/// which holds the value, and its description
+///
+template <typename ChannelT, typename ValueT, ValueT ChannelT::*member, StaticControlInfo const &info>
+struct StaticControl
+{
+    static constexpr RangedValueBase *getRangedValue( ChannelT &channel ) { return &( channel.*member ); }
+
+    static constexpr StaticControlInfo const *getInfo() { return &info; }
+};
+
+///
+/// \brief The StaticChannelGroup struct
+///
+/// A fixed size array of channels held in the storage object, where every
+/// channel holds the same StaticControl list. Each control of each channel
+/// is one CONTROL descriptor with a single value, addressed as
+/// "group/channel/control" with channels numbered from 1.
+///
+/// \tparam StorageT the type of the object which holds all of the values
+/// \tparam storage the storage object, which must have static storage duration and external linkage
+/// \tparam ChannelT the type of one channel
+/// \tparam NumChannels the number of channels
+/// \tparam channels the array of channels in StorageT
+/// \tparam info the name and description of the group, with external linkage
+/// \tparam ControlsT the StaticControl of each control in a channel
+///
+template <typename StorageT,
+          StorageT &storage,
+          typename ChannelT,
+          size_t NumChannels,
+          ChannelT ( StorageT::*channels )[NumChannels],
+          StaticChannelGroupInfo const &info,
+          typename... ControlsT>
+struct StaticChannelGroup
+{
+    static const size_t num_channels = NumChannels;
+    static const size_t num_controls = sizeof...( ControlsT );
+    static const size_t num_entries = num_channels * num_controls;
+
+    template <size_t I>
+    using Control = typename StaticTypeAt<I % num_controls, ControlsT...>::type;
+
+    template <size_t I, size_t DescriptorIndexT>
+    static constexpr ControlIdentityIndex::Entry getEntry()
+    {
+        return ControlIdentityIndex::Entry{ControlIdentityKey( ControlIdentityKey::packFields(
+                                               AVDECC_DESCRIPTOR_CONTROL, DescriptorIndexT, ControlIdentity::SectionWPosLevel ) ),
+                                           Control<I>::getRangedValue( ( storage.*channels )[I / num_controls] ),
+                                           nullptr};
+    }
+
+    template <size_t I>
+    static constexpr StaticSchemaAddress getAddress()
+    {
+        return StaticSchemaAddress{&info, StaticDecimal<I / num_controls + 1>::value, Control<I>::getInfo()};
+    }
+};
+
+///
+/// \brief The StaticSchemaSelect struct
+///
+/// Locates entry I of the concatenation of the entries of all of the groups
+///
+template <size_t I, size_t LocalI, bool InFirstGroupT, typename... GroupsT>
+struct StaticSchemaSelectIn;
+
+template <size_t I, size_t LocalI, typename GroupT, typename... RestT>
+struct StaticSchemaSelect : StaticSchemaSelectIn<I, LocalI, ( LocalI < GroupT::num_entries ), GroupT, RestT...>
+{
+};
+
+template <size_t I, size_t LocalI, typename GroupT, typename... RestT>
+struct StaticSchemaSelectIn<I, LocalI, true, GroupT, RestT...>
+{
+    static constexpr ControlIdentityIndex::Entry getEntry() { return GroupT::template getEntry<LocalI, I>(); }
+
+    static constexpr StaticSchemaAddress getAddress() { return GroupT::template getAddress<LocalI>(); }
+};
+
+template <size_t I, size_t LocalI, typename GroupT, typename... RestT>
+struct StaticSchemaSelectIn<I, LocalI, false, GroupT, RestT...> : StaticSchemaSelect<I, LocalI - GroupT::num_entries, RestT...>
+{
+};
+
+template <typename IndicesT, typename... GroupsT>
+struct StaticSchemaTables;
+
+template <size_t... Is, typename... GroupsT>
+struct StaticSchemaTables<StaticIndices<Is...>, GroupsT...>
+{
+    static const ControlIdentityIndex::Entry entries[sizeof...( Is )];
+    static const StaticSchemaAddress addresses[sizeof...( Is )];
+};
+
+template <size_t... Is, typename... GroupsT>
+const ControlIdentityIndex::Entry StaticSchemaTables<StaticIndices<Is...>, GroupsT...>::entries[sizeof...( Is )]
+    = {StaticSchemaSelect<Is, Is, GroupsT...>::getEntry()...};
+
+template <size_t... Is, typename... GroupsT>
+const StaticSchemaAddress StaticSchemaTables<StaticIndices<Is...>, GroupsT...>::addresses[sizeof...( Is )]
+    = {StaticSchemaSelect<Is, Is, GroupsT...>::getAddress()...};
+
+///
+/// \brief The StaticSchemaLayout struct
+///
+/// A schema layout which is fixed at compile time, such as the controls of
+/// a device with fixed hardware. The value index entries, with their
+/// ControlIdentityKey and RangedValueBase pointers, and the addresses of
+/// the controls are generated by the compiler as constant arrays, so a
+/// Schema constructed from getTable() builds none of them at run time.
+///
+/// The CONTROL descriptors are numbered from 0 in the order of the groups,
+/// channels and controls, so the entries are already in key order.
+///
+/// \tparam GroupsT the StaticChannelGroup types
+///
+template <typename... GroupsT>
+struct StaticSchemaLayout
+{
+    static const size_t num_entries = StaticSum<GroupsT::num_entries...>::value;
+
+    static_assert( num_entries > 0, "StaticSchemaLayout: no controls" );
+    static_assert( num_entries <= 0x10000, "StaticSchemaLayout: too many CONTROL descriptors" );
+
+    using Tables = StaticSchemaTables<typename MakeStaticIndices<num_entries>::type, GroupsT...>;
+
+    static StaticSchemaTable getTable() { return StaticSchemaTable{Tables::entries, Tables::addresses, num_entries}; }
+};
+}
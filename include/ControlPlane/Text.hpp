@@ -79,9 +79,22 @@ struct TextProtocolSession
 
     virtual void handleUnsubscribe( Milliseconds current_time_in_milliseconds, string const &line );
 
+    ///
+    /// \brief handleOtherCommands
+    ///
+    /// ":sleep", ":seq" which replies ":seq" and the sequence number of the
+    /// last change of the schema, and ":resume <seq>" which sends the current
+    /// value of each control changed after seq, then ":seq" and the sequence
+    /// number to resume from next time, or only ":resync" and the sequence
+    /// number if the changes since seq are no longer in the journal, and
+    /// ":stats [on|off|reset]" which replies ":stats" and the sum of the
+    /// ChangeNotifierStats of every notifier of the schema
+    ///
     virtual void handleOtherCommands( Milliseconds current_time_in_milliseconds, string const &line );
 
   protected:
+    virtual void handleResume( Milliseconds current_time_in_milliseconds, uint64_t sequence );
+
     virtual void handleIndividualGet( Milliseconds current_time_in_milliseconds, TextAddress const &address );
 
     virtual void handleIndividualSet( Milliseconds current_time_in_milliseconds, TextAddress const &address, string const &v );
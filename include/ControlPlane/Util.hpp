@@ -1,6 +1,7 @@
 #pragma once
 
 #include "World.hpp"
+#include "NumberFormat.hpp"
 
 namespace ControlPlane
 {
@@ -18,6 +19,19 @@ void lexical_cast( OutT &r, InT const &v )
     buf >> r;
 }
 
+///
+/// \brief lexical_cast
+///
+/// Parse a number from a string with parseNumber() instead of a stringstream. A stream reads
+/// bool and the char types as characters, so those still go through the general form.
+///
+template <typename OutT>
+typename std::enable_if<std::is_arithmetic<OutT>::value && !std::is_same<OutT, bool>::value && ( sizeof( OutT ) > 1 )>::type
+    lexical_cast( OutT &r, string const &v )
+{
+    parseNumber( v, r );
+}
+
 template <typename FirstArg>
 void emit_formstring( std::stringstream &result, FirstArg &&first )
 {
@@ -24,7 +24,7 @@ using Gain = RangedValue<UnitsCode::LevelDb, -900, 100, 0, 10, -1, int32_t, floa
  */
 using ControlStringValue = RangedValue<UnitsCode::Unitless, 0, 0, 0, 0, 0, ControlPlane::AvdeccControlString, std::string>;
 
-using VuMeterDbFsPeak = RangedValue<UnitsCode::LevelDbFsPeak, -128, 0, 0, 1, -1, int8_t, float>;
+using VuMeterDbFsPeak = RangedValueReadOnly<RangedValue<UnitsCode::LevelDbFsPeak, -128, 0, 0, 1, -1, int8_t, float>>;
 
 using DescriptorString = RangedValue<UnitsCode::Unitless, 0, 0, 0, 0, 0, ControlPlane::AvdeccNameString, std::string>;
 }
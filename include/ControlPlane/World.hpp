@@ -24,11 +24,15 @@
 #include <tuple>
 #include <valarray>
 #include <algorithm>
+#include <cmath>
+#include <type_traits>
 #include <functional>
 #include <limits>
 #include <initializer_list>
 #include <memory.h>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <atomic>
 #include <set>
 #include <mutex>
@@ -40,6 +44,8 @@
 #include <stdarg.h>
 #include <string.h>
 #include <queue>
+#include <deque>
+#include <condition_variable>
 
 #ifndef _WIN32
 #include <sys/socket.h>
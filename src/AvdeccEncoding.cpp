@@ -7,4 +7,42 @@ namespace ControlPlane
 
 float powers_of_ten[25] = {1e-12f, 1e-11f, 1e-10f, 1e-9f, 1e-8f, 1e-7f, 1e-6f, 1e-5f, 1e-4f, 1e-3f, 1e-2f, 1e-1f, 1e0f,
                            1e1f,   1e2f,   1e3f,   1e4f,  1e5f,  1e6f,  1e7f,  1e8f,  1e9f,  1e10f, 1e11f, 1e12f};
+
+bool isEncodingTypeString( EncodingType t )
+{
+    return t == EncodingType::ENCODING_STRING64 || t == EncodingType::ENCODING_STRING406;
+}
+
+size_t getEncodingTypeSize( EncodingType t )
+{
+    size_t r = 0;
+    switch ( t )
+    {
+    case EncodingType::ENCODING_INT8:
+    case EncodingType::ENCODING_UINT8:
+        r = 1;
+        break;
+    case EncodingType::ENCODING_INT16:
+    case EncodingType::ENCODING_UINT16:
+        r = 2;
+        break;
+    case EncodingType::ENCODING_INT32:
+    case EncodingType::ENCODING_UINT32:
+    case EncodingType::ENCODING_FLOAT:
+        r = 4;
+        break;
+    case EncodingType::ENCODING_INT64:
+    case EncodingType::ENCODING_UINT64:
+    case EncodingType::ENCODING_DOUBLE:
+        r = 8;
+        break;
+    case EncodingType::ENCODING_STRING64:
+        r = 64;
+        break;
+    case EncodingType::ENCODING_STRING406:
+        r = 406;
+        break;
+    }
+    return r;
+}
 }
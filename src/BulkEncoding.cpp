@@ -0,0 +1,286 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/BulkEncoding.hpp"
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define CONTROLPLANE_BULK_SSE2 1
+#endif
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define CONTROLPLANE_BULK_AVX2 1
+#endif
+
+namespace ControlPlane
+{
+
+namespace
+{
+
+///
+/// \brief The EncodeRange struct
+///
+/// The clamping range of an encoding as floats. A bound which is not exact in
+/// a float is moved towards zero, so that a clamped value always converts
+/// to an int32_t.
+///
+struct EncodeRange
+{
+    float m_min;
+    float m_max;
+
+    EncodeRange( int32_t min_encoded, int32_t max_encoded ) : m_min( float( min_encoded ) ), m_max( float( max_encoded ) )
+    {
+        if ( double( m_min ) < double( min_encoded ) )
+        {
+            m_min = std::nextafter( m_min, 0.0f );
+        }
+        if ( double( m_max ) > double( max_encoded ) )
+        {
+            m_max = std::nextafter( m_max, 0.0f );
+        }
+    }
+};
+
+inline void storeBigEndian( uint8_t *p, uint32_t v )
+{
+    p[0] = uint8_t( v >> 24 );
+    p[1] = uint8_t( v >> 16 );
+    p[2] = uint8_t( v >> 8 );
+    p[3] = uint8_t( v );
+}
+
+inline uint32_t loadBigEndian( uint8_t const *p )
+{
+    return ( uint32_t( p[0] ) << 24 ) | ( uint32_t( p[1] ) << 16 ) | ( uint32_t( p[2] ) << 8 ) | uint32_t( p[3] );
+}
+
+void encodeScalar( uint8_t *dest, float const *values, size_t count, float multiplier, float divider, EncodeRange range )
+{
+    for ( size_t i = 0; i < count; ++i )
+    {
+        float v = values[i] * multiplier / divider;
+        // written so that a NaN becomes the minimum, as the SIMD max does
+        v = v > range.m_min ? v : range.m_min;
+        v = v < range.m_max ? v : range.m_max;
+
+        // truncate, then step away from zero where the fraction is at least a half, as roundf() does
+        int32_t t = int32_t( v );
+        float fraction = v - float( t );
+        t += ( fraction >= 0.5f ? 1 : 0 ) - ( fraction <= -0.5f ? 1 : 0 );
+        storeBigEndian( dest + i * 4, uint32_t( t ) );
+    }
+}
+
+void decodeScalar( float *values, uint8_t const *src, size_t count, float multiplier, float divider )
+{
+    for ( size_t i = 0; i < count; ++i )
+    {
+        values[i] = float( int32_t( loadBigEndian( src + i * 4 ) ) ) * multiplier / divider;
+    }
+}
+
+#if defined( CONTROLPLANE_BULK_SSE2 )
+
+///
+/// \brief byteSwapSSE2
+///
+/// Swap the octets of each 16 bit half of every int32, then swap the halves
+///
+inline __m128i byteSwapSSE2( __m128i x )
+{
+    x = _mm_or_si128( _mm_slli_epi16( x, 8 ), _mm_srli_epi16( x, 8 ) );
+    x = _mm_shufflelo_epi16( x, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+    return _mm_shufflehi_epi16( x, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+}
+
+void encodeSSE2( uint8_t *dest, float const *values, size_t count, float multiplier, float divider, EncodeRange range )
+{
+    const __m128 m = _mm_set1_ps( multiplier );
+    const __m128 d = _mm_set1_ps( divider );
+    const __m128 lo = _mm_set1_ps( range.m_min );
+    const __m128 hi = _mm_set1_ps( range.m_max );
+    const __m128 half = _mm_set1_ps( 0.5f );
+    const __m128 minus_half = _mm_set1_ps( -0.5f );
+
+    size_t i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        __m128 v = _mm_div_ps( _mm_mul_ps( _mm_loadu_ps( values + i ), m ), d );
+        v = _mm_min_ps( _mm_max_ps( v, lo ), hi );
+
+        __m128i t = _mm_cvttps_epi32( v );
+        __m128 fraction = _mm_sub_ps( v, _mm_cvtepi32_ps( t ) );
+        __m128i up = _mm_castps_si128( _mm_cmpge_ps( fraction, half ) );
+        __m128i down = _mm_castps_si128( _mm_cmple_ps( fraction, minus_half ) );
+        t = _mm_add_epi32( _mm_sub_epi32( t, up ), down );
+
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( dest + i * 4 ), byteSwapSSE2( t ) );
+    }
+    encodeScalar( dest + i * 4, values + i, count - i, multiplier, divider, range );
+}
+
+void decodeSSE2( float *values, uint8_t const *src, size_t count, float multiplier, float divider )
+{
+    const __m128 m = _mm_set1_ps( multiplier );
+    const __m128 d = _mm_set1_ps( divider );
+
+    size_t i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        __m128i t = byteSwapSSE2( _mm_loadu_si128( reinterpret_cast<__m128i const *>( src + i * 4 ) ) );
+        _mm_storeu_ps( values + i, _mm_div_ps( _mm_mul_ps( _mm_cvtepi32_ps( t ), m ), d ) );
+    }
+    decodeScalar( values + i, src + i * 4, count - i, multiplier, divider );
+}
+#endif
+
+#if defined( CONTROLPLANE_BULK_AVX2 )
+
+__attribute__( ( target( "avx2" ) ) ) inline __m256i byteSwapAVX2( __m256i x )
+{
+    const __m256i order = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+    return _mm256_shuffle_epi8( x, order );
+}
+
+__attribute__( ( target( "avx2" ) ) ) void
+    encodeAVX2( uint8_t *dest, float const *values, size_t count, float multiplier, float divider, EncodeRange range )
+{
+    const __m256 m = _mm256_set1_ps( multiplier );
+    const __m256 d = _mm256_set1_ps( divider );
+    const __m256 lo = _mm256_set1_ps( range.m_min );
+    const __m256 hi = _mm256_set1_ps( range.m_max );
+    const __m256 half = _mm256_set1_ps( 0.5f );
+    const __m256 minus_half = _mm256_set1_ps( -0.5f );
+
+    size_t i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        __m256 v = _mm256_div_ps( _mm256_mul_ps( _mm256_loadu_ps( values + i ), m ), d );
+        v = _mm256_min_ps( _mm256_max_ps( v, lo ), hi );
+
+        __m256i t = _mm256_cvttps_epi32( v );
+        __m256 fraction = _mm256_sub_ps( v, _mm256_cvtepi32_ps( t ) );
+        __m256i up = _mm256_castps_si256( _mm256_cmp_ps( fraction, half, _CMP_GE_OQ ) );
+        __m256i down = _mm256_castps_si256( _mm256_cmp_ps( fraction, minus_half, _CMP_LE_OQ ) );
+        t = _mm256_add_epi32( _mm256_sub_epi32( t, up ), down );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dest + i * 4 ), byteSwapAVX2( t ) );
+    }
+    encodeScalar( dest + i * 4, values + i, count - i, multiplier, divider, range );
+}
+
+__attribute__( ( target( "avx2" ) ) ) void
+    decodeAVX2( float *values, uint8_t const *src, size_t count, float multiplier, float divider )
+{
+    const __m256 m = _mm256_set1_ps( multiplier );
+    const __m256 d = _mm256_set1_ps( divider );
+
+    size_t i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        __m256i t = byteSwapAVX2( _mm256_loadu_si256( reinterpret_cast<__m256i const *>( src + i * 4 ) ) );
+        _mm256_storeu_ps( values + i, _mm256_div_ps( _mm256_mul_ps( _mm256_cvtepi32_ps( t ), m ), d ) );
+    }
+    decodeScalar( values + i, src + i * 4, count - i, multiplier, divider );
+}
+#endif
+
+BulkEncodingKernel getBestKernel()
+{
+    BulkEncodingKernel r = BulkEncodingKernel::Scalar;
+#if defined( CONTROLPLANE_BULK_SSE2 )
+    r = BulkEncodingKernel::SSE2;
+#endif
+#if defined( CONTROLPLANE_BULK_AVX2 )
+    if ( __builtin_cpu_supports( "avx2" ) )
+    {
+        r = BulkEncodingKernel::AVX2;
+    }
+#endif
+    return r;
+}
+
+bool isKernelAvailable( BulkEncodingKernel kernel )
+{
+    bool r = kernel == BulkEncodingKernel::Scalar;
+#if defined( CONTROLPLANE_BULK_SSE2 )
+    r = r || kernel == BulkEncodingKernel::SSE2;
+#endif
+#if defined( CONTROLPLANE_BULK_AVX2 )
+    r = r || ( kernel == BulkEncodingKernel::AVX2 && __builtin_cpu_supports( "avx2" ) );
+#endif
+    return r;
+}
+
+std::atomic<BulkEncodingKernel> &currentKernel()
+{
+    static std::atomic<BulkEncodingKernel> kernel( getBestKernel() );
+    return kernel;
+}
+}
+
+BulkEncodingKernel getBulkEncodingKernel() { return currentKernel().load( std::memory_order_relaxed ); }
+
+BulkEncodingKernel setBulkEncodingKernel( BulkEncodingKernel kernel )
+{
+    BulkEncodingKernel best = getBestKernel();
+    BulkEncodingKernel r = kernel <= best ? kernel : best;
+
+    // an i386 build without SSE2 may have the AVX2 kernel but not the SSE2 one
+    while ( !isKernelAvailable( r ) )
+    {
+        r = BulkEncodingKernel( int( r ) - 1 );
+    }
+    currentKernel().store( r, std::memory_order_relaxed );
+    return r;
+}
+
+void encodeInt32BigEndian( uint8_t *dest,
+                           float const *values,
+                           size_t count,
+                           float multiplier,
+                           float divider,
+                           int32_t min_encoded,
+                           int32_t max_encoded )
+{
+    EncodeRange range( min_encoded, max_encoded );
+    switch ( getBulkEncodingKernel() )
+    {
+#if defined( CONTROLPLANE_BULK_AVX2 )
+    case BulkEncodingKernel::AVX2:
+        encodeAVX2( dest, values, count, multiplier, divider, range );
+        break;
+#endif
+#if defined( CONTROLPLANE_BULK_SSE2 )
+    case BulkEncodingKernel::SSE2:
+        encodeSSE2( dest, values, count, multiplier, divider, range );
+        break;
+#endif
+    default:
+        encodeScalar( dest, values, count, multiplier, divider, range );
+        break;
+    }
+}
+
+void decodeInt32BigEndian( float *values, uint8_t const *src, size_t count, float multiplier, float divider )
+{
+    switch ( getBulkEncodingKernel() )
+    {
+#if defined( CONTROLPLANE_BULK_AVX2 )
+    case BulkEncodingKernel::AVX2:
+        decodeAVX2( values, src, count, multiplier, divider );
+        break;
+#endif
+#if defined( CONTROLPLANE_BULK_SSE2 )
+    case BulkEncodingKernel::SSE2:
+        decodeSSE2( values, src, count, multiplier, divider );
+        break;
+#endif
+    default:
+        decodeScalar( values, src, count, multiplier, divider );
+        break;
+    }
+}
+}
@@ -0,0 +1,110 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ChangeDeliveryPool.hpp"
+
+namespace ControlPlane
+{
+
+void ChangeDeliveryQueue::deliver()
+{
+    std::lock_guard<std::recursive_mutex> lock( m_delivery_mutex );
+
+    ChangeDeliveryBatch batch;
+    while ( !m_closed && m_ring.pop( batch ) )
+    {
+        try
+        {
+            if ( batch.m_stats )
+            {
+                auto start = std::chrono::steady_clock::now();
+                batch.m_callback( batch.m_time_in_milliseconds, batch.m_comparator, batch.m_changed_items );
+                batch.m_stats->callbackDelivered( batch.m_first_change_clock, start, std::chrono::steady_clock::now() );
+            }
+            else
+            {
+                batch.m_callback( batch.m_time_in_milliseconds, batch.m_comparator, batch.m_changed_items );
+            }
+        }
+        catch ( ... )
+        {
+            // one failing subscriber must not stop the worker delivering to the others
+            m_callback_failures.fetch_add( 1, std::memory_order_relaxed );
+        }
+    }
+
+    // release the last batch's callback and comparator now rather than when the next one is popped
+    batch = ChangeDeliveryBatch();
+}
+
+void ChangeDeliveryQueue::close()
+{
+    m_closed = true;
+    std::lock_guard<std::recursive_mutex> lock( m_delivery_mutex );
+}
+
+ChangeDeliveryPool::ChangeDeliveryPool( size_t num_threads ) : m_stopping( false )
+{
+    for ( size_t i = 0; i < std::max( num_threads, size_t( 1 ) ); ++i )
+    {
+        m_threads.emplace_back( [this]()
+                                {
+                                    run();
+                                } );
+    }
+}
+
+ChangeDeliveryPool::~ChangeDeliveryPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_ready_mutex );
+        m_stopping = true;
+    }
+    m_ready_condition.notify_all();
+    for ( auto &t : m_threads )
+    {
+        t.join();
+    }
+}
+
+void ChangeDeliveryPool::schedule( const ChangeDeliveryQueuePtr &queue )
+{
+    if ( !queue->m_scheduled.exchange( true ) )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_ready_mutex );
+            m_ready.push_back( queue );
+        }
+        m_ready_condition.notify_one();
+    }
+}
+
+void ChangeDeliveryPool::run()
+{
+    for ( ;; )
+    {
+        ChangeDeliveryQueuePtr queue;
+        {
+            std::unique_lock<std::mutex> lock( m_ready_mutex );
+            m_ready_condition.wait( lock,
+                                    [this]()
+                                    {
+                                        return m_stopping || !m_ready.empty();
+                                    } );
+            if ( m_ready.empty() )
+            {
+                break;
+            }
+            queue = m_ready.front();
+            m_ready.pop_front();
+        }
+
+        queue->deliver();
+
+        // a batch pushed after the last pop but before this saw m_scheduled still set, so look again
+        queue->m_scheduled = false;
+        if ( !queue->empty() && !queue->m_closed )
+        {
+            schedule( queue );
+        }
+    }
+}
+}
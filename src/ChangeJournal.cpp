@@ -0,0 +1,71 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ChangeJournal.hpp"
+
+namespace ControlPlane
+{
+
+uint64_t ChangeJournal::record( ControlIdentityKey key )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    recordLocked( key );
+    return m_sequence;
+}
+
+uint64_t ChangeJournal::record( const ControlIdentitySet &items )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    for ( auto const &key : items )
+    {
+        recordLocked( key );
+    }
+    return m_sequence;
+}
+
+void ChangeJournal::recordLocked( ControlIdentityKey key )
+{
+    Entry &e = m_entries[m_sequence % m_entries.size()];
+    e.m_sequence = ++m_sequence;
+    e.m_key = key;
+}
+
+bool ChangeJournal::readSince( uint64_t sequence, std::vector<Entry> &entries, uint64_t &last_sequence, bool coalesce ) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    bool r = sequence <= m_sequence && m_sequence - sequence <= m_entries.size();
+    entries.clear();
+    last_sequence = m_sequence;
+
+    if ( r )
+    {
+        if ( coalesce )
+        {
+            // walk back from the newest change, keeping the first seen of each control
+            std::unordered_set<ControlIdentityKey> seen;
+            for ( uint64_t s = m_sequence; s > sequence; --s )
+            {
+                Entry const &e = m_entries[( s - 1 ) % m_entries.size()];
+                if ( seen.insert( e.m_key ).second )
+                {
+                    entries.push_back( e );
+                }
+            }
+            std::reverse( entries.begin(), entries.end() );
+        }
+        else
+        {
+            for ( uint64_t s = sequence + 1; s <= m_sequence; ++s )
+            {
+                entries.push_back( m_entries[( s - 1 ) % m_entries.size()] );
+            }
+        }
+    }
+    return r;
+}
+
+uint64_t ChangeJournal::getSequence() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_sequence;
+}
+}
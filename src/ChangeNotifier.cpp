@@ -9,9 +9,109 @@ ChangeNotifier::ChangeNotifier( Milliseconds min_scan_period_in_milliseconds )
     : m_identity( global_identity_count++ )
     , m_min_scan_period_in_milliseconds( min_scan_period_in_milliseconds )
     , m_last_scan_time_in_milliseconds( 0 )
+    , m_schedule_count( 0 )
+    , m_value_index( nullptr )
 {
 }
 
+namespace
+{
+
+template <typename T>
+void removeFromList( std::vector<T *> &list, T *item )
+{
+    list.erase( std::remove( list.begin(), list.end(), item ), list.end() );
+}
+}
+
+ChangeNotifier::~ChangeNotifier()
+{
+    ChangeDeliveryQueuePtr old_queue;
+    {
+        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+        old_queue.swap( m_delivery_queue );
+    }
+
+    // close() waits for a callback in progress, which may itself need the access mutex
+    if ( old_queue )
+    {
+        old_queue->close();
+    }
+}
+
+void ChangeNotifier::setDeliveryPool( ChangeDeliveryPoolPtr pool, size_t queue_capacity )
+{
+    ChangeDeliveryQueuePtr old_queue;
+    {
+        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+        old_queue.swap( m_delivery_queue );
+
+        m_delivery_pool = pool;
+        if ( m_delivery_pool )
+        {
+            m_delivery_queue = std::make_shared<ChangeDeliveryQueue>( queue_capacity );
+        }
+    }
+
+    // close() waits for a callback in progress, which may itself need the access mutex
+    if ( old_queue )
+    {
+        old_queue->close();
+    }
+}
+
+uint64_t ChangeNotifier::getCallbackFailures() const
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    return m_delivery_queue ? m_delivery_queue->getCallbackFailures() : 0;
+}
+
+void ChangeNotifier::setStatsEnabled( bool enabled )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+
+    if ( !enabled )
+    {
+        m_stats.reset();
+    }
+    else if ( !m_stats )
+    {
+        m_stats = std::make_shared<ChangeNotifierStats>();
+    }
+}
+
+bool ChangeNotifier::isStatsEnabled() const
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    return m_stats != nullptr;
+}
+
+ChangeNotifierStats::Snapshot ChangeNotifier::getStats() const
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    return m_stats ? m_stats->getSnapshot() : ChangeNotifierStats::Snapshot();
+}
+
+void ChangeNotifier::resetStats()
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_stats )
+    {
+        m_stats->reset();
+    }
+}
+
+void ChangeNotifier::setValueIndex( const ControlIdentityIndex *value_index )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+
+    m_value_index = value_index;
+    for ( auto &sub : m_subscriptions )
+    {
+        sub.second.m_changed_items.setIndex( value_index );
+    }
+}
+
 void ChangeNotifier::removeSubscription( ControlIdentityComparatorPtr sub )
 {
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
@@ -19,6 +119,7 @@ void ChangeNotifier::removeSubscription( ControlIdentityComparatorPtr sub )
     auto i = m_subscriptions.find( sub );
     if ( i != m_subscriptions.end() )
     {
+        unindexSubscription( *i );
         m_subscriptions.erase( i );
     }
 }
@@ -31,22 +132,237 @@ void ChangeNotifier::addSubscription( ControlIdentityComparatorPtr sub,
 {
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
 
-    m_subscriptions[sub] = ChangeNotificationState{max_update_period_in_milliseconds,
-                                                   min_update_period_in_milliseconds,
-                                                   current_time_in_milliseconds,
-                                                   Milliseconds( 0 ),
-                                                   callback};
+    auto i = m_subscriptions.find( sub );
+    if ( i != m_subscriptions.end() )
+    {
+        unindexSubscription( *i );
+    }
+    else
+    {
+        i = m_subscriptions.insert( std::make_pair( sub, ChangeNotificationState() ) ).first;
+    }
+
+    ChangeNotificationState &state = i->second;
+    state = ChangeNotificationState{max_update_period_in_milliseconds,
+                                    min_update_period_in_milliseconds,
+                                    current_time_in_milliseconds,
+                                    Milliseconds( 0 ),
+                                    callback};
+    state.m_changed_items.setIndex( m_value_index );
+    indexSubscription( *i );
+    schedule( i->first, state );
 }
 
 void ChangeNotifier::controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity control_identity )
 {
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
-    for ( auto &sub : m_subscriptions )
+    if ( m_stats )
+    {
+        m_change_clock = std::chrono::steady_clock::now();
+    }
+    recordChange( current_timestamp_in_milliseconds, ControlIdentityKey( control_identity ), control_identity );
+}
+
+void ChangeNotifier::controlsChanged( Milliseconds current_timestamp_in_milliseconds, const ControlIdentitySet &items )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_stats )
+    {
+        m_change_clock = std::chrono::steady_clock::now();
+    }
+    for ( auto const &item : items )
+    {
+        recordChange( current_timestamp_in_milliseconds, item, item.toIdentity() );
+    }
+}
+
+void ChangeNotifier::indexSubscription( Subscription &sub )
+{
+    ChangeNotificationState &state = sub.second;
+
+    state.m_index_keys.clear();
+    state.m_index_type = sub.first->getIndexKeys( state.m_index_keys );
+
+    switch ( state.m_index_type )
+    {
+    case ControlIdentityComparator::IndexType::None:
+        break;
+    case ControlIdentityComparator::IndexType::All:
+        m_all_subscriptions.push_back( &sub );
+        break;
+    case ControlIdentityComparator::IndexType::Identities:
+        for ( auto const &key : state.m_index_keys )
+        {
+            m_identity_index[key].push_back( &sub );
+        }
+        break;
+    case ControlIdentityComparator::IndexType::Descriptors:
+        for ( auto const &key : state.m_index_keys )
+        {
+            m_descriptor_index[key.getDescriptorKey()].push_back( &sub );
+        }
+        break;
+    case ControlIdentityComparator::IndexType::Scan:
+    default:
+        state.m_index_type = ControlIdentityComparator::IndexType::Scan;
+        m_scan_subscriptions.push_back( &sub );
+        break;
+    }
+}
+
+void ChangeNotifier::unindexSubscription( Subscription &sub )
+{
+    ChangeNotificationState &state = sub.second;
+
+    switch ( state.m_index_type )
+    {
+    case ControlIdentityComparator::IndexType::None:
+        break;
+    case ControlIdentityComparator::IndexType::All:
+        removeFromList( m_all_subscriptions, &sub );
+        break;
+    case ControlIdentityComparator::IndexType::Identities:
+    case ControlIdentityComparator::IndexType::Descriptors:
+    {
+        bool by_descriptor = state.m_index_type == ControlIdentityComparator::IndexType::Descriptors;
+        SubscriptionIndex &index = by_descriptor ? m_descriptor_index : m_identity_index;
+        for ( auto const &key : state.m_index_keys )
+        {
+            auto i = index.find( by_descriptor ? key.getDescriptorKey() : key );
+            if ( i != index.end() )
+            {
+                removeFromList( i->second, &sub );
+                if ( i->second.empty() )
+                {
+                    index.erase( i );
+                }
+            }
+        }
+        break;
+    }
+    case ControlIdentityComparator::IndexType::Scan:
+        removeFromList( m_scan_subscriptions, &sub );
+        break;
+    }
+    state.m_index_type = ControlIdentityComparator::IndexType::None;
+    state.m_index_keys.clear();
+}
+
+void ChangeNotifier::recordChange( Milliseconds current_timestamp_in_milliseconds,
+                                   ControlIdentityKey key,
+                                   ControlIdentity const &control_identity )
+{
+    if ( m_stats )
+    {
+        m_stats->changeIngested();
+    }
+
+    for ( Subscription *sub : m_all_subscriptions )
+    {
+        recordChange( *sub, current_timestamp_in_milliseconds, key );
+    }
+
+    auto i = m_identity_index.find( key );
+    if ( i != m_identity_index.end() )
+    {
+        for ( Subscription *sub : i->second )
+        {
+            recordChange( *sub, current_timestamp_in_milliseconds, key );
+        }
+    }
+
+    if ( !m_descriptor_index.empty() || !m_scan_subscriptions.empty() )
+    {
+        auto d = m_descriptor_index.find( key.getDescriptorKey() );
+        if ( d != m_descriptor_index.end() )
+        {
+            for ( Subscription *sub : d->second )
+            {
+                if ( sub->first->containsControl( control_identity ) )
+                {
+                    recordChange( *sub, current_timestamp_in_milliseconds, key );
+                }
+            }
+        }
+
+        for ( Subscription *sub : m_scan_subscriptions )
+        {
+            if ( sub->first->containsControl( control_identity ) )
+            {
+                recordChange( *sub, current_timestamp_in_milliseconds, key );
+            }
+        }
+    }
+}
+
+void ChangeNotifier::recordChange( Subscription &sub, Milliseconds current_timestamp_in_milliseconds, ControlIdentityKey key )
+{
+    if ( m_stats )
+    {
+        m_stats->subscriptionMatched();
+        if ( sub.second.m_changed_items.empty() )
+        {
+            sub.second.m_first_change_clock = m_change_clock;
+        }
+    }
+    sub.second.m_last_change_time_in_milliseconds = current_timestamp_in_milliseconds;
+    sub.second.m_changed_items.insert( key );
+    schedule( sub.first, sub.second );
+}
+
+void ChangeNotifier::addMeterSubscription( MeterGroupPtr group,
+                                           Milliseconds period_in_milliseconds,
+                                           Milliseconds current_time_in_milliseconds,
+                                           MeterFrameCallback callback )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+
+    removeMeterSubscription( group );
+    m_meter_subscriptions.push_back(
+        MeterSubscription{group, period_in_milliseconds, current_time_in_milliseconds, callback} );
+}
+
+void ChangeNotifier::removeMeterSubscription( MeterGroupPtr group )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+
+    m_meter_subscriptions.erase( std::remove_if( m_meter_subscriptions.begin(),
+                                                 m_meter_subscriptions.end(),
+                                                 [&group]( MeterSubscription const &sub )
+                                                 {
+                                                     return sub.m_group == group;
+                                                 } ),
+                                 m_meter_subscriptions.end() );
+}
+
+void ChangeNotifier::tickMeters( Milliseconds current_timestamp_in_milliseconds )
+{
+    // index rather than iterate, as a callback may add or remove meter subscriptions
+    for ( size_t i = 0; i < m_meter_subscriptions.size(); ++i )
     {
-        if ( sub.first->containsControl( control_identity ) )
+        if ( m_meter_subscriptions[i].m_due_time_in_milliseconds <= current_timestamp_in_milliseconds )
         {
-            sub.second.m_last_change_time_in_milliseconds = current_timestamp_in_milliseconds;
-            sub.second.m_changed_items.insert( control_identity );
+            MeterSubscription &sub = m_meter_subscriptions[i];
+
+            // keep to the period, but do not try to catch up on frames missed by late ticks
+            sub.m_due_time_in_milliseconds += sub.m_period_in_milliseconds;
+            if ( sub.m_due_time_in_milliseconds <= current_timestamp_in_milliseconds )
+            {
+                sub.m_due_time_in_milliseconds = current_timestamp_in_milliseconds + sub.m_period_in_milliseconds;
+            }
+
+            MeterFramePtr frame = sub.m_group->sample( current_timestamp_in_milliseconds );
+            MeterFrameCallback callback = sub.m_callback;
+            if ( m_stats )
+            {
+                auto start = std::chrono::steady_clock::now();
+                callback( *frame );
+                m_stats->callbackDelivered( std::chrono::steady_clock::time_point(), start, std::chrono::steady_clock::now() );
+            }
+            else
+            {
+                callback( *frame );
+            }
         }
     }
 }
@@ -54,16 +370,44 @@ void ChangeNotifier::controlChanged( Milliseconds current_timestamp_in_milliseco
 void ChangeNotifier::tick( Milliseconds current_timestamp_in_milliseconds )
 {
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+
+    tickMeters( current_timestamp_in_milliseconds );
+
     // Do work only after m_min_scan_period_in_milliseconds since last time
     if ( current_timestamp_in_milliseconds > m_last_scan_time_in_milliseconds + m_min_scan_period_in_milliseconds )
     {
         // remember the current time as when we last did any work
         m_last_scan_time_in_milliseconds = current_timestamp_in_milliseconds;
-        for ( auto &sub : m_subscriptions )
+
+        // take every subscription which is due from the schedule, skipping entries which were superseded
+        std::vector<ControlIdentityComparatorPtr> due;
+        while ( !m_schedule.empty() && m_schedule.top().m_due_time_in_milliseconds <= current_timestamp_in_milliseconds )
         {
+            ScheduledNotification const &top = m_schedule.top();
+            auto i = m_subscriptions.find( top.m_subscription );
+            if ( i != m_subscriptions.end() && i->second.m_schedule_id == top.m_schedule_id )
+            {
+                i->second.m_schedule_id = 0;
+                due.push_back( i->first );
+            }
+            m_schedule.pop();
+        }
+
+        // call or queue the callbacks in subscription order
+        std::sort( due.begin(), due.end(), ControlIdentityComparator_compare() );
+        bool queued = false;
+
+        for ( auto const &comparator : due )
+        {
+            auto i = m_subscriptions.find( comparator );
+            if ( i == m_subscriptions.end() )
+            {
+                // removed by an earlier callback
+                continue;
+            }
+
             bool notify = false;
-            ControlIdentityComparatorPtr const &comparator = sub.first;
-            ChangeNotificationState &state = sub.second;
+            ChangeNotificationState &state = i->second;
 
             // notify the callback if no notification has happened since
             // range.m_last_change_acknowledged_time_in_milliseconds, But only if m_min_update_period_in_milliseconds
@@ -76,7 +420,7 @@ void ChangeNotifier::tick( Milliseconds current_timestamp_in_milliseconds )
 
                 // ask the comparator to fill in the changed_items set with all the
                 // relevant items
-                comparator->fillSet( state.m_changed_items );
+                comparator->fillBitmap( state.m_changed_items );
             }
             else
             {
@@ -101,11 +445,103 @@ void ChangeNotifier::tick( Milliseconds current_timestamp_in_milliseconds )
                 {
                     throw std::runtime_error( "No callback set for subscription" );
                 }
-                state.m_callback( current_timestamp_in_milliseconds, comparator, state.m_changed_items );
-                state.m_last_change_acknowledged_time_in_milliseconds = current_timestamp_in_milliseconds;
-                state.m_changed_items.clear();
+                if ( m_delivery_queue )
+                {
+                    ChangeDeliveryBatch batch{current_timestamp_in_milliseconds,
+                                              comparator,
+                                              state.m_callback,
+                                              std::move( state.m_changed_items ),
+                                              m_stats,
+                                              state.m_first_change_clock};
+                    if ( m_delivery_queue->push( std::move( batch ) ) )
+                    {
+                        state.m_changed_items = ControlIdentityBitmap( m_value_index );
+                        state.m_first_change_clock = std::chrono::steady_clock::time_point();
+                        state.m_last_change_acknowledged_time_in_milliseconds = current_timestamp_in_milliseconds;
+                        queued = true;
+                    }
+                    else
+                    {
+                        // the queue is full, so keep the changes pending and merging until there is room
+                        state.m_changed_items = std::move( batch.m_changed_items );
+                    }
+                }
+                else if ( m_stats )
+                {
+                    ChangeNotifierStatsPtr stats = m_stats;
+                    auto start = std::chrono::steady_clock::now();
+                    state.m_callback( current_timestamp_in_milliseconds, comparator, state.m_changed_items );
+                    stats->callbackDelivered( state.m_first_change_clock, start, std::chrono::steady_clock::now() );
+                    state.m_last_change_acknowledged_time_in_milliseconds = current_timestamp_in_milliseconds;
+                    state.m_changed_items.clear();
+                    state.m_first_change_clock = std::chrono::steady_clock::time_point();
+                }
+                else
+                {
+                    state.m_callback( current_timestamp_in_milliseconds, comparator, state.m_changed_items );
+                    state.m_last_change_acknowledged_time_in_milliseconds = current_timestamp_in_milliseconds;
+                    state.m_changed_items.clear();
+                }
+            }
+
+            schedule( comparator, state );
+        }
+
+        if ( queued )
+        {
+            if ( m_stats )
+            {
+                m_stats->queueDepth( m_delivery_queue->size() );
             }
+            m_delivery_pool->schedule( m_delivery_queue );
+        }
+    }
+}
+
+bool ChangeNotifier::getDueTime( const ChangeNotificationState &state, Milliseconds &due_time_in_milliseconds )
+{
+    bool r = false;
+
+    // a periodic refresh is due once the min update period has passed since the last notification
+    if ( state.m_min_update_period_in_milliseconds != Milliseconds( 0 ) )
+    {
+        due_time_in_milliseconds
+            = state.m_last_change_acknowledged_time_in_milliseconds + state.m_min_update_period_in_milliseconds;
+        r = true;
+    }
+
+    // pending changes are due once the max update period has passed since the last notification
+    if ( state.m_last_change_time_in_milliseconds > state.m_last_change_acknowledged_time_in_milliseconds
+         && state.m_max_update_period_in_milliseconds != Milliseconds( 0 ) )
+    {
+        Milliseconds changes_due_time
+            = state.m_last_change_acknowledged_time_in_milliseconds + state.m_max_update_period_in_milliseconds;
+        if ( !r || changes_due_time < due_time_in_milliseconds )
+        {
+            due_time_in_milliseconds = changes_due_time;
         }
+        r = true;
+    }
+
+    return r;
+}
+
+void ChangeNotifier::schedule( const ControlIdentityComparatorPtr &sub, ChangeNotificationState &state )
+{
+    Milliseconds due_time_in_milliseconds;
+    if ( getDueTime( state, due_time_in_milliseconds ) )
+    {
+        // the entry already in the schedule stays current unless the due time moved
+        if ( state.m_schedule_id == 0 || due_time_in_milliseconds != state.m_due_time_in_milliseconds )
+        {
+            state.m_schedule_id = ++m_schedule_count;
+            state.m_due_time_in_milliseconds = due_time_in_milliseconds;
+            m_schedule.push( ScheduledNotification{due_time_in_milliseconds, state.m_schedule_id, sub} );
+        }
+    }
+    else
+    {
+        state.m_schedule_id = 0;
     }
 }
 
@@ -9,6 +9,15 @@ uint64_t ChangeNotifierManager::addChangeNotifier( ChangeNotifierPtr item )
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
     uint64_t identity = item->getIdentity();
 
+    if ( m_value_index )
+    {
+        item->setValueIndex( m_value_index );
+    }
+    if ( m_stats_enabled )
+    {
+        item->setStatsEnabled( true );
+    }
+
     m_items[identity] = item;
 
     return identity;
@@ -27,15 +36,80 @@ void ChangeNotifierManager::removeChangeNotifier( uint64_t identity )
 void ChangeNotifierManager::controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity descriptor )
 {
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
-    for ( auto &i : m_items )
+    if ( m_hold_count > 0 )
+    {
+        m_held_changes.insert( descriptor );
+        m_held_time_in_milliseconds = std::max( m_held_time_in_milliseconds, current_timestamp_in_milliseconds );
+    }
+    else
+    {
+        m_journal.record( descriptor );
+        for ( auto &i : m_items )
+        {
+            i.second->controlChanged( current_timestamp_in_milliseconds, descriptor );
+        }
+    }
+}
+
+void ChangeNotifierManager::controlsChanged( Milliseconds current_timestamp_in_milliseconds, const ControlIdentitySet &items )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_hold_count > 0 )
+    {
+        for ( auto const &item : items )
+        {
+            m_held_changes.insert( item );
+        }
+        m_held_time_in_milliseconds = std::max( m_held_time_in_milliseconds, current_timestamp_in_milliseconds );
+    }
+    else
+    {
+        m_journal.record( items );
+        for ( auto &i : m_items )
+        {
+            i.second->controlsChanged( current_timestamp_in_milliseconds, items );
+        }
+    }
+}
+
+void ChangeNotifierManager::incHoldCount()
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    ++m_hold_count;
+}
+
+void ChangeNotifierManager::decHoldCount()
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( --m_hold_count == 0 && !m_held_changes.empty() )
     {
-        i.second->controlChanged( current_timestamp_in_milliseconds, descriptor );
+        ControlIdentitySet items( m_held_changes.begin(), m_held_changes.end() );
+        m_held_changes.clear();
+        controlsChanged( m_held_time_in_milliseconds, items );
+
+        // the next hold starts from the time of its own changes
+        m_held_time_in_milliseconds = Milliseconds( 0 );
     }
 }
 
 void ChangeNotifierManager::tick( Milliseconds current_timestamp_in_milliseconds )
 {
     std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+
+    // drain even while held so that the rings do not fill up
+    if ( !m_realtime_ingresses.empty() )
+    {
+        m_realtime_changes.clear();
+        for ( auto &ingress : m_realtime_ingresses )
+        {
+            ingress->drain( m_realtime_changes );
+        }
+        if ( !m_realtime_changes.empty() )
+        {
+            controlsChanged( current_timestamp_in_milliseconds, m_realtime_changes );
+        }
+    }
+
     if ( m_hold_count == 0 )
     {
         for ( auto &i : m_items )
@@ -44,4 +118,49 @@ void ChangeNotifierManager::tick( Milliseconds current_timestamp_in_milliseconds
         }
     }
 }
+
+void ChangeNotifierManager::setStatsEnabled( bool enabled )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    m_stats_enabled = enabled;
+    for ( auto &i : m_items )
+    {
+        i.second->setStatsEnabled( enabled );
+    }
+}
+
+ChangeNotifierStats::Snapshot ChangeNotifierManager::getStats() const
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    ChangeNotifierStats::Snapshot r = ChangeNotifierStats::Snapshot();
+    for ( auto const &i : m_items )
+    {
+        r += i.second->getStats();
+    }
+    return r;
+}
+
+void ChangeNotifierManager::resetStats()
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    for ( auto &i : m_items )
+    {
+        i.second->resetStats();
+    }
+}
+
+RealtimeChangeIngressPtr ChangeNotifierManager::addRealtimeIngress( size_t capacity )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    RealtimeChangeIngressPtr r = std::make_shared<RealtimeChangeIngress>( capacity );
+    m_realtime_ingresses.push_back( r );
+    return r;
+}
+
+void ChangeNotifierManager::removeRealtimeIngress( const RealtimeChangeIngressPtr &ingress )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    m_realtime_ingresses.erase( std::remove( m_realtime_ingresses.begin(), m_realtime_ingresses.end(), ingress ),
+                                m_realtime_ingresses.end() );
+}
 }
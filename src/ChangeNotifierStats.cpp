@@ -0,0 +1,152 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ChangeNotifierStats.hpp"
+
+namespace ControlPlane
+{
+
+uint64_t StatsHistogram::Snapshot::getPercentile( double p ) const
+{
+    uint64_t r = 0;
+    if ( m_count )
+    {
+        uint64_t target = uint64_t( p * double( m_count - 1 ) ) + 1;
+        uint64_t seen = 0;
+        for ( size_t i = 0; i < num_buckets; ++i )
+        {
+            seen += m_buckets[i];
+            if ( seen >= target )
+            {
+                // the last bucket has no upper bound, so give the largest sample instead
+                r = i == 0 ? 0 : i == num_buckets - 1 ? m_max : std::min( ( uint64_t( 1 ) << i ) - 1, m_max );
+                break;
+            }
+        }
+    }
+    return r;
+}
+
+StatsHistogram::Snapshot &StatsHistogram::Snapshot::operator+=( const StatsHistogram::Snapshot &other )
+{
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max( m_max, other.m_max );
+    for ( size_t i = 0; i < num_buckets; ++i )
+    {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    return *this;
+}
+
+size_t StatsHistogram::getBucket( uint64_t v )
+{
+    size_t r = 0;
+    while ( v && r < num_buckets - 1 )
+    {
+        v >>= 1;
+        ++r;
+    }
+    return r;
+}
+
+void StatsHistogram::record( uint64_t v )
+{
+    m_count.fetch_add( 1, std::memory_order_relaxed );
+    m_sum.fetch_add( v, std::memory_order_relaxed );
+    m_buckets[getBucket( v )].fetch_add( 1, std::memory_order_relaxed );
+
+    uint64_t max = m_max.load( std::memory_order_relaxed );
+    while ( v > max && !m_max.compare_exchange_weak( max, v, std::memory_order_relaxed ) )
+    {
+    }
+}
+
+StatsHistogram::Snapshot StatsHistogram::getSnapshot() const
+{
+    Snapshot r;
+    r.m_count = m_count.load( std::memory_order_relaxed );
+    r.m_sum = m_sum.load( std::memory_order_relaxed );
+    r.m_max = m_max.load( std::memory_order_relaxed );
+    for ( size_t i = 0; i < num_buckets; ++i )
+    {
+        r.m_buckets[i] = m_buckets[i].load( std::memory_order_relaxed );
+    }
+    return r;
+}
+
+void StatsHistogram::reset()
+{
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+    for ( auto &bucket : m_buckets )
+    {
+        bucket = 0;
+    }
+}
+
+std::ostream &operator<<( std::ostream &o, const StatsHistogram::Snapshot &v )
+{
+    std::ios::fmtflags flags = o.flags();
+    std::streamsize precision = o.precision();
+    o << "count=" << v.m_count << " mean=" << std::fixed << std::setprecision( 1 ) << v.getMean()
+      << " p50=" << v.getPercentile( 0.5 ) << " p99=" << v.getPercentile( 0.99 ) << " max=" << v.m_max;
+    o.flags( flags );
+    o.precision( precision );
+    return o;
+}
+
+ChangeNotifierStats::Snapshot &ChangeNotifierStats::Snapshot::operator+=( const ChangeNotifierStats::Snapshot &other )
+{
+    m_changes_ingested += other.m_changes_ingested;
+    m_subscriptions_matched += other.m_subscriptions_matched;
+    m_callbacks_delivered += other.m_callbacks_delivered;
+    m_callback_duration_in_microseconds += other.m_callback_duration_in_microseconds;
+    m_latency_in_microseconds += other.m_latency_in_microseconds;
+    m_queue_depth += other.m_queue_depth;
+    return *this;
+}
+
+void ChangeNotifierStats::callbackDelivered( std::chrono::steady_clock::time_point first_change,
+                                             std::chrono::steady_clock::time_point start,
+                                             std::chrono::steady_clock::time_point end )
+{
+    m_callbacks_delivered.fetch_add( 1, std::memory_order_relaxed );
+    m_callback_duration_in_microseconds.record(
+        uint64_t( std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count() ) );
+    if ( first_change != std::chrono::steady_clock::time_point() )
+    {
+        m_latency_in_microseconds.record(
+            uint64_t( std::chrono::duration_cast<std::chrono::microseconds>( start - first_change ).count() ) );
+    }
+}
+
+ChangeNotifierStats::Snapshot ChangeNotifierStats::getSnapshot() const
+{
+    Snapshot r;
+    r.m_changes_ingested = m_changes_ingested.load( std::memory_order_relaxed );
+    r.m_subscriptions_matched = m_subscriptions_matched.load( std::memory_order_relaxed );
+    r.m_callbacks_delivered = m_callbacks_delivered.load( std::memory_order_relaxed );
+    r.m_callback_duration_in_microseconds = m_callback_duration_in_microseconds.getSnapshot();
+    r.m_latency_in_microseconds = m_latency_in_microseconds.getSnapshot();
+    r.m_queue_depth = m_queue_depth.getSnapshot();
+    return r;
+}
+
+void ChangeNotifierStats::reset()
+{
+    m_changes_ingested = 0;
+    m_subscriptions_matched = 0;
+    m_callbacks_delivered = 0;
+    m_callback_duration_in_microseconds.reset();
+    m_latency_in_microseconds.reset();
+    m_queue_depth.reset();
+}
+
+std::ostream &operator<<( std::ostream &o, const ChangeNotifierStats::Snapshot &v )
+{
+    o << "changes=" << v.m_changes_ingested << " matched=" << v.m_subscriptions_matched
+      << " delivered=" << v.m_callbacks_delivered << " callback_us={ " << v.m_callback_duration_in_microseconds
+      << " } latency_us={ " << v.m_latency_in_microseconds << " } queue_depth={ " << v.m_queue_depth << " }";
+    return o;
+}
+}
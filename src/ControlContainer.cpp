@@ -37,22 +37,13 @@ DescriptorPtr ControlContainer::addItem( const SchemaAddressElement &subnode, De
 
 DescriptorPtr ControlContainer::addItem( const SchemaAddress &address, DescriptorPtr item, ControlIdentity identity )
 {
-    if ( address.size() == 1 )
+    // walk down iteratively, creating any missing containers, so that no tail of the address is copied
+    ControlContainer *container = this;
+    for ( size_t i = 0; i + 1 < address.size(); ++i )
     {
-        addItem( address[0], item, identity );
-    }
-    else
-    {
-        SchemaAddress tmp;
-        std::copy( address.begin() + 1, address.end(), std::back_inserter( tmp ) );
-
-        if ( m_container_items.find( address[0] ) == m_container_items.end() )
-        {
-            addItem( address[0] );
-        }
-
-        m_container_items.at( address[0] ).get()->addItem( tmp, item, identity );
+        container = container->addItem( address[i] ).get();
     }
+    container->addItem( address.back(), item, identity );
     return item;
 }
 
@@ -0,0 +1,223 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ControlIdentityBitmap.hpp"
+
+namespace ControlPlane
+{
+
+namespace
+{
+
+///
+/// \brief lowestBit
+///
+/// \return the position of the lowest set bit of a non zero word
+///
+inline unsigned lowestBit( uint64_t word )
+{
+#if defined( _MSC_VER )
+    unsigned long r;
+    _BitScanForward64( &r, word );
+    return unsigned( r );
+#else
+    return unsigned( __builtin_ctzll( word ) );
+#endif
+}
+}
+
+ControlIdentityBitmap::const_iterator::const_iterator( ControlIdentityBitmap const *bitmap )
+    : m_bitmap( bitmap )
+    , m_word( bitmap->m_first_dirty_word )
+    , m_bits( bitmap->m_first_dirty_word < bitmap->m_last_dirty_word ? bitmap->m_words[bitmap->m_first_dirty_word] : 0 )
+    , m_other( bitmap->m_others.begin() )
+    , m_current( nullptr )
+{
+    advance();
+}
+
+void ControlIdentityBitmap::const_iterator::advance()
+{
+    while ( m_bits == 0 && m_word + 1 < m_bitmap->m_last_dirty_word )
+    {
+        m_bits = m_bitmap->m_words[++m_word];
+    }
+
+    if ( m_bits != 0 )
+    {
+        size_t ordinal = m_bitmap->m_first_ordinal + m_word * 64 + lowestBit( m_bits );
+        m_bits &= m_bits - 1;
+        m_current = &m_bitmap->m_index->getEntries()[ordinal].m_key;
+    }
+    else
+    {
+        // the bitmap is done, continue with the identities which are not in the index
+        m_word = m_bitmap->m_last_dirty_word;
+        if ( m_other != m_bitmap->m_others.end() )
+        {
+            m_current = &*m_other;
+            ++m_other;
+        }
+        else
+        {
+            m_current = nullptr;
+        }
+    }
+}
+
+ControlIdentityBitmap::ControlIdentityBitmap( ControlIdentityIndex const *index )
+    : m_index( index ), m_first_ordinal( 0 ), m_first_dirty_word( 0 ), m_last_dirty_word( 0 ), m_count( 0 )
+{
+}
+
+void ControlIdentityBitmap::setIndex( ControlIdentityIndex const *index )
+{
+    if ( index != m_index )
+    {
+        std::vector<ControlIdentityKey> keys( begin(), end() );
+
+        m_words.clear();
+        m_first_ordinal = 0;
+        m_first_dirty_word = 0;
+        m_last_dirty_word = 0;
+        m_count = 0;
+        m_others.clear();
+        m_index = index;
+
+        for ( auto const &key : keys )
+        {
+            insert( key );
+        }
+    }
+}
+
+void ControlIdentityBitmap::insert( ControlIdentityKey key )
+{
+    ControlIdentityIndex::Entry const *entry = m_index ? m_index->find( key ) : nullptr;
+    if ( entry )
+    {
+        setBit( size_t( entry - m_index->getEntries().data() ) );
+    }
+    else
+    {
+        m_others.insert( key );
+    }
+}
+
+void ControlIdentityBitmap::insertAll()
+{
+    size_t num_entries = m_index ? m_index->size() : 0;
+    if ( num_entries > 0 )
+    {
+        size_t num_words = ( num_entries + 63 ) / 64;
+
+        // cover every ordinal from 0
+        if ( m_first_ordinal > 0 )
+        {
+            m_words.insert( m_words.begin(), m_first_ordinal / 64, 0 );
+            m_first_ordinal = 0;
+        }
+        m_words.resize( num_words );
+
+        std::fill( m_words.begin(), m_words.end(), ~uint64_t( 0 ) );
+        if ( num_entries % 64 != 0 )
+        {
+            m_words.back() = ( uint64_t( 1 ) << ( num_entries % 64 ) ) - 1;
+        }
+
+        m_first_dirty_word = 0;
+        m_last_dirty_word = num_words;
+        m_count = num_entries;
+    }
+}
+
+void ControlIdentityBitmap::insertEntries( ControlIdentityIndex::Entry const *first, ControlIdentityIndex::Entry const *last )
+{
+    ControlIdentityIndex::Entry const *entries = m_index->getEntries().data();
+    for ( ControlIdentityIndex::Entry const *i = first; i != last; ++i )
+    {
+        setBit( size_t( i - entries ) );
+    }
+}
+
+void ControlIdentityBitmap::clear()
+{
+    std::fill( m_words.begin() + m_first_dirty_word, m_words.begin() + m_last_dirty_word, 0 );
+    m_first_dirty_word = 0;
+    m_last_dirty_word = 0;
+    m_count = 0;
+    m_others.clear();
+}
+
+bool ControlIdentityBitmap::contains( ControlIdentityKey key ) const
+{
+    bool r = false;
+    ControlIdentityIndex::Entry const *entry = m_index ? m_index->find( key ) : nullptr;
+    if ( entry )
+    {
+        size_t ordinal = size_t( entry - m_index->getEntries().data() );
+        if ( ordinal >= m_first_ordinal )
+        {
+            size_t word = ( ordinal - m_first_ordinal ) / 64;
+            r = word < m_words.size() && ( m_words[word] & ( uint64_t( 1 ) << ( ordinal % 64 ) ) ) != 0;
+        }
+    }
+    else
+    {
+        r = m_others.find( key ) != m_others.end();
+    }
+    return r;
+}
+
+void ControlIdentityBitmap::setBit( size_t ordinal )
+{
+    size_t word_ordinal = ordinal - ordinal % 64;
+
+    // grow the words to cover the ordinal, which only allocates the first time it is covered
+    if ( m_words.empty() )
+    {
+        m_first_ordinal = word_ordinal;
+    }
+    else if ( word_ordinal < m_first_ordinal )
+    {
+        size_t num_new_words = ( m_first_ordinal - word_ordinal ) / 64;
+        m_words.insert( m_words.begin(), num_new_words, 0 );
+        m_first_ordinal = word_ordinal;
+        if ( m_count > 0 )
+        {
+            m_first_dirty_word += num_new_words;
+            m_last_dirty_word += num_new_words;
+        }
+    }
+
+    size_t word = ( ordinal - m_first_ordinal ) / 64;
+    if ( word >= m_words.size() )
+    {
+        m_words.resize( word + 1, 0 );
+    }
+
+    uint64_t bit = uint64_t( 1 ) << ( ordinal % 64 );
+    if ( ( m_words[word] & bit ) == 0 )
+    {
+        m_words[word] |= bit;
+        if ( m_count == 0 )
+        {
+            m_first_dirty_word = word;
+            m_last_dirty_word = word + 1;
+        }
+        else
+        {
+            m_first_dirty_word = std::min( m_first_dirty_word, word );
+            m_last_dirty_word = std::max( m_last_dirty_word, word + 1 );
+        }
+        ++m_count;
+    }
+}
+
+std::ostream &operator<<( std::ostream &o, ControlIdentityBitmap const &v )
+{
+    for ( auto const &i : v )
+    {
+        o << " " << i << std::endl;
+    }
+    return o;
+}
+}
@@ -1,26 +1,54 @@
 #include "ControlPlane/World.hpp"
 #include "ControlPlane/ControlIdentityComparator.hpp"
+#include "ControlPlane/ControlIdentityBitmap.hpp"
 #include "ControlPlane/Schema.hpp"
 
 namespace ControlPlane
 {
 
+void ControlIdentityComparator::fillBitmap( ControlIdentityBitmap &items ) const
+{
+    ControlIdentitySet keys;
+    fillSet( keys );
+    for ( auto const &key : keys )
+    {
+        items.insert( key );
+    }
+}
+
+int ControlIdentityComparator::compareKind( const ControlIdentityComparator &other ) const
+{
+    int r = 0;
+    Kind kind = getKind();
+    Kind other_kind = other.getKind();
+
+    if ( kind != other_kind )
+    {
+        r = kind < other_kind ? -1 : 1;
+    }
+    else if ( kind == Kind::Other && typeid( *this ) != typeid( other ) )
+    {
+        r = typeid( *this ).before( typeid( other ) ) ? -1 : 1;
+    }
+    return r;
+}
+
 ControlIdentityComparatorUnique::ControlIdentityComparatorUnique( const ControlIdentity &identity ) : m_identity( identity ) {}
 
 ControlIdentityComparatorUnique::~ControlIdentityComparatorUnique() {}
 
 bool ControlIdentityComparatorUnique::containsControl( const ControlIdentity &identity ) const
 {
-    return identity == m_identity;
+    return ControlIdentityKey( identity ) == m_identity;
 }
 
-void ControlIdentityComparatorUnique::fillSet( std::set<ControlIdentity> &items ) const { items.insert( m_identity ); }
+void ControlIdentityComparatorUnique::fillSet( ControlIdentitySet &items ) const { items.insert( m_identity ); }
 
 int ControlIdentityComparatorUnique::compare( const ControlIdentityComparator &other ) const
 {
-    int r = 0;
+    int r = compareKind( other );
 
-    if ( typeid( *this ) == typeid( other ) )
+    if ( r == 0 )
     {
         ControlIdentityComparatorUnique const &other_identity = static_cast<ControlIdentityComparatorUnique const &>( other );
 
@@ -37,14 +65,6 @@ int ControlIdentityComparatorUnique::compare( const ControlIdentityComparator &o
             r = 1;
         }
     }
-    else if ( typeid( *this ).before( typeid( other ) ) )
-    {
-        r = -1;
-    }
-    else
-    {
-        r = 1;
-    }
     return r;
 }
 
@@ -53,66 +73,65 @@ void ControlIdentityComparatorUnique::print( std::ostream &o ) const
     o << "ChangeNotificationComparatorIdentity:" << m_identity << std::endl;
 }
 
+ControlIdentityComparator::IndexType ControlIdentityComparatorUnique::getIndexKeys( ControlIdentitySet &keys ) const
+{
+    keys.insert( m_identity );
+    return IndexType::Identities;
+}
+
 ControlIdentityComparatorAll::ControlIdentityComparatorAll( Schema const &schema ) : m_schema( schema ) {}
 
 bool ControlIdentityComparatorAll::containsControl( const ControlIdentity & ) const { return true; }
 
-void ControlIdentityComparatorAll::fillSet( std::set<ControlIdentity> &items ) const
+void ControlIdentityComparatorAll::fillSet( ControlIdentitySet &items ) const
 {
-    std::map<SchemaAddress, ControlIdentity> const &address_map = m_schema.getAddressMap();
-
-    for ( auto const &i : address_map )
+    // the value index is already sorted by key, so every insert is at the end
+    for ( auto const &i : m_schema.getValueIndex().getEntries() )
     {
-        items.insert( i.second );
+        items.insert( items.end(), i.m_key );
     }
 }
 
-int ControlIdentityComparatorAll::compare( const ControlIdentityComparator &other ) const
+void ControlIdentityComparatorAll::fillBitmap( ControlIdentityBitmap &items ) const
 {
-    int r = 0;
-
-    if ( typeid( *this ) == typeid( other ) )
+    // a bitmap over the schema's own value index is filled in one pass
+    if ( items.getIndex() == &m_schema.getValueIndex() )
     {
-        r = 0;
-    }
-    else if ( typeid( *this ).before( typeid( other ) ) )
-    {
-        r = -1;
+        items.insertAll();
     }
     else
     {
-        r = 1;
+        ControlIdentityComparator::fillBitmap( items );
     }
-    return r;
 }
 
+int ControlIdentityComparatorAll::compare( const ControlIdentityComparator &other ) const { return compareKind( other ); }
+
 void ControlIdentityComparatorAll::print( std::ostream &o ) const { o << "ChangeNotificationComparatorAll" << std::endl; }
 
+ControlIdentityComparator::IndexType ControlIdentityComparatorAll::getIndexKeys( ControlIdentitySet & ) const
+{
+    return IndexType::All;
+}
+
 ControlIdentityComparatorNone::ControlIdentityComparatorNone() {}
 
 bool ControlIdentityComparatorNone::containsControl( const ControlIdentity & ) const { return false; }
 
-void ControlIdentityComparatorNone::fillSet( std::set<ControlIdentity> &items ) const {}
+void ControlIdentityComparatorNone::fillSet( ControlIdentitySet &items ) const {}
 
-int ControlIdentityComparatorNone::compare( const ControlIdentityComparator &other ) const
-{
-    int r = 1;
-    if ( typeid( *this ) == typeid( other ) )
-    {
-        r = 0;
-    }
-    else if ( typeid( *this ).before( typeid( other ) ) )
-    {
-        r = -1;
-    }
-    return r;
-}
+int ControlIdentityComparatorNone::compare( const ControlIdentityComparator &other ) const { return compareKind( other ); }
 
 void ControlIdentityComparatorNone::print( std::ostream &o ) const { o << "ControlIdentityComparatorNone"; }
 
+ControlIdentityComparator::IndexType ControlIdentityComparatorNone::getIndexKeys( ControlIdentitySet & ) const
+{
+    return IndexType::None;
+}
+
 ControlIdentityComparatorSet &ControlIdentityComparatorSet::operator=( const ControlIdentityComparatorSet &other )
 {
-    std::set<ControlIdentity> tmp;
+    ControlIdentitySet tmp;
     other.fillSet( tmp );
     {
         std::lock_guard<std::recursive_mutex> guard( m_mutex );
@@ -129,11 +148,16 @@ size_t ControlIdentityComparatorSet::numItems() const
 
 void ControlIdentityComparatorSet::addItem( const ControlIdentity &item )
 {
+    ControlIdentityKey key( item );
+    if ( !key.isValid() )
+    {
+        throw std::range_error( Util::formstring( "ControlIdentityComparatorSet: identity can not be packed: ", item ) );
+    }
     std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
-    m_items.insert( item );
+    m_items.insert( key );
 }
 
-void ControlIdentityComparatorSet::addItems( const std::set<ControlIdentity> &items )
+void ControlIdentityComparatorSet::addItems( const ControlIdentitySet &items )
 {
     std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
     for ( auto const &item : items )
@@ -148,7 +172,7 @@ void ControlIdentityComparatorSet::removeItem( const ControlIdentity &item )
     m_items.erase( item );
 }
 
-void ControlIdentityComparatorSet::removeItems( const std::set<ControlIdentity> &items )
+void ControlIdentityComparatorSet::removeItems( const ControlIdentitySet &items )
 {
     std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
     for ( auto const &item : items )
@@ -168,20 +192,17 @@ bool ControlIdentityComparatorSet::containsControl( const ControlIdentity &ident
     return r;
 }
 
-void ControlIdentityComparatorSet::fillSet( std::set<ControlIdentity> &items ) const
+void ControlIdentityComparatorSet::fillSet( ControlIdentitySet &items ) const
 {
     std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
-    for ( auto const &item : m_items )
-    {
-        items.insert( item );
-    }
+    items.insert( m_items.begin(), m_items.end() );
 }
 
 int ControlIdentityComparatorSet::compare( const ControlIdentityComparator &other_ ) const
 {
-    int r = 1;
+    int r = compareKind( other_ );
 
-    if ( typeid( other_ ) == typeid( *this ) )
+    if ( r == 0 )
     {
         ControlIdentityComparatorSet const &other = static_cast<ControlIdentityComparatorSet const &>( other_ );
         size_t my_size = numItems();
@@ -189,6 +210,7 @@ int ControlIdentityComparatorSet::compare( const ControlIdentityComparator &othe
         if ( my_size == other_size )
         {
             std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
+            std::lock_guard<std::recursive_mutex> other_guard( other.m_mutex );
             if ( m_items == other.m_items )
             {
                 r = 0;
@@ -197,29 +219,297 @@ int ControlIdentityComparatorSet::compare( const ControlIdentityComparator &othe
             {
                 r = -1;
             }
+            else
+            {
+                r = 1;
+            }
         }
         else
         {
-            r = my_size - other_size;
+            r = my_size < other_size ? -1 : 1;
         }
     }
+    return r;
+}
+
+void ControlIdentityComparatorSet::print( std::ostream &o ) const
+{
+    std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
+    for ( auto const &item : m_items )
+    {
+        o << item;
+    }
+}
+
+ControlIdentityComparator::IndexType ControlIdentityComparatorSet::getIndexKeys( ControlIdentitySet &keys ) const
+{
+    fillSet( keys );
+    return IndexType::Identities;
+}
+
+ControlIdentityComparatorRange::ControlIdentityComparatorRange( Schema const &schema,
+                                                                DescriptorType descriptor_type,
+                                                                DescriptorIndex first_index,
+                                                                DescriptorIndex last_index,
+                                                                ControlIdentity::Section section,
+                                                                uint16_t first_item,
+                                                                uint16_t last_item )
+    : m_schema( schema )
+    , m_descriptor_type( descriptor_type )
+    , m_first_index( first_index )
+    , m_last_index( last_index )
+    , m_section( section )
+    , m_first_item( std::min( first_item, uint16_t( 0x1fff ) ) )
+    , m_last_item( first_item > 0x1fff ? uint16_t( 0 ) : std::min( last_item, uint16_t( 0x1fff ) ) )
+{
+    // both items are packed in keys by compare() and forEachEntry(), so they are clamped to the largest
+    // packable item, and a range starting past it is left empty rather than clamped to that one item
+    ControlIdentity first( descriptor_type, first_index, section );
+    if ( !ControlIdentityKey::isPackable( first ) )
+    {
+        throw std::range_error( Util::formstring( "ControlIdentityComparatorRange: identity can not be packed: ", first ) );
+    }
+}
+
+bool ControlIdentityComparatorRange::containsControl( const ControlIdentity &identity ) const
+{
+    return identity.m_descriptor_type == m_descriptor_type && identity.m_descriptor_index >= m_first_index
+           && identity.m_descriptor_index <= m_last_index && identity.m_section == m_section && identity.m_item >= m_first_item
+           && identity.m_item <= m_last_item;
+}
+
+template <typename F>
+void ControlIdentityComparatorRange::forEachEntry( F f ) const
+{
+    ControlIdentityIndex const &index = m_schema.getValueIndex();
+    ControlIdentityIndex::Entry const *end = index.getEntries().end();
+    uint64_t type_bits = ControlIdentityKey::packFields( m_descriptor_type, 0 ) >> 56;
+    uint32_t descriptor_index = m_first_index;
+
+    // the matching keys of each descriptor are one run, from its first item to the last position of its last item
+    while ( m_first_item <= m_last_item && descriptor_index <= m_last_index )
+    {
+        ControlIdentityKey first(
+            ControlIdentityKey::packFields( m_descriptor_type, DescriptorIndex( descriptor_index ), m_section, m_first_item ) );
+        ControlIdentityKey last( ControlIdentityKey::packFields(
+            m_descriptor_type, DescriptorIndex( descriptor_index ), m_section, m_last_item, 0xfff, 0xfff ) );
+
+        ControlIdentityIndex::Entry const *i = index.lowerBound( first );
+        ControlIdentityIndex::Entry const *j = i;
+        while ( j != end && j->m_key <= last )
+        {
+            ++j;
+        }
+        if ( i != j )
+        {
+            f( i, j );
+        }
+
+        // skip straight to the next descriptor which has any entries
+        if ( j == end || ( j->m_key.getValue() >> 56 ) != type_bits )
+        {
+            break;
+        }
+        uint32_t next_index = uint32_t( ( j->m_key.getValue() >> 40 ) & 0xffff );
+        descriptor_index = std::max( next_index, descriptor_index + 1 );
+    }
+}
+
+void ControlIdentityComparatorRange::fillSet( ControlIdentitySet &items ) const
+{
+    forEachEntry(
+        [&items]( ControlIdentityIndex::Entry const *first, ControlIdentityIndex::Entry const *last )
+        {
+            for ( ControlIdentityIndex::Entry const *i = first; i != last; ++i )
+            {
+                items.insert( items.end(), i->m_key );
+            }
+        } );
+}
+
+void ControlIdentityComparatorRange::fillBitmap( ControlIdentityBitmap &items ) const
+{
+    if ( items.getIndex() == &m_schema.getValueIndex() )
+    {
+        forEachEntry(
+            [&items]( ControlIdentityIndex::Entry const *first, ControlIdentityIndex::Entry const *last )
+            {
+                items.insertEntries( first, last );
+            } );
+    }
     else
     {
-        if ( typeid( *this ).before( typeid( other_ ) ) )
+        ControlIdentityComparator::fillBitmap( items );
+    }
+}
+
+int ControlIdentityComparatorRange::compare( const ControlIdentityComparator &other_ ) const
+{
+    int r = compareKind( other_ );
+
+    if ( r == 0 )
+    {
+        ControlIdentityComparatorRange const &other = static_cast<ControlIdentityComparatorRange const &>( other_ );
+
+        // the packed first and last identities hold every field of the range
+        uint64_t my_first = ControlIdentityKey::packFields( m_descriptor_type, m_first_index, m_section, m_first_item );
+        uint64_t other_first = ControlIdentityKey::packFields(
+            other.m_descriptor_type, other.m_first_index, other.m_section, other.m_first_item );
+        uint64_t my_last = ControlIdentityKey::packFields( m_descriptor_type, m_last_index, m_section, m_last_item );
+        uint64_t other_last
+            = ControlIdentityKey::packFields( other.m_descriptor_type, other.m_last_index, other.m_section, other.m_last_item );
+
+        if ( my_first != other_first )
         {
-            r = -1;
+            r = my_first < other_first ? -1 : 1;
+        }
+        else if ( my_last != other_last )
+        {
+            r = my_last < other_last ? -1 : 1;
         }
     }
+    return r;
+}
+
+void ControlIdentityComparatorRange::print( std::ostream &o ) const
+{
+    o << "ControlIdentityComparatorRange:" << ControlIdentity( m_descriptor_type, m_first_index, m_section, m_first_item )
+      << "-" << ControlIdentity( m_descriptor_type, m_last_index, m_section, m_last_item ) << std::endl;
+}
+
+ControlIdentityComparator::IndexType ControlIdentityComparatorRange::getIndexKeys( ControlIdentitySet &keys ) const
+{
+    IndexType r = IndexType::None;
 
+    if ( m_first_index <= m_last_index && m_first_item <= m_last_item )
+    {
+        if ( size_t( m_last_index - m_first_index ) < max_indexed_descriptors )
+        {
+            for ( uint32_t i = m_first_index; i <= m_last_index; ++i )
+            {
+                ControlIdentityKey key( ControlIdentityKey::packFields( m_descriptor_type, DescriptorIndex( i ) ) );
+                keys.insert( keys.end(), key );
+            }
+            r = IndexType::Descriptors;
+        }
+        else
+        {
+            r = IndexType::Scan;
+        }
+    }
     return r;
 }
 
-void ControlIdentityComparatorSet::print( std::ostream &o ) const
+ControlIdentityComparatorPrefix::ControlIdentityComparatorPrefix( Schema const &schema,
+                                                                  ControlIdentity const &identity,
+                                                                  Depth depth )
+    : m_schema( schema ), m_depth( depth ), m_mask( getMask( depth ) ), m_prefix( 0 )
 {
-    std::lock_guard<std::recursive_mutex> m_guard( m_mutex );
-    for ( auto const &item : m_items )
+    ControlIdentityKey key( identity );
+    if ( !key.isValid() )
     {
-        o << item;
+        throw std::range_error( Util::formstring( "ControlIdentityComparatorPrefix: identity can not be packed: ", identity ) );
+    }
+    m_prefix = key.getValue() & m_mask;
+}
+
+uint64_t ControlIdentityComparatorPrefix::getMask( Depth depth )
+{
+    // the number of low bits of a ControlIdentityKey below each field
+    unsigned low_bits = 24;
+    switch ( depth )
+    {
+    case Depth::DescriptorType:
+        low_bits = 56;
+        break;
+    case Depth::DescriptorIndex:
+        low_bits = 40;
+        break;
+    case Depth::Section:
+        low_bits = 37;
+        break;
+    case Depth::Item:
+        low_bits = 24;
+        break;
+    }
+    return ~( ( uint64_t( 1 ) << low_bits ) - 1 );
+}
+
+bool ControlIdentityComparatorPrefix::containsControl( const ControlIdentity &identity ) const
+{
+    ControlIdentityKey key( identity );
+    return key.isValid() && ( key.getValue() & m_mask ) == m_prefix;
+}
+
+void ControlIdentityComparatorPrefix::fillSet( ControlIdentitySet &items ) const
+{
+    ControlIdentityIndex const &index = m_schema.getValueIndex();
+    ControlIdentityIndex::Entry const *end = index.getEntries().end();
+    for ( ControlIdentityIndex::Entry const *i = index.lowerBound( ControlIdentityKey( m_prefix ) );
+          i != end && ( i->m_key.getValue() & m_mask ) == m_prefix;
+          ++i )
+    {
+        items.insert( items.end(), i->m_key );
     }
 }
+
+void ControlIdentityComparatorPrefix::fillBitmap( ControlIdentityBitmap &items ) const
+{
+    ControlIdentityIndex const &index = m_schema.getValueIndex();
+    if ( items.getIndex() == &index )
+    {
+        ControlIdentityIndex::Entry const *first = index.lowerBound( ControlIdentityKey( m_prefix ) );
+        ControlIdentityIndex::Entry const *last = first;
+        ControlIdentityIndex::Entry const *end = index.getEntries().end();
+        while ( last != end && ( last->m_key.getValue() & m_mask ) == m_prefix )
+        {
+            ++last;
+        }
+        items.insertEntries( first, last );
+    }
+    else
+    {
+        ControlIdentityComparator::fillBitmap( items );
+    }
+}
+
+int ControlIdentityComparatorPrefix::compare( const ControlIdentityComparator &other_ ) const
+{
+    int r = compareKind( other_ );
+
+    if ( r == 0 )
+    {
+        ControlIdentityComparatorPrefix const &other = static_cast<ControlIdentityComparatorPrefix const &>( other_ );
+
+        if ( m_prefix != other.m_prefix )
+        {
+            r = m_prefix < other.m_prefix ? -1 : 1;
+        }
+        else if ( m_mask != other.m_mask )
+        {
+            // the shorter prefix, with fewer bits in its mask, first
+            r = m_mask < other.m_mask ? -1 : 1;
+        }
+    }
+    return r;
+}
+
+void ControlIdentityComparatorPrefix::print( std::ostream &o ) const
+{
+    static const char *depth_names[] = {"DescriptorType", "DescriptorIndex", "Section", "Item"};
+    o << "ControlIdentityComparatorPrefix:" << ControlIdentityKey( m_prefix ) << " depth=" << depth_names[int( m_depth )]
+      << std::endl;
+}
+
+ControlIdentityComparator::IndexType ControlIdentityComparatorPrefix::getIndexKeys( ControlIdentitySet &keys ) const
+{
+    IndexType r = IndexType::Scan;
+
+    if ( m_depth != Depth::DescriptorType )
+    {
+        keys.insert( ControlIdentityKey( m_prefix ).getDescriptorKey() );
+        r = IndexType::Descriptors;
+    }
+    return r;
+}
 }
@@ -0,0 +1,84 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ControlIdentityIndex.hpp"
+
+namespace ControlPlane
+{
+
+void ControlIdentityIndex::clear()
+{
+    m_entries.clear();
+    m_begin = nullptr;
+    m_size = 0;
+}
+
+void ControlIdentityIndex::add( ControlIdentityKey key, RangedValueBase *ranged_value, Descriptor::DescriptorBase *descriptor )
+{
+    if ( !key.isValid() )
+    {
+        throw std::range_error( "ControlIdentityIndex: identity can not be packed" );
+    }
+    m_entries.push_back( Entry{key, ranged_value, descriptor} );
+}
+
+void ControlIdentityIndex::compile()
+{
+    std::stable_sort( m_entries.begin(),
+                      m_entries.end(),
+                      []( Entry const &lhs, Entry const &rhs )
+                      {
+                          return lhs.m_key < rhs.m_key;
+                      } );
+
+    // keep the last entry added for any duplicated key
+    std::vector<Entry> compiled;
+    compiled.reserve( m_entries.size() );
+    for ( auto const &e : m_entries )
+    {
+        if ( !compiled.empty() && compiled.back().m_key == e.m_key )
+        {
+            compiled.back() = e;
+        }
+        else
+        {
+            compiled.push_back( e );
+        }
+    }
+    compiled.shrink_to_fit();
+    m_entries.swap( compiled );
+    m_begin = m_entries.data();
+    m_size = m_entries.size();
+}
+
+void ControlIdentityIndex::adopt( Entry const *entries, size_t num_entries )
+{
+    m_entries.clear();
+    m_begin = entries;
+    m_size = num_entries;
+}
+
+ControlIdentityIndex::Entry const *ControlIdentityIndex::find( ControlIdentityKey key ) const
+{
+    Entry const *r = nullptr;
+
+    if ( key.isValid() )
+    {
+        Entry const *i = lowerBound( key );
+        if ( i != m_begin + m_size && i->m_key == key )
+        {
+            r = i;
+        }
+    }
+    return r;
+}
+
+ControlIdentityIndex::Entry const *ControlIdentityIndex::lowerBound( ControlIdentityKey key ) const
+{
+    return std::lower_bound( m_begin,
+                             m_begin + m_size,
+                             key,
+                             []( Entry const &e, ControlIdentityKey k )
+                             {
+                                 return e.m_key < k;
+                             } );
+}
+}
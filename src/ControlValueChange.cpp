@@ -0,0 +1,105 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ControlValueChange.hpp"
+
+namespace ControlPlane
+{
+
+ControlValueChange ControlValueChange::capture( const ControlIdentity &identity, const RangedValueBase &v )
+{
+    ControlValueChange r;
+    switch ( v.getStorageType() )
+    {
+    case EncodingType::ENCODING_STRING64:
+    case EncodingType::ENCODING_STRING406:
+        r = ControlValueChange( identity, v.getUnencodedValueString( false ) );
+        break;
+    case EncodingType::ENCODING_FLOAT:
+    case EncodingType::ENCODING_DOUBLE:
+        r = ControlValueChange( identity, v.getUnencodedValueDouble() );
+        break;
+    case EncodingType::ENCODING_INT8:
+    case EncodingType::ENCODING_INT16:
+    case EncodingType::ENCODING_INT32:
+    case EncodingType::ENCODING_INT64:
+        r = ControlValueChange( identity, v.getUnencodedValueInt64() );
+        break;
+    default:
+        r = ControlValueChange( identity, v.getUnencodedValueUInt64() );
+        break;
+    }
+    return r;
+}
+
+bool ControlValueChange::applyTo( RangedValueBase &v, bool force ) const
+{
+    bool r = false;
+    switch ( m_kind )
+    {
+    case Kind::Bool:
+        r = v.setUnencodedValueBool( getBool(), force );
+        break;
+    case Kind::Int64:
+        r = v.setUnencodedValueInt64( getInt64(), force );
+        break;
+    case Kind::UInt64:
+        r = v.setUnencodedValueUInt64( getUInt64(), force );
+        break;
+    case Kind::Double:
+        r = v.setUnencodedValueDouble( getDouble(), force );
+        break;
+    case Kind::String:
+        r = v.setUnencodedValueString( getString(), force );
+        break;
+    }
+    return r;
+}
+
+bool ControlValueChange::validate( RangedValueBase const &v ) const
+{
+    bool r = true;
+    switch ( m_kind )
+    {
+    case Kind::Bool:
+        // the numeric values set a bool as 0 or 255
+        r = v.isUnencodedValueInRangeInt64( getBool() ? 255 : 0 );
+        break;
+    case Kind::Int64:
+        r = v.isUnencodedValueInRangeInt64( getInt64() );
+        break;
+    case Kind::UInt64:
+        r = v.isUnencodedValueInRangeUInt64( getUInt64() );
+        break;
+    case Kind::Double:
+        r = v.isUnencodedValueInRangeDouble( getDouble() );
+        break;
+    case Kind::String:
+        r = v.isUnencodedValueInRangeString( getString() );
+        break;
+    }
+    return r;
+}
+
+std::ostream &operator<<( std::ostream &o, const ControlValueChange &v )
+{
+    o << v.getIdentity() << " = ";
+    switch ( v.getKind() )
+    {
+    case ControlValueChange::Kind::Bool:
+        o << ( v.getBool() ? "true" : "false" );
+        break;
+    case ControlValueChange::Kind::Int64:
+        o << v.getInt64();
+        break;
+    case ControlValueChange::Kind::UInt64:
+        o << v.getUInt64();
+        break;
+    case ControlValueChange::Kind::Double:
+        o << v.getDouble();
+        break;
+    case ControlValueChange::Kind::String:
+        o << "'" << v.getString() << "'";
+        break;
+    }
+    return o;
+}
+}
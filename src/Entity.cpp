@@ -24,11 +24,11 @@ Entity::Entity( std::string description,
     addProperty( "entity_model_id", entity_model_id );
 }
 
-ControlValue &Entity::getValue( size_t item_num, size_t w, size_t h )
+RangedValueBase *Entity::getRangedValue( size_t item_num, size_t w, size_t h ) const
 {
     if ( w == 0 && h == 0 )
     {
-        return m_items[item_num];
+        return m_items[item_num].m_ranged_value;
     }
     else
     {
@@ -36,11 +36,11 @@ ControlValue &Entity::getValue( size_t item_num, size_t w, size_t h )
     }
 }
 
-const ControlValue &Entity::getValue( size_t item_num, size_t w, size_t h ) const
+string const &Entity::getValueName( size_t item_num, size_t w, size_t h ) const
 {
     if ( w == 0 && h == 0 )
     {
-        return m_items[item_num];
+        return m_items[item_num].m_name;
     }
     else
     {
@@ -7,8 +7,178 @@ namespace ControlPlane
 namespace Descriptor
 {
 
+namespace
+{
+
+uint16_t getEncodedSize( EncodingType encoding_type )
+{
+    uint16_t r = 0;
+    switch ( encoding_type )
+    {
+    case EncodingType::ENCODING_INT8:
+    case EncodingType::ENCODING_UINT8:
+        r = 1;
+        break;
+    case EncodingType::ENCODING_INT16:
+    case EncodingType::ENCODING_UINT16:
+        r = 2;
+        break;
+    case EncodingType::ENCODING_INT32:
+    case EncodingType::ENCODING_UINT32:
+    case EncodingType::ENCODING_FLOAT:
+        r = 4;
+        break;
+    case EncodingType::ENCODING_INT64:
+    case EncodingType::ENCODING_UINT64:
+    case EncodingType::ENCODING_DOUBLE:
+        r = 8;
+        break;
+    default:
+        throw std::runtime_error( "Matrix values must have a numeric encoding" );
+    }
+    return r;
+}
+
+void putEncodedValue( FixedBuffer &pdu, RangedValueBase const &v, EncodingType encoding_type )
+{
+    switch ( encoding_type )
+    {
+    case EncodingType::ENCODING_INT8:
+        pdu.putOctet( uint8_t( v.getEncodedValueInt8() ) );
+        break;
+    case EncodingType::ENCODING_UINT8:
+        pdu.putOctet( v.getEncodedValueUInt8() );
+        break;
+    case EncodingType::ENCODING_INT16:
+        pdu.putDoublet( uint16_t( v.getEncodedValueInt16() ) );
+        break;
+    case EncodingType::ENCODING_UINT16:
+        pdu.putDoublet( v.getEncodedValueUInt16() );
+        break;
+    case EncodingType::ENCODING_INT32:
+        pdu.putQuadlet( uint32_t( v.getEncodedValueInt32() ) );
+        break;
+    case EncodingType::ENCODING_UINT32:
+        pdu.putQuadlet( v.getEncodedValueUInt32() );
+        break;
+    case EncodingType::ENCODING_INT64:
+        pdu.putOctlet( uint64_t( v.getEncodedValueInt64() ) );
+        break;
+    case EncodingType::ENCODING_UINT64:
+        pdu.putOctlet( v.getEncodedValueUInt64() );
+        break;
+    case EncodingType::ENCODING_FLOAT:
+        pdu.putQuadlet( uint32_t( v.getEncodedValueBits() ) );
+        break;
+    default:
+        pdu.putOctlet( v.getEncodedValueBits() );
+        break;
+    }
+}
+
+void putEncodedNumber( FixedBuffer &pdu, int64_t v, EncodingType encoding_type, uint16_t size )
+{
+    uint64_t bits = uint64_t( v );
+    if ( encoding_type == EncodingType::ENCODING_FLOAT )
+    {
+        float f = float( v );
+        uint32_t bits32;
+        memcpy( &bits32, &f, sizeof( bits32 ) );
+        bits = bits32;
+    }
+    else if ( encoding_type == EncodingType::ENCODING_DOUBLE )
+    {
+        double d = double( v );
+        memcpy( &bits, &d, sizeof( bits ) );
+    }
+    for ( uint16_t i = size; i > 0; --i )
+    {
+        pdu.putOctet( uint8_t( bits >> ( ( i - 1 ) * 8 ) ) );
+    }
+}
+}
+
 Matrix::~Matrix() {}
 
-void Matrix::storeToPDU( FixedBuffer &pdu ) const { /* TODO */}
+void Matrix::storeToPDU( FixedBuffer &pdu ) const
+{
+    uint16_t start = pdu.getLength();
+    pdu.putDoublet( getAvdeccDescriptorType() );
+    pdu.putDoublet( getAvdeccDescriptorIndex() );
+    pdu.putAvdeccString( getDescription() );
+    pdu.putDoublet( 0xffff );                      // localized_description
+    pdu.putQuadlet( 0 );                           // block_latency
+    pdu.putQuadlet( 0 );                           // control_latency
+    pdu.putDoublet( 0 );                           // control_domain
+    pdu.putDoublet( m_avdecc_control_value_type ); // control_value_type
+    pdu.putOctlet( m_avdecc_control_type );        // control_type
+    pdu.putDoublet( getWidth() );                  // width
+    pdu.putDoublet( getHeight() );                 // height
+
+    uint16_t values_offset_pos = pdu.getLength();
+    pdu.putDoublet( 0 );                                                               // values_offset, set below
+    pdu.putDoublet( getNumValues() );                                                  // number_of_values
+    pdu.putDoublet( uint16_t( m_current_matrix_signal_descriptor->getNumSignals() ) ); // number_of_sources
+    pdu.putDoublet( m_current_matrix_signal_descriptor->getAvdeccDescriptorIndex() );  // base_source
+    pdu.setDoublet( uint16_t( pdu.getLength() - start ), values_offset_pos );
+
+    // the linear value details of each kind, with the current value of the cell at column 0, row 0
+    for ( size_t item = 0; item < m_values.size() && m_width > 0 && m_height > 0; ++item )
+    {
+        RangedValueBase const &v = *m_values[item].getRangedValue( 0, 0 );
+        EncodingType encoding_type = v.getEncodingType();
+        uint16_t size = getEncodedSize( encoding_type );
+        putEncodedNumber( pdu, v.getEncodedMinValue(), encoding_type, size );     // minimum
+        putEncodedNumber( pdu, v.getEncodedMaxValue(), encoding_type, size );     // maximum
+        putEncodedNumber( pdu, v.getEncodedStepValue(), encoding_type, size );    // step
+        putEncodedNumber( pdu, v.getEncodedDefaultValue(), encoding_type, size ); // default_value
+        putEncodedValue( pdu, v, encoding_type );                                 // current
+        pdu.putOctet( uint8_t( v.getEncodingMultiplierPower() ) );                // unit multiplier
+        pdu.putOctet( uint8_t( v.getUnitsCode() ) );                              // unit code
+        pdu.putDoublet( 0xffff );                                                 // string
+    }
+}
+
+void Matrix::storeValuesToPDU( FixedBuffer &pdu,
+                               size_t item_num,
+                               uint16_t column,
+                               uint16_t row,
+                               uint16_t region_width,
+                               uint16_t region_height ) const
+{
+    MatrixValues const &values = getValues( item_num );
+    if ( size_t( column ) + region_width > m_width || size_t( row ) + region_height > m_height )
+    {
+        throw std::range_error( "Matrix region is out of range" );
+    }
+
+    size_t count = size_t( region_width ) * region_height;
+    if ( count > 0 )
+    {
+        EncodingType encoding_type = values.getRangedValue( column, row )->getEncodingType();
+        uint16_t size = getEncodedSize( encoding_type );
+        if ( count * size > pdu.getMaxLength() || !pdu.canPut( uint16_t( count * size ) ) )
+        {
+            throw std::range_error( "Matrix region does not fit in the PDU" );
+        }
+
+        MatrixValues::EncodeRowFunction encode_row = values.getEncodeRowFunction();
+        for ( uint16_t h = row; h < row + region_height; ++h )
+        {
+            if ( encode_row )
+            {
+                encode_row( pdu.getBuf( pdu.getLength() ), values.getRangedValue( column, h ), region_width );
+                pdu.setLength( uint16_t( pdu.getLength() + region_width * 4 ) );
+            }
+            else
+            {
+                for ( uint16_t w = column; w < column + region_width; ++w )
+                {
+                    putEncodedValue( pdu, *values.getRangedValue( w, h ), encoding_type );
+                }
+            }
+        }
+    }
+}
 }
 }
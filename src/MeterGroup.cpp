@@ -0,0 +1,72 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/MeterGroup.hpp"
+#include "ControlPlane/Schema.hpp"
+
+namespace ControlPlane
+{
+
+MeterGroup::MeterGroup( const Schema &schema, const std::vector<ControlIdentity> &meters ) : m_sequence( 0 )
+{
+    m_meters.reserve( meters.size() );
+    m_values.reserve( meters.size() );
+    for ( auto const &identity : meters )
+    {
+        RangedValueBase const *ranged_value = schema.getRangedValueForControlIdentity( identity );
+        if ( !ranged_value )
+        {
+            throw SchemaErrorNoSuchControlIdentity( identity );
+        }
+        addMeter( ControlIdentityKey( identity ), ranged_value );
+    }
+}
+
+MeterGroup::MeterGroup( const Schema &schema, const ControlIdentity &first, size_t count ) : m_sequence( 0 )
+{
+    ControlIdentityIndex const &index = schema.getValueIndex();
+    ControlIdentityIndex::Entry const *e = index.find( first );
+    if ( !e || size_t( index.getEntries().end() - e ) < count )
+    {
+        throw SchemaErrorNoSuchControlIdentity( first );
+    }
+
+    m_meters.reserve( count );
+    m_values.reserve( count );
+    for ( size_t i = 0; i < count; ++i, ++e )
+    {
+        addMeter( e->m_key, e->m_ranged_value );
+    }
+}
+
+void MeterGroup::addMeter( ControlIdentityKey key, const RangedValueBase *ranged_value )
+{
+    if ( ranged_value->getEncodingType() != EncodingType::ENCODING_INT8 || !ranged_value->isReadOnly() )
+    {
+        throw SchemaErrorNotAMeter( key );
+    }
+    m_meters.push_back( key );
+    m_values.push_back( ranged_value );
+}
+
+MeterFramePtr MeterGroup::sample( Milliseconds current_time_in_milliseconds )
+{
+    std::lock_guard<std::mutex> lock( m_frame_mutex );
+
+    if ( !m_frame || m_frame->m_time_in_milliseconds != current_time_in_milliseconds )
+    {
+        // a new frame each time, as subscribers on other threads may still be reading the previous one
+        auto frame = std::make_shared<MeterFrame>();
+        frame->m_time_in_milliseconds = current_time_in_milliseconds;
+        frame->m_sequence = ++m_sequence;
+        frame->m_levels.resize( m_values.size() );
+
+        // the levels are in atomic storage, so they are read without the schema lock that writers wait on
+        int8_t *level = frame->m_levels.data();
+        for ( auto const *ranged_value : m_values )
+        {
+            *level++ = ranged_value->getEncodedValueInt8();
+        }
+        m_frame = frame;
+    }
+    return m_frame;
+}
+}
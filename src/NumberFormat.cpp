@@ -0,0 +1,410 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/NumberFormat.hpp"
+
+namespace ControlPlane
+{
+namespace Util
+{
+
+namespace
+{
+
+const double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+const float float_powers_of_ten[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+///
+/// \brief writeDigits
+///
+/// Write the decimal digits of v to the end of a buffer, backwards
+///
+/// \return a pointer to the first digit
+///
+char *writeDigits( char *end, uint64_t v )
+{
+    char *p = end;
+    do
+    {
+        *--p = char( '0' + v % 10 );
+        v /= 10;
+    } while ( v );
+    return p;
+}
+
+const char *skipSpace( const char *p, const char *last )
+{
+    while ( p != last && ( *p == ' ' || ( *p >= '\t' && *p <= '\r' ) ) )
+    {
+        ++p;
+    }
+    return p;
+}
+
+bool isDigit( char c ) { return c >= '0' && c <= '9'; }
+
+///
+/// \brief The DecimalScan struct
+///
+/// The significant digits and decimal exponent of a number in text, as far as
+/// 19 significant digits, and the span of the text to give strtod otherwise
+///
+struct DecimalScan
+{
+    const char *m_begin;
+    const char *m_end;
+    bool m_valid;
+    bool m_negative;
+    uint64_t m_mantissa;
+    int m_exponent;
+    bool m_exact;
+
+    DecimalScan( const char *first, const char *last )
+        : m_begin( skipSpace( first, last ) )
+        , m_end( first )
+        , m_valid( false )
+        , m_negative( false )
+        , m_mantissa( 0 )
+        , m_exponent( 0 )
+        , m_exact( true )
+    {
+        const char *p = m_begin;
+        int digits = 0;
+
+        if ( p != last && ( *p == '-' || *p == '+' ) )
+        {
+            m_negative = *p == '-';
+            ++p;
+        }
+        for ( ; p != last && isDigit( *p ); ++p )
+        {
+            m_valid = true;
+            addDigit( *p - '0', digits, 0 );
+        }
+        if ( p != last && *p == '.' )
+        {
+            for ( ++p; p != last && isDigit( *p ); ++p )
+            {
+                m_valid = true;
+                addDigit( *p - '0', digits, -1 );
+            }
+        }
+        if ( m_valid )
+        {
+            if ( p != last && ( *p == 'e' || *p == 'E' ) )
+            {
+                const char *e = p + 1;
+                bool negative_exponent = false;
+                if ( e != last && ( *e == '-' || *e == '+' ) )
+                {
+                    negative_exponent = *e == '-';
+                    ++e;
+                }
+                if ( e != last && isDigit( *e ) )
+                {
+                    int exponent = 0;
+                    for ( ; e != last && isDigit( *e ); ++e )
+                    {
+                        exponent = std::min( exponent * 10 + ( *e - '0' ), 99999 );
+                    }
+                    m_exponent += negative_exponent ? -exponent : exponent;
+                    p = e;
+                }
+            }
+            m_end = p;
+        }
+    }
+
+    void addDigit( int d, int &digits, int exponent_step )
+    {
+        if ( digits < 19 )
+        {
+            m_mantissa = m_mantissa * 10 + uint64_t( d );
+            m_exponent += exponent_step;
+            if ( m_mantissa )
+            {
+                ++digits;
+            }
+        }
+        else
+        {
+            // past the digits which fit, a digit before the point still scales the value
+            m_exponent += exponent_step + 1;
+            m_exact = m_exact && d == 0;
+        }
+    }
+
+    /// the text of the number, for strtod
+    string getText() const { return string( m_begin, m_end ); }
+};
+}
+
+size_t formatSigned( char *buf, int64_t v )
+{
+    char tmp[max_number_length];
+    char *end = tmp + sizeof( tmp );
+    // negate in unsigned arithmetic so that the smallest int64_t does not overflow
+    char *p = writeDigits( end, v < 0 ? uint64_t( 0 ) - uint64_t( v ) : uint64_t( v ) );
+    if ( v < 0 )
+    {
+        *--p = '-';
+    }
+    size_t r = size_t( end - p );
+    memcpy( buf, p, r );
+    buf[r] = '\0';
+    return r;
+}
+
+size_t formatUnsigned( char *buf, uint64_t v )
+{
+    char tmp[max_number_length];
+    char *end = tmp + sizeof( tmp );
+    char *p = writeDigits( end, v );
+    size_t r = size_t( end - p );
+    memcpy( buf, p, r );
+    buf[r] = '\0';
+    return r;
+}
+
+size_t formatHex( char *buf, uint64_t v )
+{
+    static const char hex[] = "0123456789abcdef";
+    char tmp[max_number_length];
+    char *end = tmp + sizeof( tmp );
+    char *p = end;
+    do
+    {
+        *--p = hex[v & 0xf];
+        v >>= 4;
+    } while ( v );
+    size_t r = size_t( end - p );
+    memcpy( buf, p, r );
+    buf[r] = '\0';
+    return r;
+}
+
+size_t formatFloating( char *buf, double v, int multiplier_power )
+{
+    size_t r = 0;
+    bool done = false;
+
+    if ( multiplier_power >= -9 && multiplier_power <= 9 )
+    {
+        double scaled = multiplier_power <= 0 ? v * powers_of_ten[-multiplier_power] : v / powers_of_ten[multiplier_power];
+
+        // also false for NaN and infinities
+        if ( scaled > -1e15 && scaled < 1e15 )
+        {
+            int64_t n = int64_t( scaled < 0 ? scaled - 0.5 : scaled + 0.5 );
+            double error = std::fabs( scaled - double( n ) );
+            uint64_t m = n < 0 ? uint64_t( -n ) : uint64_t( n );
+            double magnitude = double( m );
+            int power = multiplier_power;
+
+            while ( m != 0 && m % 10 == 0 )
+            {
+                m /= 10;
+                ++power;
+            }
+
+            char digits[max_number_length];
+            char *digits_end = digits + sizeof( digits );
+            char *first_digit = writeDigits( digits_end, m );
+            int num_digits = int( digits_end - first_digit );
+            int exponent = num_digits - 1 + power;
+
+            // "%.6g" rounds to 6 significant digits, so a value within less than half of
+            // the last of those of n * 10^power is written as n * 10^power, in plain
+            // notation when its exponent is from -4 to 5
+            if ( n == 0 )
+            {
+                // only an exact positive zero, as "%.6g" gives "-0" for negative zero
+                done = v == 0.0 && !std::signbit( v );
+                if ( done )
+                {
+                    buf[0] = '0';
+                    buf[1] = '\0';
+                    r = 1;
+                }
+            }
+            else if ( num_digits <= 6 && exponent >= -4 && exponent < 6 && error <= 4e-7 * magnitude )
+            {
+                done = true;
+                char *p = buf;
+                if ( n < 0 )
+                {
+                    *p++ = '-';
+                }
+                if ( power >= 0 )
+                {
+                    memcpy( p, first_digit, size_t( num_digits ) );
+                    p += num_digits;
+                    for ( int i = 0; i < power; ++i )
+                    {
+                        *p++ = '0';
+                    }
+                }
+                else if ( num_digits + power > 0 )
+                {
+                    size_t whole = size_t( num_digits + power );
+                    memcpy( p, first_digit, whole );
+                    p += whole;
+                    *p++ = '.';
+                    memcpy( p, first_digit + whole, size_t( -power ) );
+                    p += -power;
+                }
+                else
+                {
+                    *p++ = '0';
+                    *p++ = '.';
+                    for ( int i = 0; i < -( num_digits + power ); ++i )
+                    {
+                        *p++ = '0';
+                    }
+                    memcpy( p, first_digit, size_t( num_digits ) );
+                    p += num_digits;
+                }
+                *p = '\0';
+                r = size_t( p - buf );
+            }
+        }
+    }
+
+    if ( !done )
+    {
+        char tmp[max_number_length];
+        int length = sprintf( tmp, "%.6g", v );
+        r = length > 0 ? size_t( length ) : 0;
+        memcpy( buf, tmp, r );
+        buf[r] = '\0';
+    }
+    return r;
+}
+
+const char *parseSigned( const char *first, const char *last, int64_t &v )
+{
+    const char *r = first;
+    const char *p = skipSpace( first, last );
+    bool negative = false;
+    v = 0;
+
+    if ( p != last && ( *p == '-' || *p == '+' ) )
+    {
+        negative = *p == '-';
+        ++p;
+    }
+    if ( p != last && isDigit( *p ) )
+    {
+        uint64_t limit = negative ? uint64_t( std::numeric_limits<int64_t>::max() ) + 1
+                                  : uint64_t( std::numeric_limits<int64_t>::max() );
+        uint64_t magnitude = 0;
+        for ( ; p != last && isDigit( *p ); ++p )
+        {
+            uint64_t d = uint64_t( *p - '0' );
+            magnitude = magnitude > ( limit - d ) / 10 ? limit : magnitude * 10 + d;
+        }
+        v = negative ? int64_t( uint64_t( 0 ) - magnitude ) : int64_t( magnitude );
+        r = p;
+    }
+    return r;
+}
+
+const char *parseUnsigned( const char *first, const char *last, uint64_t &v )
+{
+    int64_t negative_check = 0;
+    const char *p = skipSpace( first, last );
+    const char *r = first;
+    v = 0;
+
+    if ( p != last && *p == '-' )
+    {
+        r = parseSigned( p, last, negative_check );
+    }
+    else
+    {
+        if ( p != last && *p == '+' )
+        {
+            ++p;
+        }
+        if ( p != last && isDigit( *p ) )
+        {
+            uint64_t limit = std::numeric_limits<uint64_t>::max();
+            for ( ; p != last && isDigit( *p ); ++p )
+            {
+                uint64_t d = uint64_t( *p - '0' );
+                v = v > ( limit - d ) / 10 ? limit : v * 10 + d;
+            }
+            r = p;
+        }
+    }
+    return r;
+}
+
+const char *parseHex( const char *first, const char *last, uint64_t &v )
+{
+    const char *r = first;
+    const char *p = skipSpace( first, last );
+    v = 0;
+
+    if ( last - p > 2 && p[0] == '0' && ( p[1] == 'x' || p[1] == 'X' ) && isxdigit( (unsigned char)p[2] ) )
+    {
+        p += 2;
+    }
+    for ( ; p != last && isxdigit( (unsigned char)*p ); ++p )
+    {
+        unsigned d = isDigit( *p ) ? unsigned( *p - '0' ) : unsigned( ( *p | 0x20 ) - 'a' + 10 );
+        v = v > ( std::numeric_limits<uint64_t>::max() >> 4 ) ? std::numeric_limits<uint64_t>::max() : ( v << 4 ) | d;
+        r = p + 1;
+    }
+    return r;
+}
+
+const char *parseNumber( const char *first, const char *last, float &v )
+{
+    const char *r = first;
+    DecimalScan scan( first, last );
+    v = 0.0f;
+
+    if ( scan.m_valid )
+    {
+        // both operands are exact in a float, so one operation rounds correctly
+        if ( scan.m_exact && scan.m_mantissa <= ( uint64_t( 1 ) << 24 ) && scan.m_exponent >= -10 && scan.m_exponent <= 10 )
+        {
+            float m = float( scan.m_mantissa );
+            v = scan.m_exponent < 0 ? m / float_powers_of_ten[-scan.m_exponent] : m * float_powers_of_ten[scan.m_exponent];
+        }
+        else
+        {
+            v = strtof( scan.getText().c_str(), nullptr );
+        }
+        v = scan.m_negative ? -std::fabs( v ) : v;
+        r = scan.m_end;
+    }
+    return r;
+}
+
+const char *parseNumber( const char *first, const char *last, double &v )
+{
+    const char *r = first;
+    DecimalScan scan( first, last );
+    v = 0.0;
+
+    if ( scan.m_valid )
+    {
+        // both operands are exact in a double, so one operation rounds correctly
+        if ( scan.m_exact && scan.m_mantissa <= ( uint64_t( 1 ) << 53 ) && scan.m_exponent >= -22 && scan.m_exponent <= 22 )
+        {
+            double m = double( scan.m_mantissa );
+            v = scan.m_exponent < 0 ? m / powers_of_ten[-scan.m_exponent] : m * powers_of_ten[scan.m_exponent];
+        }
+        else
+        {
+            v = strtod( scan.getText().c_str(), nullptr );
+        }
+        v = scan.m_negative ? -std::fabs( v ) : v;
+        r = scan.m_end;
+    }
+    return r;
+}
+}
+}
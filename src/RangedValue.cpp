@@ -5,4 +5,103 @@
 namespace ControlPlane
 {
 const char *RangedValue_file = __FILE__;
+
+uint64_t RangedValueBase::getEncodedValueBits() const
+{
+    uint64_t r = 0;
+    switch ( getEncodingType() )
+    {
+    case EncodingType::ENCODING_INT8:
+        r = uint8_t( getEncodedValueInt8() );
+        break;
+    case EncodingType::ENCODING_UINT8:
+        r = getEncodedValueUInt8();
+        break;
+    case EncodingType::ENCODING_INT16:
+        r = uint16_t( getEncodedValueInt16() );
+        break;
+    case EncodingType::ENCODING_UINT16:
+        r = getEncodedValueUInt16();
+        break;
+    case EncodingType::ENCODING_INT32:
+        r = uint32_t( getEncodedValueInt32() );
+        break;
+    case EncodingType::ENCODING_UINT32:
+        r = getEncodedValueUInt32();
+        break;
+    case EncodingType::ENCODING_INT64:
+        r = uint64_t( getEncodedValueInt64() );
+        break;
+    case EncodingType::ENCODING_UINT64:
+        r = getEncodedValueUInt64();
+        break;
+    case EncodingType::ENCODING_FLOAT:
+    {
+        float f = getEncodedValueFloat();
+        uint32_t bits;
+        memcpy( &bits, &f, sizeof( bits ) );
+        r = bits;
+        break;
+    }
+    case EncodingType::ENCODING_DOUBLE:
+    {
+        double d = getEncodedValueDouble();
+        memcpy( &r, &d, sizeof( r ) );
+        break;
+    }
+    default:
+        break;
+    }
+    return r;
+}
+
+bool RangedValueBase::setFromEncodedValueBitsWithClamp( uint64_t bits )
+{
+    bool r = false;
+    switch ( getEncodingType() )
+    {
+    case EncodingType::ENCODING_INT8:
+        r = setFromEncodedValueWithClampInt8( int8_t( bits ) );
+        break;
+    case EncodingType::ENCODING_UINT8:
+        r = setFromEncodedValueWithClampUInt8( uint8_t( bits ) );
+        break;
+    case EncodingType::ENCODING_INT16:
+        r = setFromEncodedValueWithClampInt16( int16_t( bits ) );
+        break;
+    case EncodingType::ENCODING_UINT16:
+        r = setFromEncodedValueWithClampUInt16( uint16_t( bits ) );
+        break;
+    case EncodingType::ENCODING_INT32:
+        r = setFromEncodedValueWithClampInt32( int32_t( bits ) );
+        break;
+    case EncodingType::ENCODING_UINT32:
+        r = setFromEncodedValueWithClampUInt32( uint32_t( bits ) );
+        break;
+    case EncodingType::ENCODING_INT64:
+        r = setFromEncodedValueWithClampInt64( int64_t( bits ) );
+        break;
+    case EncodingType::ENCODING_UINT64:
+        r = setFromEncodedValueWithClampUInt64( bits );
+        break;
+    case EncodingType::ENCODING_FLOAT:
+    {
+        uint32_t bits32 = uint32_t( bits );
+        float f;
+        memcpy( &f, &bits32, sizeof( f ) );
+        r = setFromEncodedValueWithClampFloat( f );
+        break;
+    }
+    case EncodingType::ENCODING_DOUBLE:
+    {
+        double d;
+        memcpy( &d, &bits, sizeof( d ) );
+        r = setFromEncodedValueWithClampDouble( d );
+        break;
+    }
+    default:
+        break;
+    }
+    return r;
+}
 }
@@ -0,0 +1,8 @@
+
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/RangedValueStorage.hpp"
+
+namespace ControlPlane
+{
+const char *RangedValueStorage_file = __FILE__;
+}
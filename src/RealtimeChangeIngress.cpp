@@ -0,0 +1,19 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/RealtimeChangeIngress.hpp"
+
+namespace ControlPlane
+{
+
+size_t RealtimeChangeIngress::drain( ControlIdentitySet &items )
+{
+    size_t r = 0;
+    ControlIdentityKey key;
+
+    // only take what was queued when the drain started, so a busy producer can not keep the drain going
+    for ( size_t available = m_ring.size(); r < available && m_ring.pop( key ); ++r )
+    {
+        items.insert( key );
+    }
+    return r;
+}
+}
@@ -5,88 +5,252 @@ namespace ControlPlane
 {
 using Util::formstring;
 
-void Schema::collectDescriptors()
+Schema::Schema( ControlContainerPtr top_level )
+    : m_top_level( top_level ), m_change_manager( &m_value_index ), m_static_table{nullptr, nullptr, 0}
 {
-    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
-    m_top_level->enumerate(
-        [=]( const SchemaAddress &address, DescriptorPtr descriptor, ControlIdentity identity )
+    collectDescriptors();
+}
+
+Schema::Schema( const StaticSchemaTable &table ) : m_change_manager( &m_value_index ), m_static_table( table )
+{
+    m_value_index.adopt( table.m_entries, table.m_num_entries );
+
+    for ( size_t i = 0; i < table.m_num_entries; ++i )
+    {
+        StaticSchemaAddress const &a = table.m_addresses[i];
+        const char *path[StaticSchemaAddress::depth] = {a.m_group->m_name, a.m_channel_name, a.m_control->m_name};
+        m_address_trie.insert( path, StaticSchemaAddress::depth, table.m_entries[i].m_key );
+    }
+}
+
+void Schema::requireDescriptors() const
+{
+    // the static tables are complete without the descriptors, so they are only built on demand. This is the
+    // only place that a const Schema is modified, and call_once makes it safe for concurrent readers.
+    if ( isStatic() )
+    {
+        std::call_once( m_descriptors_collected, &Schema::collectStaticDescriptors, const_cast<Schema *>( this ) );
+    }
+}
+
+void Schema::collectStaticDescriptors()
+{
+    Descriptor::DescriptorCounts counts;
+    m_top_level = ControlContainer::create();
+
+    for ( size_t i = 0; i < m_static_table.m_num_entries; ++i )
+    {
+        ControlIdentityIndex::Entry const &e = m_static_table.m_entries[i];
+        StaticSchemaAddress const &a = m_static_table.m_addresses[i];
+        StaticControlInfo const &info = *a.m_control;
+
+        Descriptor::ControlPtr control
+            = Descriptor::makeControl( info.m_control_type,
+                                       formstring( a.m_group->m_description, " ", a.m_channel_name, " ", info.m_description ),
+                                       info.m_control_value_type,
+                                       ControlValue{info.m_name, e.m_ranged_value} );
+        control->collectOwnedDescriptors( counts, m_top_level );
+
+        ControlIdentity identity = control->getControlIdentityForItem( 0, 0, 0 );
+        if ( !( ControlIdentityKey( identity ) == e.m_key ) )
         {
-            SchemaAddress sub = address;
+            throw SchemaError( formstring( "Schema: static table is not in descriptor order at ", identity ) );
+        }
+        m_top_level->addItem( a.m_group->m_name )->addItem( a.m_channel_name )->addItem( info.m_name, control, identity );
+    }
 
-            for ( uint16_t i = 0; i < descriptor->getNumProperties(); ++i )
-            {
-                sub.push_back( descriptor->getPropertyName( i ) );
-                m_top_level->addItem( sub, descriptor, descriptor->getControlIdentityForProperty( i ) );
-                sub.pop_back();
-            }
-            if ( descriptor->getHeight() > 1 && descriptor->getWidth() > 1 && descriptor->getNumValues() > 0 )
-            {
-                for ( uint16_t h = 0; h < descriptor->getHeight(); ++h )
-                {
-                    sub.push_back( formstring( h + 1 ) );
+    collectAddresses( false );
+    compileDescriptorIndex();
+}
 
-                    for ( uint16_t w = 0; w < descriptor->getWidth(); ++w )
-                    {
-                        sub.push_back( formstring( w + 1 ) );
+namespace
+{
 
-                        if ( descriptor->getNumValues() == 1 )
-                        {
-                            m_top_level->addItem( sub, descriptor, descriptor->getControlIdentityForItem( 0, h, w ) );
-                        }
-                        else
-                        {
-                            for ( uint16_t i = 0; i < descriptor->getNumValues(); ++i )
+///
+/// \brief addContainers
+///
+/// \return the container at the first count elements of address, adding any containers which are missing
+///
+ControlContainer *addContainers( ControlContainer *top, SchemaAddress const &address, size_t count )
+{
+    ControlContainer *r = top;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        r = r->addItem( address[i] ).get();
+    }
+    return r;
+}
+
+///
+/// \brief requireNumberNames
+///
+/// Make sure that names holds the address elements "1" to "count", so each one is only formatted once
+///
+void requireNumberNames( std::vector<SchemaAddressElement> &names, size_t count )
+{
+    while ( names.size() < count )
+    {
+        names.push_back( formstring( names.size() + 1 ) );
+    }
+}
+}
+
+void Schema::collectDescriptors()
+{
+    std::lock_guard<SharedMutex> lock( m_access_mutex );
+
+    // collect the generated items first, so that adding the items for their values does not disturb the enumeration
+    std::vector<std::pair<SchemaAddress, DescriptorPtr> > generated;
+    m_top_level->enumerate( [&]( const SchemaAddress &address, DescriptorPtr descriptor, ControlIdentity )
                             {
-                                sub.push_back( descriptor->getValue( i, w, h ).m_name );
-                                m_top_level->addItem( sub, descriptor, descriptor->getControlIdentityForItem( i, h, w ) );
-                                sub.pop_back();
-                            }
-                        }
-                        sub.pop_back();
-                    }
-                    sub.pop_back();
-                }
+                                generated.emplace_back( address, descriptor );
+                            } );
+
+    std::vector<SchemaAddressElement> numbers;
+    for ( auto const &item : generated )
+    {
+        SchemaAddress const &address = item.first;
+        DescriptorPtr const &descriptor = item.second;
+        uint16_t height = descriptor->getHeight();
+        uint16_t width = descriptor->getWidth();
+        uint16_t num_values = descriptor->getNumValues();
+
+        ControlContainer *parent = addContainers( m_top_level.get(), address, address.size() - 1 );
+
+        // the container named by the address itself, which holds the items of the properties and values
+        ControlContainer *node = nullptr;
+        auto getNode = [&]()
+        {
+            if ( !node )
+            {
+                node = parent->addItem( address.back() ).get();
             }
-            else
+            return node;
+        };
+
+        for ( uint16_t i = 0; i < descriptor->getNumProperties(); ++i )
+        {
+            getNode()->addItem( descriptor->getPropertyName( i ), descriptor, descriptor->getControlIdentityForProperty( i ) );
+        }
+
+        if ( height > 1 && width > 1 && num_values > 0 )
+        {
+            requireNumberNames( numbers, std::max( height, width ) );
+            for ( uint16_t h = 0; h < height; ++h )
             {
-                if ( descriptor->getHeight() == 1 && descriptor->getWidth() == 1 && descriptor->getNumValues() > 1 )
+                ControlContainer *row = getNode()->addItem( numbers[h] ).get();
+
+                for ( uint16_t w = 0; w < width; ++w )
                 {
-                    for ( uint16_t i = 0; i < descriptor->getNumValues(); ++i )
+                    if ( num_values == 1 )
                     {
-                        sub.push_back( formstring( i + 1 ) );
-                        m_top_level->addItem( sub, descriptor, descriptor->getControlIdentityForItem( i, 0, 0 ) );
-                        sub.pop_back();
+                        row->addItem( numbers[w], descriptor, descriptor->getControlIdentityForItem( 0, h, w ) );
                     }
-                }
-                else
-                {
-                    if ( descriptor->getHeight() == 1 && descriptor->getWidth() == 1 && descriptor->getNumValues() == 1 )
+                    else
                     {
-                        m_top_level->addItem( sub, descriptor, descriptor->getControlIdentityForItem( 0, 0, 0 ) );
+                        ControlContainer *cell = row->addItem( numbers[w] ).get();
+                        for ( uint16_t i = 0; i < num_values; ++i )
+                        {
+                            cell->addItem( descriptor->getValueName( i, w, h ),
+                                           descriptor,
+                                           descriptor->getControlIdentityForItem( i, h, w ) );
+                        }
                     }
                 }
             }
+        }
+        else if ( height == 1 && width == 1 && num_values > 1 )
+        {
+            requireNumberNames( numbers, num_values );
+            for ( uint16_t i = 0; i < num_values; ++i )
+            {
+                getNode()->addItem( numbers[i], descriptor, descriptor->getControlIdentityForItem( i, 0, 0 ) );
+            }
+        }
+        else if ( height == 1 && width == 1 && num_values == 1 )
+        {
+            parent->addItem( address.back(), descriptor, descriptor->getControlIdentityForItem( 0, 0, 0 ) );
+        }
+    }
+
+    m_top_level->updateControlIdentities();
+
+    m_value_index.clear();
+    collectAddresses( true );
+    compileDescriptorIndex();
+    m_value_index.compile();
+
+    m_address_trie.reserve( m_address_map.size() );
+    m_address_trie.build( *m_top_level );
+}
 
+void Schema::collectAddresses( bool index_values )
+{
+    std::vector<std::pair<ControlIdentityKey, SchemaAddress const *> > identities;
+    Descriptor::DescriptorBase *last_descriptor = nullptr;
+
+    m_top_level->enumerate(
+        [&]( const SchemaAddress &address, DescriptorPtr descriptor, ControlIdentity identity )
+        {
+            if ( !ControlIdentityKey::isPackable( identity ) )
+            {
+                throw SchemaError( formstring( "Schema: ControlIdentity can not be packed: ", identity ) );
+            }
+
+            // every value of a matrix has the same descriptor, so only look it up when it changes
+            if ( descriptor.get() != last_descriptor )
+            {
+                ControlIdentity descriptor_identity = identity;
+                descriptor_identity.m_section = ControlIdentity::SectionDescriptorLevel;
+                descriptor_identity.m_h_pos = 0;
+                descriptor_identity.m_w_pos = 0;
+                descriptor_identity.m_item = 0;
+                m_descriptor_avdecc_map[descriptor_identity] = descriptor;
+                last_descriptor = descriptor.get();
+            }
+
+            // the enumeration is in address order, so nearly every insert is at the end
+            auto i = m_address_map.emplace_hint( m_address_map.end(), address, identity );
+            i->second = identity;
+            identities.emplace_back( ControlIdentityKey( identity ), &i->first );
+
+            if ( index_values )
+            {
+                m_value_index.add( identity, resolveRangedValue( *descriptor, identity, 0, 0, 0 ), descriptor.get() );
+            }
         } );
 
-    m_top_level->updateControlIdentities();
+    // the last address enumerated for an identity wins, as it did when assigning each one in turn
+    std::stable_sort( identities.begin(),
+                      identities.end(),
+                      []( std::pair<ControlIdentityKey, SchemaAddress const *> const &lhs,
+                          std::pair<ControlIdentityKey, SchemaAddress const *> const &rhs )
+                      {
+                          return lhs.first < rhs.first;
+                      } );
+    for ( size_t i = 0; i < identities.size(); ++i )
+    {
+        if ( i + 1 == identities.size() || !( identities[i].first == identities[i + 1].first ) )
+        {
+            m_identity_map.emplace_hint( m_identity_map.end(), identities[i].first, *identities[i].second );
+        }
+    }
+}
 
-    m_top_level->enumerate( [=]( const SchemaAddress &address, DescriptorPtr descriptor, ControlIdentity identity )
-                            {
-                                ControlIdentity descriptor_identity = identity;
-                                descriptor_identity.m_section = ControlIdentity::SectionDescriptorLevel;
-                                descriptor_identity.m_h_pos = 0;
-                                descriptor_identity.m_w_pos = 0;
-                                descriptor_identity.m_item = 0;
-                                m_descriptor_avdecc_map[descriptor_identity] = descriptor;
-                                m_address_map[address] = identity;
-                                m_identity_map[identity] = address;
-                            } );
+void Schema::compileDescriptorIndex()
+{
+    m_descriptor_index.clear();
+    for ( auto const &i : m_descriptor_avdecc_map )
+    {
+        m_descriptor_index.add( i.first, nullptr, i.second.get() );
+    }
+    m_descriptor_index.compile();
 }
 
 const DescriptorPtr Schema::getDescriptor( const ControlIdentity &requested_identity ) const
 {
-    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    requireDescriptors();
+
     ControlIdentity identity = requested_identity;
     identity.m_section = ControlIdentity::SectionDescriptorLevel;
     identity.m_item = 0;
@@ -94,10 +258,10 @@ const DescriptorPtr Schema::getDescriptor( const ControlIdentity &requested_iden
     identity.m_h_pos = 0;
 
     DescriptorPtr r;
-    auto i = m_descriptor_avdecc_map.find( identity );
-    if ( i != m_descriptor_avdecc_map.end() )
+    ControlIdentityIndex::Entry const *e = m_descriptor_index.find( identity );
+    if ( e )
     {
-        r = i->second;
+        r = e->m_descriptor->shared_from_this();
     }
     else
     {
@@ -108,7 +272,8 @@ const DescriptorPtr Schema::getDescriptor( const ControlIdentity &requested_iden
 
 DescriptorPtr Schema::getDescriptor( const ControlIdentity &requested_identity )
 {
-    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    requireDescriptors();
+
     ControlIdentity identity = requested_identity;
     identity.m_section = ControlIdentity::SectionDescriptorLevel;
     identity.m_item = 0;
@@ -116,10 +281,10 @@ DescriptorPtr Schema::getDescriptor( const ControlIdentity &requested_identity )
     identity.m_h_pos = 0;
 
     DescriptorPtr r;
-    auto i = m_descriptor_avdecc_map.find( identity );
-    if ( i != m_descriptor_avdecc_map.end() )
+    ControlIdentityIndex::Entry const *e = m_descriptor_index.find( identity );
+    if ( e )
     {
-        r = i->second;
+        r = e->m_descriptor->shared_from_this();
     }
     else
     {
@@ -130,16 +295,21 @@ DescriptorPtr Schema::getDescriptor( const ControlIdentity &requested_identity )
 
 ControlIdentity Schema::getIdentityForAddress( const SchemaAddress &address ) const
 {
-    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
-
     ControlIdentity r;
-    auto i = m_address_map.find( address );
-    if ( i != m_address_map.end() )
+    if ( !m_address_trie.find( address, &r ) )
     {
-        r = i->second;
+        throw SchemaErrorNoSuchDescriptorForAddress( address );
     }
-    else
+    return r;
+}
+
+ControlIdentity Schema::getIdentityForPath( const std::string &path, char separator ) const
+{
+    ControlIdentity r;
+    if ( !m_address_trie.findPath( path.data(), path.length(), separator, &r ) )
     {
+        SchemaAddress address;
+        Util::split( address, path, std::string( 1, separator ), Util::splitmode::no_empties );
         throw SchemaErrorNoSuchDescriptorForAddress( address );
     }
     return r;
@@ -148,10 +318,36 @@ ControlIdentity Schema::getIdentityForAddress( const SchemaAddress &address ) co
 RangedValueBase const *
     Schema::getRangedValueForControlIdentity( ControlIdentity const &identity, int item_num, int w_pos, int h_pos ) const
 {
-    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    RangedValueBase const *r = 0;
+
+    if ( item_num == 0 && w_pos == 0 && h_pos == 0 )
+    {
+        ControlIdentityIndex::Entry const *e = m_value_index.find( identity );
+        if ( e )
+        {
+            r = e->m_ranged_value;
+        }
+    }
+
+    if ( !r )
+    {
+        r = resolveRangedValueForControlIdentity( identity, item_num, w_pos, h_pos );
+    }
+
+    return r;
+}
+
+RangedValueBase *
+    Schema::resolveRangedValueForControlIdentity( ControlIdentity const &identity, int item_num, int w_pos, int h_pos ) const
+{
+    return resolveRangedValue( *getDescriptor( identity ), identity, item_num, w_pos, h_pos );
+}
 
+RangedValueBase *
+    Schema::resolveRangedValue( Descriptor::DescriptorBase const &descriptor, ControlIdentity const &identity, int item_num, int w_pos, int h_pos )
+{
     RangedValueBase *r = 0;
-    DescriptorPtr d = getDescriptor( identity );
+    Descriptor::DescriptorBase const *d = &descriptor;
 
     switch ( identity.m_section )
     {
@@ -172,8 +368,7 @@ RangedValueBase const *
             {
                 if ( d->getWidth() > w_pos + identity.m_w_pos )
                 {
-                    r = d->getValue( item_num + identity.m_item, w_pos + identity.m_w_pos, h_pos + identity.m_h_pos )
-                            .m_ranged_value;
+                    r = d->getRangedValue( item_num + identity.m_item, w_pos + identity.m_w_pos, h_pos + identity.m_h_pos );
                 }
             }
         }
@@ -208,8 +403,6 @@ RangedValueBase const *
 RangedValueBase *Schema::getRangedValueForControlIdentity(
     ControlIdentityComparatorPtr write_validator, ControlIdentity const &identity, int item_num, int w_pos, int h_pos )
 {
-    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
-
     RangedValueBase *r = 0;
     bool write_access_allowed = true;
 
@@ -221,58 +414,77 @@ RangedValueBase *Schema::getRangedValueForControlIdentity(
         }
     }
 
-    if ( write_access_allowed )
+    if ( write_access_allowed && item_num == 0 && w_pos == 0 && h_pos == 0 )
+    {
+        ControlIdentityIndex::Entry const *e = m_value_index.find( identity );
+        if ( e )
+        {
+            r = e->m_ranged_value;
+        }
+    }
+
+    if ( write_access_allowed && !r )
+    {
+        r = resolveRangedValueForControlIdentity( identity, item_num, w_pos, h_pos );
+    }
+    else if ( !write_access_allowed )
+    {
+        throw SchemaErrorReadOnly( identity );
+    }
+    return r;
+}
+
+size_t Schema::applyBatch( ControlIdentityComparatorPtr write_validator,
+                           Milliseconds current_time_in_milliseconds,
+                           const ControlValueChange *changes,
+                           size_t num_changes )
+{
+    // resolve, check write access and range check everything before writing anything, so that
+    // lock free readers never see a value of a batch which is then rolled back
+    std::vector<RangedValueBase *> targets( num_changes );
+    for ( size_t i = 0; i < num_changes; ++i )
     {
-        DescriptorPtr d = getDescriptor( identity );
+        targets[i] = getRangedValueForControlIdentity( write_validator, changes[i].getIdentity() );
+        if ( !changes[i].validate( *targets[i] ) )
+        {
+            throw std::range_error( formstring( "applyBatch: value out of range: ", changes[i] ) );
+        }
+    }
 
-        switch ( identity.m_section )
+    std::vector<ControlValueChange> previous;
+    previous.reserve( num_changes );
+    ControlIdentitySet changed_items;
+    {
+        std::lock_guard<SharedMutex> lock( m_access_mutex );
+        size_t i = 0;
+        try
         {
-        case ControlIdentity::SectionProperty:
-            r = d->getProperty( item_num ).m_ranged_value;
-            break;
-
-        case ControlIdentity::SectionName:
-            r = d->getName( item_num ).m_ranged_value;
-            ;
-            break;
-
-        case ControlIdentity::SectionDescriptorLevel:
-        case ControlIdentity::SectionWPosLevel:
-        case ControlIdentity::SectionHPosLevel:
-            if ( d->getNumValues() > item_num )
+            for ( ; i < num_changes; ++i )
             {
-                if ( d->getHeight() > h_pos )
+                previous.push_back( ControlValueChange::capture( changes[i].getIdentity(), *targets[i] ) );
+                if ( changes[i].applyTo( *targets[i] ) )
                 {
-                    if ( d->getWidth() > w_pos )
-                    {
-                        r = d->getValue( item_num + identity.m_item, w_pos + identity.m_w_pos, h_pos + identity.m_h_pos )
-                                .m_ranged_value;
-                    }
+                    changed_items.insert( changed_items.end(), changes[i].getIdentity() );
                 }
             }
-            break;
-        default:
-            r = 0;
-            break;
         }
-
-        if ( !r )
+        catch ( ... )
         {
-            if ( d->getNumNames() > 0 )
-            {
-                r = d->getName( 0 ).m_ranged_value;
-                ;
-            }
-            else
+            // only failures which validate() does not predict get here, such as a bool written to an EUI64.
+            // roll back in reverse order so repeated identities end up at their original value
+            while ( i > 0 )
             {
-                throw SchemaErrorNoSuchControlIdentity( identity );
+                --i;
+                previous[i].applyTo( *targets[i], true );
             }
+            throw;
         }
     }
-    else
+
+    if ( !changed_items.empty() )
     {
-        throw SchemaErrorReadOnly( identity );
+        m_change_manager.controlsChanged( current_time_in_milliseconds, changed_items );
     }
-    return r;
+    return changed_items.size();
 }
 }
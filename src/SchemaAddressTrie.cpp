@@ -0,0 +1,240 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/SchemaAddressTrie.hpp"
+
+namespace ControlPlane
+{
+
+void SchemaAddressTrie::clear()
+{
+    m_atom_strings.clear();
+    m_atom_slots.assign( 64, 0 );
+    m_nodes.clear();
+    m_edges.clear();
+
+    // node 0 is the root
+    m_nodes.push_back( ControlIdentityKey() );
+}
+
+void SchemaAddressTrie::reserve( size_t num_addresses )
+{
+    m_nodes.reserve( num_addresses + 1 );
+    m_edges.reserve( num_addresses );
+}
+
+void SchemaAddressTrie::build( const ControlContainer &top )
+{
+    clear();
+    buildNode( 0, top );
+}
+
+void SchemaAddressTrie::buildNode( uint32_t node, const ControlContainer &container )
+{
+    for ( auto const &item : container.getContainerItems() )
+    {
+        buildNode( addChild( node, intern( item.first ) ), *item.second );
+    }
+
+    for ( auto const &item : container.getControlPointItems() )
+    {
+        m_nodes[addChild( node, intern( item.first ) )] = ControlIdentityKey( item.second.second );
+    }
+}
+
+void SchemaAddressTrie::insert( const SchemaAddress &address, const ControlIdentity &identity )
+{
+    uint32_t node = 0;
+    for ( auto const &element : address )
+    {
+        node = addChild( node, intern( element ) );
+    }
+    m_nodes[node] = ControlIdentityKey( identity );
+}
+
+void SchemaAddressTrie::insert( const char *const *path, size_t depth, ControlIdentityKey key )
+{
+    uint32_t node = 0;
+    for ( size_t i = 0; i < depth; ++i )
+    {
+        node = addChild( node, intern( path[i], strlen( path[i] ) ) );
+    }
+    m_nodes[node] = key;
+}
+
+uint32_t SchemaAddressTrie::hashElement( const char *s, size_t length )
+{
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for ( size_t i = 0; i < length; ++i )
+    {
+        h ^= uint8_t( s[i] );
+        h *= 16777619u;
+    }
+    return h;
+}
+
+SchemaAddressTrie::Atom SchemaAddressTrie::findAtom( const char *s, size_t length ) const
+{
+    Atom r = no_atom;
+    size_t mask = m_atom_slots.size() - 1;
+
+    for ( size_t slot = hashElement( s, length ) & mask; m_atom_slots[slot] != 0; slot = ( slot + 1 ) & mask )
+    {
+        Atom candidate = m_atom_slots[slot] - 1;
+        SchemaAddressElement const &candidate_string = m_atom_strings[candidate];
+        if ( candidate_string.length() == length && memcmp( candidate_string.data(), s, length ) == 0 )
+        {
+            r = candidate;
+            break;
+        }
+    }
+    return r;
+}
+
+SchemaAddressTrie::Atom SchemaAddressTrie::intern( const char *s, size_t length )
+{
+    Atom r = findAtom( s, length );
+    if ( r == no_atom )
+    {
+        // keep the load factor at or below one half
+        if ( ( m_atom_strings.size() + 1 ) * 2 > m_atom_slots.size() )
+        {
+            std::vector<uint32_t> slots( m_atom_slots.size() * 2, 0 );
+            size_t mask = slots.size() - 1;
+            for ( Atom a = 0; a < m_atom_strings.size(); ++a )
+            {
+                size_t slot = hashElement( m_atom_strings[a].data(), m_atom_strings[a].length() ) & mask;
+                while ( slots[slot] != 0 )
+                {
+                    slot = ( slot + 1 ) & mask;
+                }
+                slots[slot] = a + 1;
+            }
+            m_atom_slots.swap( slots );
+        }
+
+        r = Atom( m_atom_strings.size() );
+        m_atom_strings.push_back( SchemaAddressElement( s, length ) );
+
+        size_t mask = m_atom_slots.size() - 1;
+        size_t slot = hashElement( s, length ) & mask;
+        while ( m_atom_slots[slot] != 0 )
+        {
+            slot = ( slot + 1 ) & mask;
+        }
+        m_atom_slots[slot] = r + 1;
+    }
+    return r;
+}
+
+uint32_t SchemaAddressTrie::findChild( uint32_t node, Atom atom ) const
+{
+    uint32_t r = no_node;
+    auto i = m_edges.find( edgeKey( node, atom ) );
+    if ( i != m_edges.end() )
+    {
+        r = i->second;
+    }
+    return r;
+}
+
+uint32_t SchemaAddressTrie::addChild( uint32_t node, Atom atom )
+{
+    uint32_t r = findChild( node, atom );
+    if ( r == no_node )
+    {
+        r = uint32_t( m_nodes.size() );
+        m_nodes.push_back( ControlIdentityKey() );
+        m_edges[edgeKey( node, atom )] = r;
+    }
+    return r;
+}
+
+bool SchemaAddressTrie::toAtomPath( const SchemaAddress &address, AtomPath *result ) const
+{
+    bool r = true;
+    result->clear();
+    result->reserve( address.size() );
+    for ( auto const &element : address )
+    {
+        Atom atom = findAtom( element );
+        if ( atom == no_atom )
+        {
+            r = false;
+            break;
+        }
+        result->push_back( atom );
+    }
+    return r;
+}
+
+bool SchemaAddressTrie::find( const SchemaAddress &address, ControlIdentity *identity ) const
+{
+    uint32_t node = 0;
+    for ( auto const &element : address )
+    {
+        Atom atom = findAtom( element );
+        node = atom == no_atom ? no_node : findChild( node, atom );
+        if ( node == no_node )
+        {
+            break;
+        }
+    }
+
+    bool r = false;
+    if ( node != no_node && m_nodes[node].isValid() )
+    {
+        *identity = m_nodes[node].toIdentity();
+        r = true;
+    }
+    return r;
+}
+
+bool SchemaAddressTrie::find( const AtomPath &path, ControlIdentity *identity ) const
+{
+    uint32_t node = 0;
+    for ( Atom atom : path )
+    {
+        node = findChild( node, atom );
+        if ( node == no_node )
+        {
+            break;
+        }
+    }
+
+    bool r = false;
+    if ( node != no_node && m_nodes[node].isValid() )
+    {
+        *identity = m_nodes[node].toIdentity();
+        r = true;
+    }
+    return r;
+}
+
+bool SchemaAddressTrie::findPath( const char *path, size_t length, char separator, ControlIdentity *identity ) const
+{
+    uint32_t node = 0;
+    size_t pos = 0;
+
+    while ( node != no_node && pos < length )
+    {
+        const char *element = path + pos;
+        const char *end = static_cast<const char *>( memchr( element, separator, length - pos ) );
+        size_t element_length = end ? size_t( end - element ) : length - pos;
+
+        if ( element_length > 0 )
+        {
+            Atom atom = findAtom( element, element_length );
+            node = atom == no_atom ? no_node : findChild( node, atom );
+        }
+        pos += element_length + 1;
+    }
+
+    bool r = false;
+    if ( node != no_node && node != 0 && m_nodes[node].isValid() )
+    {
+        *identity = m_nodes[node].toIdentity();
+        r = true;
+    }
+    return r;
+}
+}
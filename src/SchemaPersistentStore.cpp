@@ -0,0 +1,532 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/SchemaPersistentStore.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ControlPlane
+{
+
+namespace
+{
+
+const uint32_t native_byte_order = 0x01020304;
+
+void hashBytes( uint64_t &h, const void *p, size_t length )
+{
+    // FNV-1a
+    uint8_t const *b = static_cast<uint8_t const *>( p );
+    for ( size_t i = 0; i < length; ++i )
+    {
+        h ^= b[i];
+        h *= 1099511628211ull;
+    }
+}
+
+template <typename T>
+void hashValue( uint64_t &h, T v )
+{
+    hashBytes( h, &v, sizeof( v ) );
+}
+
+bool readWholeFile( std::string const &path, std::vector<uint8_t> &contents )
+{
+    bool r = false;
+    FILE *f = fopen( path.c_str(), "rb" );
+    if ( f )
+    {
+        uint8_t buf[65536];
+        size_t n;
+        while ( ( n = fread( buf, 1, sizeof( buf ), f ) ) > 0 )
+        {
+            contents.insert( contents.end(), buf, buf + n );
+        }
+        r = ferror( f ) == 0;
+        fclose( f );
+    }
+    return r;
+}
+
+bool readFileHeader( std::string const &path, void *header, size_t header_size, size_t &file_size )
+{
+    bool r = false;
+    FILE *f = fopen( path.c_str(), "rb" );
+    if ( f )
+    {
+        if ( fread( header, 1, header_size, f ) == header_size && fseek( f, 0, SEEK_END ) == 0 )
+        {
+            long size = ftell( f );
+            if ( size >= 0 )
+            {
+                file_size = size_t( size );
+                r = true;
+            }
+        }
+        fclose( f );
+    }
+    return r;
+}
+}
+
+SchemaPersistentStore::SchemaPersistentStore( Schema &schema, const std::string &path, Milliseconds sync_period )
+    : ChangeNotifier( Milliseconds( 0 ) )
+    , m_schema( schema )
+    , m_path( path )
+    , m_sync_period( sync_period )
+    , m_last_sync_time( 0 )
+    , m_schema_hash( 0 )
+    , m_file_size( 0 )
+#ifdef _WIN32
+    , m_file( INVALID_HANDLE_VALUE )
+    , m_mapping( NULL )
+#else
+    , m_fd( -1 )
+#endif
+    , m_map( nullptr )
+    , m_page_size( 4096 )
+    , m_first_dirty_page( 0 )
+    , m_last_dirty_page( 0 )
+    , m_last_sync_range_count( 0 )
+{
+#ifndef _WIN32
+    m_page_size = size_t( sysconf( _SC_PAGESIZE ) );
+#endif
+}
+
+SchemaPersistentStore::~SchemaPersistentStore()
+{
+    close();
+}
+
+size_t SchemaPersistentStore::getSlotCapacity( EncodingType t )
+{
+    // numeric values are stored as 64 bits, strings are padded to a multiple of 8 bytes
+    size_t r = 8;
+    if ( isEncodingTypeString( t ) )
+    {
+        r = ( getEncodingTypeSize( t ) + 7 ) & ~size_t( 7 );
+    }
+    return r;
+}
+
+uint64_t SchemaPersistentStore::computeSchemaHash( const Schema &schema )
+{
+    uint64_t h = 14695981039346656037ull;
+    hashValue( h, version );
+    for ( auto const &e : schema.getValueIndex().getEntries() )
+    {
+        RangedValueBase const &v = *e.m_ranged_value;
+        hashValue( h, e.m_key.getValue() );
+        hashValue( h, uint8_t( v.getEncodingType() ) );
+        hashValue( h, v.getEncodingMultiplierPower() );
+        hashValue( h, v.getEncodedMinValue() );
+        hashValue( h, v.getEncodedMaxValue() );
+    }
+    return h;
+}
+
+void SchemaPersistentStore::computeLayout()
+{
+    ControlIdentityIndex::Entries const entries = m_schema.getValueIndex().getEntries();
+    m_slot_offsets.resize( entries.size() );
+
+    size_t offset = sizeof( FileHeader );
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        m_slot_offsets[i] = offset;
+        offset += sizeof( SlotHeader ) + getSlotCapacity( entries[i].m_ranged_value->getEncodingType() );
+    }
+    m_file_size = offset;
+    m_schema_hash = computeSchemaHash( m_schema );
+}
+
+SchemaPersistentStore::OpenResult SchemaPersistentStore::open( Milliseconds current_time_in_milliseconds )
+{
+    OpenResult r = OpenResult::Created;
+    ControlIdentitySet changed_items;
+    {
+        std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+        close();
+        computeLayout();
+
+        FileHeader header;
+        size_t file_size = 0;
+        if ( readFileHeader( m_path, &header, sizeof( header ), file_size ) )
+        {
+            if ( header.m_schema_hash == m_schema_hash && header.m_num_slots == m_slot_offsets.size()
+                 && header.m_file_size == m_file_size && file_size == m_file_size && header.m_version == version
+                 && header.m_byte_order == native_byte_order && memcmp( header.m_magic, "CPPS", 4 ) == 0 )
+            {
+                // same layout, so map the file as it is and load from it directly
+                mapFile( m_path );
+                loadSlots(
+                    m_map + sizeof( FileHeader ), m_file_size - sizeof( FileHeader ), m_slot_offsets.size(), changed_items );
+                r = OpenResult::Loaded;
+            }
+            else
+            {
+                std::vector<uint8_t> contents;
+                if ( readWholeFile( m_path, contents ) && contents.size() >= sizeof( FileHeader )
+                     && loadExisting( contents, changed_items ) )
+                {
+                    r = OpenResult::Migrated;
+                }
+            }
+        }
+
+        if ( r != OpenResult::Loaded )
+        {
+            createFile();
+        }
+
+        m_last_sync_time = current_time_in_milliseconds;
+    }
+
+    // notify without the store lock, as ChangeNotifierManager::tick() takes its own lock and then calls tick() here
+    if ( !changed_items.empty() )
+    {
+        m_schema.getChangeManager().controlsChanged( current_time_in_milliseconds, changed_items );
+    }
+    return r;
+}
+
+bool SchemaPersistentStore::loadExisting( const std::vector<uint8_t> &contents, ControlIdentitySet &changed_items )
+{
+    bool r = false;
+    FileHeader header;
+    memcpy( &header, contents.data(), sizeof( header ) );
+
+    if ( memcmp( header.m_magic, "CPPS", 4 ) == 0 && header.m_byte_order == native_byte_order
+         && header.m_version == version && header.m_file_size == contents.size() )
+    {
+        loadSlots( contents.data() + sizeof( FileHeader ), contents.size() - sizeof( FileHeader ), header.m_num_slots, changed_items );
+        r = true;
+    }
+    return r;
+}
+
+void SchemaPersistentStore::loadSlots( uint8_t const *slots,
+                                       size_t slots_size,
+                                       size_t num_slots,
+                                       ControlIdentitySet &changed_items )
+{
+    ControlIdentityIndex::Entries const entries = m_schema.getValueIndex().getEntries();
+    auto entry = entries.begin();
+
+    std::lock_guard<SharedMutex> lock( m_schema.getMutex() );
+    size_t pos = 0;
+    for ( size_t slot = 0; slot < num_slots && pos + sizeof( SlotHeader ) <= slots_size; ++slot )
+    {
+        SlotHeader header;
+        memcpy( &header, slots + pos, sizeof( header ) );
+        uint8_t const *payload = slots + pos + sizeof( SlotHeader );
+        pos += sizeof( SlotHeader ) + header.m_capacity;
+        if ( pos > slots_size )
+        {
+            break;
+        }
+
+        // the slots and the value index are both in key order, so walk them together
+        ControlIdentityKey key = ControlIdentityKey::fromValue( header.m_key );
+        while ( entry != entries.end() && entry->m_key < key )
+        {
+            ++entry;
+        }
+        if ( entry == entries.end() || !( entry->m_key == key ) )
+        {
+            continue;
+        }
+
+        RangedValueBase &v = *entry->m_ranged_value;
+        EncodingType t = EncodingType( header.m_encoding_type );
+        if ( v.isReadOnly() || v.getEncodingType() != t || v.getEncodingMultiplierPower() != header.m_multiplier_power )
+        {
+            continue;
+        }
+
+        bool changed = false;
+        if ( isEncodingTypeString( t ) )
+        {
+            string s( reinterpret_cast<const char *>( payload ), std::min( size_t( header.m_length ), size_t( header.m_capacity ) ) );
+            changed = v.setUnencodedValueString( s );
+        }
+        else
+        {
+            uint64_t bits;
+            memcpy( &bits, payload, sizeof( bits ) );
+            changed = v.setFromEncodedValueBitsWithClamp( bits );
+        }
+
+        if ( changed )
+        {
+            changed_items.insert( changed_items.end(), key );
+        }
+    }
+}
+
+void SchemaPersistentStore::createFile()
+{
+    // build the new file beside the old one, which stays intact until the rename replaces it
+    std::string temp_path = m_path + ".tmp";
+#ifdef _WIN32
+    DeleteFileA( temp_path.c_str() );
+#else
+    unlink( temp_path.c_str() );
+#endif
+    mapFile( temp_path );
+
+    {
+        SharedLockGuard lock( m_schema.getMutex() );
+        for ( size_t i = 0; i < m_slot_offsets.size(); ++i )
+        {
+            writeSlot( i );
+        }
+    }
+    sync( true );
+
+    // the header is written last, so a file left by a crash before this point never passes the header check in open()
+    FileHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.m_magic, "CPPS", 4 );
+    header.m_byte_order = native_byte_order;
+    header.m_version = version;
+    header.m_num_slots = uint32_t( m_slot_offsets.size() );
+    header.m_schema_hash = m_schema_hash;
+    header.m_file_size = m_file_size;
+    memcpy( m_map, &header, sizeof( header ) );
+    markDirty( 0, sizeof( header ) );
+    sync( true );
+    unmapFile();
+
+#ifdef _WIN32
+    bool renamed = MoveFileExA( temp_path.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != 0;
+#else
+    bool renamed = rename( temp_path.c_str(), m_path.c_str() ) == 0;
+#endif
+    if ( !renamed )
+    {
+        throw SchemaErrorPersistentStore( Util::formstring( "unable to replace ", m_path, " with ", temp_path ) );
+    }
+    mapFile( m_path );
+}
+
+void SchemaPersistentStore::mapFile( std::string const &path )
+{
+#ifdef _WIN32
+    m_file = CreateFileA(
+        path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+    if ( m_file == INVALID_HANDLE_VALUE )
+    {
+        throw SchemaErrorPersistentStore( Util::formstring( "unable to open ", path ) );
+    }
+    LARGE_INTEGER size;
+    size.QuadPart = LONGLONG( m_file_size );
+    m_mapping = CreateFileMappingA( m_file, NULL, PAGE_READWRITE, size.HighPart, size.LowPart, NULL );
+    if ( m_mapping != NULL )
+    {
+        m_map = static_cast<uint8_t *>( MapViewOfFile( m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_file_size ) );
+    }
+#else
+    m_fd = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+    if ( m_fd < 0 )
+    {
+        throw SchemaErrorPersistentStore( Util::formstring( "unable to open ", path, ": ", strerror( errno ) ) );
+    }
+    if ( ftruncate( m_fd, off_t( m_file_size ) ) == 0 )
+    {
+        void *p = mmap( nullptr, m_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+        if ( p != MAP_FAILED )
+        {
+            m_map = static_cast<uint8_t *>( p );
+        }
+    }
+#endif
+    if ( !m_map )
+    {
+        unmapFile();
+        throw SchemaErrorPersistentStore( Util::formstring( "unable to map ", path ) );
+    }
+
+    m_dirty_pages.assign( ( m_file_size + m_page_size - 1 ) / m_page_size, false );
+    m_first_dirty_page = m_dirty_pages.size();
+    m_last_dirty_page = 0;
+}
+
+void SchemaPersistentStore::unmapFile()
+{
+#ifdef _WIN32
+    if ( m_map )
+    {
+        UnmapViewOfFile( m_map );
+    }
+    if ( m_mapping != NULL )
+    {
+        CloseHandle( m_mapping );
+        m_mapping = NULL;
+    }
+    if ( m_file != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle( m_file );
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if ( m_map )
+    {
+        munmap( m_map, m_file_size );
+    }
+    if ( m_fd >= 0 )
+    {
+        ::close( m_fd );
+        m_fd = -1;
+    }
+#endif
+    m_map = nullptr;
+}
+
+void SchemaPersistentStore::close()
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_map )
+    {
+        sync( true );
+    }
+    unmapFile();
+}
+
+void SchemaPersistentStore::writeSlot( size_t ordinal )
+{
+    ControlIdentityIndex::Entry const &e = m_schema.getValueIndex().getEntries()[ordinal];
+    RangedValueBase const &v = *e.m_ranged_value;
+    EncodingType t = v.getEncodingType();
+    size_t capacity = getSlotCapacity( t );
+
+    SlotHeader header;
+    header.m_key = e.m_key.getValue();
+    header.m_encoding_type = uint8_t( t );
+    header.m_multiplier_power = v.getEncodingMultiplierPower();
+    header.m_length = 0;
+    header.m_capacity = uint32_t( capacity );
+
+    uint8_t *slot = m_map + m_slot_offsets[ordinal];
+    uint8_t *payload = slot + sizeof( SlotHeader );
+    if ( isEncodingTypeString( t ) )
+    {
+        string s = v.getUnencodedValueString( false );
+        header.m_length = uint16_t( std::min( s.length(), capacity ) );
+        memcpy( payload, s.data(), header.m_length );
+    }
+    else
+    {
+        uint64_t bits = v.getEncodedValueBits();
+        memcpy( payload, &bits, sizeof( bits ) );
+    }
+    memcpy( slot, &header, sizeof( header ) );
+
+    markDirty( m_slot_offsets[ordinal], sizeof( SlotHeader ) + capacity );
+}
+
+void SchemaPersistentStore::writeSlotForIdentity( ControlIdentityKey key )
+{
+    ControlIdentityIndex const &index = m_schema.getValueIndex();
+    ControlIdentityIndex::Entry const *e = index.find( key );
+    if ( e )
+    {
+        writeSlot( size_t( e - index.getEntries().data() ) );
+    }
+}
+
+void SchemaPersistentStore::markDirty( size_t offset, size_t length )
+{
+    size_t first = offset / m_page_size;
+    size_t last = ( offset + length - 1 ) / m_page_size;
+    for ( size_t page = first; page <= last; ++page )
+    {
+        m_dirty_pages[page] = true;
+    }
+    m_first_dirty_page = std::min( m_first_dirty_page, first );
+    m_last_dirty_page = std::max( m_last_dirty_page, last );
+}
+
+void SchemaPersistentStore::sync( bool wait )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    m_last_sync_range_count = 0;
+    if ( m_map && m_first_dirty_page <= m_last_dirty_page )
+    {
+        size_t page = m_first_dirty_page;
+        while ( page <= m_last_dirty_page )
+        {
+            if ( m_dirty_pages[page] )
+            {
+                // coalesce the run of adjacent dirty pages into one flush
+                size_t end = page;
+                while ( end <= m_last_dirty_page && m_dirty_pages[end] )
+                {
+                    m_dirty_pages[end] = false;
+                    ++end;
+                }
+                size_t offset = page * m_page_size;
+                size_t length = std::min( end * m_page_size, m_file_size ) - offset;
+#ifdef _WIN32
+                FlushViewOfFile( m_map + offset, length );
+#else
+                msync( m_map + offset, length, wait ? MS_SYNC : MS_ASYNC );
+#endif
+                ++m_last_sync_range_count;
+                page = end;
+            }
+            else
+            {
+                ++page;
+            }
+        }
+        m_first_dirty_page = m_dirty_pages.size();
+        m_last_dirty_page = 0;
+#ifdef _WIN32
+        if ( wait )
+        {
+            FlushFileBuffers( m_file );
+        }
+#endif
+    }
+}
+
+void SchemaPersistentStore::controlChanged( Milliseconds current_timestamp_in_milliseconds, ControlIdentity control_identity )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_map )
+    {
+        SharedLockGuard schema_lock( m_schema.getMutex() );
+        writeSlotForIdentity( ControlIdentityKey( control_identity ) );
+    }
+}
+
+void SchemaPersistentStore::controlsChanged( Milliseconds current_timestamp_in_milliseconds, const ControlIdentitySet &items )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_map )
+    {
+        SharedLockGuard schema_lock( m_schema.getMutex() );
+        for ( auto const &i : items )
+        {
+            writeSlotForIdentity( i );
+        }
+    }
+}
+
+void SchemaPersistentStore::tick( Milliseconds current_timestamp_in_milliseconds )
+{
+    std::lock_guard<std::recursive_mutex> lock( m_access_mutex );
+    if ( m_map && m_first_dirty_page <= m_last_dirty_page
+         && current_timestamp_in_milliseconds - m_last_sync_time >= m_sync_period )
+    {
+        // called with the manager's lock held, so only start the write back rather than wait for the disk
+        sync();
+        m_last_sync_time = current_timestamp_in_milliseconds;
+    }
+}
+}
@@ -0,0 +1,205 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/SchemaSnapshot.hpp"
+
+namespace ControlPlane
+{
+
+namespace
+{
+
+void put( std::vector<uint8_t> &blob, uint64_t v, size_t size )
+{
+    for ( size_t i = size; i > 0; --i )
+    {
+        blob.push_back( uint8_t( v >> ( ( i - 1 ) * 8 ) ) );
+    }
+}
+
+uint64_t get( uint8_t const *p, size_t size )
+{
+    uint64_t r = 0;
+    for ( size_t i = 0; i < size; ++i )
+    {
+        r = ( r << 8 ) | p[i];
+    }
+    return r;
+}
+}
+
+SchemaSnapshot::SchemaSnapshot( std::vector<uint8_t> blob ) : m_blob( std::move( blob ) ), m_num_items( 0 )
+{
+    validate();
+    m_num_items = size_t( get( m_blob.data() + 5, 4 ) );
+}
+
+void SchemaSnapshot::validate() const
+{
+    if ( m_blob.size() < header_size || memcmp( m_blob.data(), "CPSS", 4 ) != 0 )
+    {
+        throw SchemaErrorSnapshot( "bad header" );
+    }
+    if ( m_blob[4] != version )
+    {
+        throw SchemaErrorSnapshot( Util::formstring( "unsupported version ", int( m_blob[4] ) ) );
+    }
+
+    size_t num_items = size_t( get( m_blob.data() + 5, 4 ) );
+    size_t pos = header_size;
+    uint64_t previous_key = 0;
+    for ( size_t item = 0; item < num_items; ++item )
+    {
+        if ( pos + 9 > m_blob.size() )
+        {
+            throw SchemaErrorSnapshot( "truncated" );
+        }
+        uint64_t key = get( &m_blob[pos], 8 );
+        EncodingType t = EncodingType( m_blob[pos + 8] );
+        pos += 9;
+
+        if ( item > 0 && key <= previous_key )
+        {
+            throw SchemaErrorSnapshot( "items out of order" );
+        }
+        previous_key = key;
+
+        size_t size = getEncodingTypeSize( t );
+        if ( isEncodingTypeString( t ) )
+        {
+            if ( pos + 2 > m_blob.size() )
+            {
+                throw SchemaErrorSnapshot( "truncated" );
+            }
+            size = 2 + size_t( get( &m_blob[pos], 2 ) );
+        }
+        else if ( size == 0 )
+        {
+            throw SchemaErrorSnapshot( "bad encoding type" );
+        }
+
+        if ( pos + size > m_blob.size() )
+        {
+            throw SchemaErrorSnapshot( "truncated" );
+        }
+        pos += size;
+    }
+
+    if ( pos != m_blob.size() )
+    {
+        throw SchemaErrorSnapshot( "trailing data" );
+    }
+}
+
+SchemaSnapshot SchemaSnapshot::capture( const Schema &schema, ControlIdentityComparatorPtr selection )
+{
+    SchemaSnapshot r;
+    std::vector<uint8_t> &blob = r.m_blob;
+    ControlIdentityIndex::Entries const entries = schema.getValueIndex().getEntries();
+
+    blob.reserve( header_size + entries.size() * 13 );
+    blob.insert( blob.end(), {'C', 'P', 'S', 'S', version} );
+    put( blob, 0, 4 );
+
+    SharedLockGuard lock( schema.getMutex() );
+    for ( auto const &e : entries )
+    {
+        if ( selection && !selection->containsControl( e.m_key.toIdentity() ) )
+        {
+            continue;
+        }
+
+        RangedValueBase const &v = *e.m_ranged_value;
+        EncodingType t = v.getEncodingType();
+        put( blob, e.m_key.getValue(), 8 );
+        blob.push_back( uint8_t( t ) );
+
+        if ( isEncodingTypeString( t ) )
+        {
+            string s = v.getUnencodedValueString( false );
+            size_t length = std::min( s.length(), size_t( 0xffff ) );
+            put( blob, length, 2 );
+            blob.insert( blob.end(), s.begin(), s.begin() + length );
+        }
+        else
+        {
+            put( blob, v.getEncodedValueBits(), getEncodingTypeSize( t ) );
+        }
+        ++r.m_num_items;
+    }
+
+    blob[5] = uint8_t( r.m_num_items >> 24 );
+    blob[6] = uint8_t( r.m_num_items >> 16 );
+    blob[7] = uint8_t( r.m_num_items >> 8 );
+    blob[8] = uint8_t( r.m_num_items );
+    return r;
+}
+
+size_t SchemaSnapshot::restore( Schema &schema,
+                                ControlIdentityComparatorPtr write_validator,
+                                Milliseconds current_time_in_milliseconds ) const
+{
+    ControlIdentitySet changed_items;
+    ControlIdentityIndex::Entries const entries = schema.getValueIndex().getEntries();
+    auto entry = entries.begin();
+
+    {
+        std::lock_guard<SharedMutex> lock( schema.getMutex() );
+        size_t pos = header_size;
+        for ( size_t item = 0; item < m_num_items; ++item )
+        {
+            ControlIdentityKey key = ControlIdentityKey::fromValue( get( &m_blob[pos], 8 ) );
+            EncodingType t = EncodingType( m_blob[pos + 8] );
+            pos += 9;
+
+            uint8_t const *value = &m_blob[pos];
+            size_t size = isEncodingTypeString( t ) ? 2 + size_t( get( value, 2 ) ) : getEncodingTypeSize( t );
+            pos += size;
+
+            // both the snapshot and the value index are in key order, so walk them together
+            while ( entry != entries.end() && entry->m_key < key )
+            {
+                ++entry;
+            }
+            if ( entry == entries.end() || !( entry->m_key == key ) )
+            {
+                continue;
+            }
+
+            RangedValueBase &v = *entry->m_ranged_value;
+            if ( v.isReadOnly() || v.getEncodingType() != t
+                 || ( write_validator && write_validator->containsControl( key.toIdentity() ) ) )
+            {
+                continue;
+            }
+
+            bool changed = false;
+            if ( isEncodingTypeString( t ) )
+            {
+                string s( reinterpret_cast<const char *>( value + 2 ), size - 2 );
+                if ( s != v.getUnencodedValueString( false ) )
+                {
+                    changed = v.setUnencodedValueString( s );
+                }
+            }
+            else
+            {
+                uint64_t bits = get( value, size );
+                if ( bits != v.getEncodedValueBits() )
+                {
+                    changed = v.setFromEncodedValueBitsWithClamp( bits );
+                }
+            }
+
+            if ( changed )
+            {
+                changed_items.insert( changed_items.end(), key );
+            }
+        }
+    }
+
+    if ( !changed_items.empty() )
+    {
+        schema.getChangeManager().controlsChanged( current_time_in_milliseconds, changed_items );
+    }
+    return changed_items.size();
+}
+}
@@ -0,0 +1,7 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/SharedMutex.hpp"
+
+namespace ControlPlane
+{
+const char *SharedMutex_file = __FILE__;
+}
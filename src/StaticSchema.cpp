@@ -0,0 +1,7 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/StaticSchema.hpp"
+
+namespace ControlPlane
+{
+const char *StaticSchema_file = __FILE__;
+}
@@ -242,6 +242,33 @@ void TextProtocolSession::handleOtherCommands( Milliseconds current_time_in_mill
         {
             std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
         }
+        else if ( params[0] == "seq" )
+        {
+            m_io.sendLine( formstring( ":seq ", m_schema.getChangeManager().getJournal().getSequence() ) );
+        }
+        else if ( params[0] == "stats" )
+        {
+            ChangeNotifierManager &manager = m_schema.getChangeManager();
+            if ( params.size() > 1 && params[1] == "on" )
+            {
+                manager.setStatsEnabled( true );
+            }
+            else if ( params.size() > 1 && params[1] == "off" )
+            {
+                manager.setStatsEnabled( false );
+            }
+            else if ( params.size() > 1 && params[1] == "reset" )
+            {
+                manager.resetStats();
+            }
+            m_io.sendLine( formstring( ":stats ", manager.isStatsEnabled() ? "on " : "off ", manager.getStats() ) );
+        }
+        else if ( params[0] == "resume" && params.size() > 1 )
+        {
+            uint64_t sequence;
+            lexical_cast( sequence, params[1] );
+            handleResume( current_time_in_milliseconds, sequence );
+        }
         else
         {
             throw( std::runtime_error( "Bad command: " + params[0] ) );
@@ -249,11 +276,37 @@ void TextProtocolSession::handleOtherCommands( Milliseconds current_time_in_mill
     }
 }
 
+void TextProtocolSession::handleResume( Milliseconds current_time_in_milliseconds, uint64_t sequence )
+{
+    std::vector<ChangeJournal::Entry> entries;
+    uint64_t last_sequence;
+
+    if ( m_schema.getChangeManager().getJournal().readSince( sequence, entries, last_sequence ) )
+    {
+        for ( auto const &e : entries )
+        {
+            auto i = m_schema.getIdentityMap().find( e.m_key );
+            if ( i != m_schema.getIdentityMap().end() )
+            {
+                handleIndividualGet( current_time_in_milliseconds, i->second );
+            }
+        }
+        m_io.sendLine( formstring( ":seq ", last_sequence ) );
+    }
+    else
+    {
+        // the changes since sequence are no longer journaled, so the client has to read everything again
+        m_io.sendLine( formstring( ":resync ", last_sequence ) );
+    }
+}
+
 void TextProtocolSession::handleIndividualGet( Milliseconds current_time_in_milliseconds, const TextAddress &address )
 {
     string r;
     m_schema.getValue( &r, address );
-    m_io.sendLine( formstring( address, "='", Util::escapeString( r ), "'" ) );
+    string line( address.m_value );
+    line.append( "='" ).append( Util::escapeString( r ) ).append( "'" );
+    m_io.sendLine( line );
 }
 
 void TextProtocolSession::handleIndividualSet( Milliseconds current_time_in_milliseconds,
@@ -275,78 +328,87 @@ void TextProtocolSession::handleIndividualSet( Milliseconds current_time_in_mill
 
 void TextProtocolSession::handleIndividualDescribe( Milliseconds current_time_in_milliseconds, const TextAddress &address )
 {
-    std::lock_guard<std::recursive_mutex> lock( m_schema.getTarget().getMutex() );
+    // the response is built under the schema lock and sent after it is released, so a slow client does not hold it
+    string response;
+    {
+        SharedLockGuard lock( m_schema.getTarget().getMutex() );
 
-    ControlIdentity identity;
+        ControlIdentity identity;
 
-    m_schema.lookupIdentityForAddress( identity, address );
+        m_schema.lookupIdentityForAddress( identity, address );
 
-    std::stringstream response;
-    response << formstring( "?{'", escapeString( address.m_value ), "'" );
-    response << ": { ";
+        response.append( "?{'" ).append( escapeString( address.m_value ) ).append( "': { " );
 
-    if ( identity.m_section == ControlIdentity::SectionDescriptorLevel
-         || identity.m_section == ControlIdentity::SectionWPosLevel )
-    {
-        DescriptorPtr d = m_schema.getTarget().getDescriptor( identity );
+        if ( identity.m_section == ControlIdentity::SectionDescriptorLevel
+             || identity.m_section == ControlIdentity::SectionWPosLevel )
+        {
+            DescriptorPtr d = m_schema.getTarget().getDescriptor( identity );
 
-        response << "'control_type' : '0x" << std::hex << d->getAvdeccControlType() << std::dec << "', ";
-        response << "'control_value_type' : '" << d->getAvdeccControlValueType() << "', ";
+            char buf[max_number_length];
+            response.append( "'control_type' : '0x" )
+                .append( buf, formatHex( buf, d->getAvdeccControlType() ) )
+                .append( "', " );
+            appendNumber( response.append( "'control_value_type' : '" ), d->getAvdeccControlValueType() ).append( "', " );
 
-        DescriptorString *object_name = d->getObjectName();
-        if ( object_name )
-        {
-            response << "'object_name' : '" << escapeString( object_name->getValue() ) << "', ";
-        }
-        response << "'description' : '" << escapeString( d->getDescription() ) << "', ";
-        response << "'read_only' : ";
+            DescriptorString *object_name = d->getObjectName();
+            if ( object_name )
+            {
+                response.append( "'object_name' : '" ).append( escapeString( object_name->getValue() ) ).append( "', " );
+            }
+            response.append( "'description' : '" ).append( escapeString( d->getDescription() ) ).append( "', " );
+            response.append( "'read_only' : " );
 
-        bool ro = false;
+            bool ro = false;
 
-        ro = m_write_access->containsControl( identity );
+            ro = m_write_access->containsControl( identity );
 
-        if ( !ro )
-        {
-            for ( size_t item = 0; item < d->getNumValues(); ++item )
+            if ( !ro )
             {
-                if ( d->getValue( item ).m_ranged_value->isReadOnly() )
+                for ( size_t item = 0; item < d->getNumValues(); ++item )
                 {
-                    ro = true;
-                    break;
+                    if ( d->getRangedValue( item )->isReadOnly() )
+                    {
+                        ro = true;
+                        break;
+                    }
                 }
             }
-        }
 
-        if ( ro )
-        {
-            response << "'true'";
+            if ( ro )
+            {
+                response.append( "'true'" );
+            }
+            else
+            {
+                response.append( "'false'" );
+            }
+            if ( d->getNumValues() > 0 )
+            {
+                response.append( ", " );
+                response.append( "'item' : { " );
+                ControlValue v = d->getValue( identity.m_item );
+
+                response.append( describeRangedValue( v.m_name, *v.m_ranged_value ) );
+                response.append( "}" );
+            }
         }
-        else
+        else if ( identity.m_section == ControlIdentity::SectionName )
         {
-            response << "'false'";
+            const RangedValueBase *v = m_schema.getTarget().getRangedValueForControlIdentity( identity );
+            string name( "name_" );
+            appendNumber( name, identity.m_item + 1 );
+            response.append( describeRangedValue( name, *v ) );
         }
-        if ( d->getNumValues() > 0 )
+        else
         {
-            response << ", ";
-            response << "'item' : { ";
-            ControlValue const &v = d->getValue( identity.m_item );
-
-            response << describeRangedValue( v.m_name, *v.m_ranged_value );
-            response << "}";
+            const RangedValueBase *v = m_schema.getTarget().getRangedValueForControlIdentity( identity );
+            string name( "item_" );
+            appendNumber( appendNumber( name, identity.m_h_pos + 1 ).append( "_" ), identity.m_w_pos + 1 );
+            response.append( describeRangedValue( name, *v ) );
         }
+        response.append( "}}" );
     }
-    else if ( identity.m_section == ControlIdentity::SectionName )
-    {
-        const RangedValueBase *v = m_schema.getTarget().getRangedValueForControlIdentity( identity );
-        response << describeRangedValue( formstring( "name_", identity.m_item + 1 ), *v );
-    }
-    else
-    {
-        const RangedValueBase *v = m_schema.getTarget().getRangedValueForControlIdentity( identity );
-        response << describeRangedValue( formstring( "item_", identity.m_h_pos + 1, "_", identity.m_w_pos + 1 ), *v );
-    }
-    response << "}}";
-    m_io.sendLine( response.str() );
+    m_io.sendLine( response );
 }
 
 void TextProtocolSession::handleIndividualSubscribe( Milliseconds current_time_in_milliseconds,
@@ -377,25 +439,18 @@ string TextProtocolSession::describeRangedValue( const std::string &name, const
     string response;
     if ( v.getStorageType() == EncodingType::ENCODING_STRING64 || v.getStorageType() == EncodingType::ENCODING_STRING406 )
     {
-        response = formstring( "'value' : '", escapeString( v.getUnencodedValueString( false ) ), "'" );
+        response.append( "'value' : '" ).append( escapeString( v.getUnencodedValueString( false ) ) ).append( "'" );
     }
     else
     {
-        response = formstring( " 'name' : '",
-                               escapeString( name ),
-                               "', 'value' : '",
-                               escapeString( v.getUnencodedValueString( false ) ),
-                               "', 'minimum' : '",
-                               escapeString( v.getUnencodedMinimumString( false ) ),
-                               "', 'maximum' : '",
-                               escapeString( v.getUnencodedMaximumString( false ) ),
-                               "', 'default' : '",
-                               escapeString( v.getUnencodedDefaultString( false ) ),
-                               "', 'step' : '",
-                               escapeString( v.getUnencodedStepString( false ) ),
-                               "', 'units' : '",
-                               escapeString( v.getUnitsSuffix() ),
-                               "'" );
+        response.reserve( 160 + name.size() );
+        response.append( " 'name' : '" ).append( escapeString( name ) );
+        response.append( "', 'value' : '" ).append( escapeString( v.getUnencodedValueString( false ) ) );
+        response.append( "', 'minimum' : '" ).append( escapeString( v.getUnencodedMinimumString( false ) ) );
+        response.append( "', 'maximum' : '" ).append( escapeString( v.getUnencodedMaximumString( false ) ) );
+        response.append( "', 'default' : '" ).append( escapeString( v.getUnencodedDefaultString( false ) ) );
+        response.append( "', 'step' : '" ).append( escapeString( v.getUnencodedStepString( false ) ) );
+        response.append( "', 'units' : '" ).append( escapeString( v.getUnitsSuffix() ) ).append( "'" );
     }
     return response;
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Shared fixture for the Schema tests: 16 input channels with a gain and
+/// a mute each, a 3 x 4 gain matrix at "matrix", and a peak meter per
+/// channel at "meter"
+///
+struct ChannelProcessing
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct TestProcessing
+{
+    std::array<ChannelProcessing, 16> m_input;
+    std::array<std::array<Gain, 4>, 3> m_matrix;
+    std::array<VuMeterDbFsPeak, 16> m_meter;
+    Descriptor::EntityInfo m_entity;
+};
+
+class TestSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    TestProcessing *m_processing;
+
+  public:
+    TestSchemaGenerator( ControlContainerPtr root, TestProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Test Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_input = m_root->addItem( "input" );
+        for ( size_t chan = 0; chan < m_processing->m_input.size(); ++chan )
+        {
+            ControlContainerPtr schema_chan = schema_input->addItem( formstring( chan + 1 ) );
+            Descriptor::ControlPtr gain = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_GAIN,
+                                                                   formstring( "Input ", chan + 1, " Gain" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_INT32,
+                                                                   ControlValue{"gain", &m_processing->m_input[chan].m_gain} );
+            configuration->addChildDescriptor( gain );
+            schema_chan->addItem( "gain", gain );
+
+            Descriptor::ControlPtr mute = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_MUTE,
+                                                                   formstring( "Input ", chan + 1, " Mute" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_UINT8,
+                                                                   ControlValue{"mute", &m_processing->m_input[chan].m_mute} );
+            configuration->addChildDescriptor( mute );
+            schema_chan->addItem( "mute", mute );
+        }
+
+        Descriptor::MatrixPtr matrix
+            = Descriptor::makeMatrix( AVDECC_AEM_CONTROL_TYPE_GAIN, "Mix Matrix", AVDECC_CONTROL_VALUE_LINEAR_INT32 );
+        for ( size_t row = 0; row < m_processing->m_matrix.size(); ++row )
+        {
+            matrix->addRow( configuration, uint16_t( row ) );
+            for ( size_t col = 0; col < m_processing->m_matrix[row].size(); ++col )
+            {
+                matrix->addColumn();
+                matrix->addValue( ControlValue{"gain", &m_processing->m_matrix[row][col]} );
+            }
+        }
+        configuration->addChildDescriptor( matrix );
+        m_root->addItem( "matrix", matrix );
+
+        ControlContainerPtr schema_meter = m_root->addItem( "meter" );
+        for ( size_t chan = 0; chan < m_processing->m_meter.size(); ++chan )
+        {
+            Descriptor::ControlPtr meter = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_AUDIO_METERS,
+                                                                    formstring( "Input ", chan + 1, " Meter" ),
+                                                                    AVDECC_CONTROL_VALUE_LINEAR_INT8,
+                                                                    ControlValue{"meter", &m_processing->m_meter[chan]} );
+            configuration->addChildDescriptor( meter );
+            schema_meter->addItem( formstring( chan + 1 ), meter );
+        }
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+struct TestSchema
+{
+    TestProcessing m_processing;
+    ControlContainerPtr m_top;
+    std::unique_ptr<Schema> m_schema;
+
+    TestSchema() : m_top( ControlContainer::create() )
+    {
+        TestSchemaGenerator generator( m_top, &m_processing );
+        generator.generate();
+        m_schema.reset( new Schema( m_top ) );
+    }
+};
@@ -0,0 +1,139 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ControlIdentity.hpp"
+
+using namespace ControlPlane;
+
+#define TEST( testname, func, expected )                                                                                       \
+    do                                                                                                                         \
+    {                                                                                                                          \
+        bool e = ( func == expected );                                                                                         \
+        r &= e;                                                                                                                \
+        std::cout << ( e ? "PASS" : "FAIL" ) << " : " << testname << " : " << #func << std::endl;                              \
+    } while ( false )
+
+static std::vector<ControlIdentity> makeSampleIdentities()
+{
+    std::vector<ControlIdentity> r;
+    r.push_back( ControlIdentity() );
+    for ( uint16_t type : {0, 1, 0x1a, 0x25} )
+    {
+        for ( uint16_t index : {0, 1, 2000, 0xffff} )
+        {
+            for ( int section = ControlIdentity::SectionDescriptorLevel; section <= ControlIdentity::SectionWPosLevel;
+                  ++section )
+            {
+                for ( uint16_t item : {0, 3, 0x1fff} )
+                {
+                    for ( uint16_t pos : {0, 1, 255, 0xfff} )
+                    {
+                        r.push_back( ControlIdentity( type, index, ControlIdentity::Section( section ), item, pos, 0 ) );
+                        r.push_back( ControlIdentity( type, index, ControlIdentity::Section( section ), item, 7, pos ) );
+                    }
+                }
+            }
+        }
+    }
+    return r;
+}
+
+///
+/// \brief test_ControlIdentityKey_RoundTrip
+///
+/// Test that packing and unpacking a ControlIdentity gives the same identity
+///
+/// \return true on pass
+///
+bool test_ControlIdentityKey_RoundTrip()
+{
+    bool r = true;
+    for ( auto const &i : makeSampleIdentities() )
+    {
+        ControlIdentityKey key( i );
+        if ( !key.isValid() || !( key.toIdentity() == i ) )
+        {
+            std::cout << "round trip failed for " << i << std::endl;
+            r = false;
+        }
+    }
+    return r;
+}
+
+///
+/// \brief test_ControlIdentityKey_Ordering
+///
+/// Test that the integer ordering of the packed keys matches compare() on ControlIdentity
+///
+/// \return true on pass
+///
+bool test_ControlIdentityKey_Ordering()
+{
+    bool r = true;
+    std::vector<ControlIdentity> items = makeSampleIdentities();
+    for ( size_t a = 0; a < items.size(); a += 7 )
+    {
+        for ( size_t b = 0; b < items.size(); ++b )
+        {
+            int expected = compare( items[a], items[b] );
+            ControlIdentityKey ka( items[a] );
+            ControlIdentityKey kb( items[b] );
+            int actual = ka < kb ? -1 : ( ka == kb ? 0 : 1 );
+            if ( expected != actual )
+            {
+                std::cout << "ordering mismatch for " << items[a] << " and " << items[b] << std::endl;
+                r = false;
+            }
+        }
+    }
+    return r;
+}
+
+///
+/// \brief test_ControlIdentityKey_Invalid
+///
+/// Test that identities which do not fit the packed layout become the invalid key
+///
+/// \return true on pass
+///
+bool test_ControlIdentityKey_Invalid()
+{
+    bool r = true;
+    r &= !ControlIdentityKey( ControlIdentity( 0x100, 0 ) ).isValid();
+    r &= !ControlIdentityKey( ControlIdentity( 1, 0, ControlIdentity::SectionName, 0x2000 ) ).isValid();
+    r &= !ControlIdentityKey( ControlIdentity( 1, 0, ControlIdentity::SectionWPosLevel, 0, 0x1000 ) ).isValid();
+    r &= !ControlIdentityKey( ControlIdentity( 1, 0, ControlIdentity::SectionWPosLevel, 0, 0, 0x1000 ) ).isValid();
+    r &= !ControlIdentityKey().isValid();
+    r &= ControlIdentityKey( ControlIdentity( 1, 0 ) ) < ControlIdentityKey();
+    return r;
+}
+
+///
+/// \brief test_ControlIdentityKey_Hash
+///
+/// Test that distinct keys hash to distinct values in an unordered set
+///
+/// \return true on pass
+///
+bool test_ControlIdentityKey_Hash()
+{
+    std::vector<ControlIdentity> items = makeSampleIdentities();
+    std::set<ControlIdentityKey> ordered( items.begin(), items.end() );
+    std::set<size_t> hashes;
+    std::hash<ControlIdentityKey> hasher;
+    for ( auto const &i : ordered )
+    {
+        hashes.insert( hasher( i ) );
+    }
+    return hashes.size() == ordered.size();
+}
+
+int main()
+{
+    bool r = true;
+
+    TEST( "packing", test_ControlIdentityKey_RoundTrip(), true );
+    TEST( "ordering", test_ControlIdentityKey_Ordering(), true );
+    TEST( "packing", test_ControlIdentityKey_Invalid(), true );
+    TEST( "hashing", test_ControlIdentityKey_Hash(), true );
+
+    return r == true ? 0 : 255;
+}
@@ -1,5 +1,7 @@
 #include "ControlPlane/World.hpp"
 #include "ControlPlane/RangedValue.hpp"
+#include "ControlPlane/Values.hpp"
+#include "ControlPlane/BulkEncoding.hpp"
 
 using namespace ControlPlane;
 
@@ -11,9 +13,271 @@ using namespace ControlPlane;
         std::cout << testname << " : " << #func << " : " << ( e ? "PASS" : "FAIL" ) << std::endl;                              \
     } while ( false )
 
+///
+/// \brief test_RangedValue_IncDecClamp
+///
+/// Test that incValue() and decValue() stop at the maximum and minimum
+///
+/// \return true on pass
+///
+bool test_RangedValue_IncDecClamp()
+{
+    bool r = true;
+    Gain g( -89.5f );
+    r &= g.decValue() == true;
+    r &= g.getValue() == -90.0f;
+    r &= g.decValue() == false;
+    r &= g.getValue() == -90.0f;
+
+    g.setValue( 9.5f );
+    r &= g.incValue() == true;
+    r &= g.getValue() == 10.0f;
+    r &= g.incValue() == false;
+
+    r &= g.setValueWithClamp( 20.0f ) == false;
+    r &= g.setValueWithClamp( -200.0f ) == true;
+    r &= g.getValue() == -90.0f;
+    return r;
+}
+
+///
+/// \brief test_RangedValue_Storage
+///
+/// Test that the default storage for scalar and bool values is lock free
+/// and that the plain storage policy behaves the same way
+///
+/// \return true on pass
+///
+bool test_RangedValue_Storage()
+{
+    bool r = true;
+    r &= Gain().isLockFree();
+    r &= Mute().isLockFree();
+
+    RangedValue<UnitsCode::LevelDb, -900, 100, 0, 10, -1, int32_t, float, RangedValuePlainStorage> plain( -3.0f );
+    r &= !plain.isLockFree();
+    r &= plain.decValue() == true;
+    r &= plain.getValue() == -4.0f;
+
+    Mute m;
+    r &= m.setValue( true ) == true;
+    r &= m.setValue( true ) == false;
+    r &= m.getValue() == true;
+
+    Gain copy( Gain( -6.0f ) );
+    r &= copy.getValue() == -6.0f;
+    return r;
+}
+
+///
+/// \brief test_RangedValue_ConcurrentInc
+///
+/// Test that incValue() from several threads at once loses no increments
+///
+/// \return true on pass
+///
+bool test_RangedValue_ConcurrentInc()
+{
+    static const int num_threads = 4;
+    static const int num_incs = 20000;
+    RangedValue<UnitsCode::Unitless, 0, num_threads * num_incs, 0, 1, 0, int32_t, int32_t> counter;
+
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < num_threads; ++t )
+    {
+        threads.push_back( std::thread( [&counter]()
+                                        {
+            for ( int i = 0; i < num_incs; ++i )
+            {
+                counter.incValue();
+            }
+        } ) );
+    }
+    for ( auto &i : threads )
+    {
+        i.join();
+    }
+    return counter.getValue() == num_threads * num_incs && counter.incValue() == false;
+}
+
+///
+/// \brief test_RangedValue_NumberStrings
+///
+/// Test that the number formatting and parsing of Util give the same
+/// results as a stream over steps of several multiplier powers and over
+/// values which are not on any step, and that a Gain round trips through
+/// its string
+///
+/// \return true on pass
+///
+bool test_RangedValue_NumberStrings()
+{
+    bool r = true;
+    char buf[Util::max_number_length];
+
+    for ( int power = -4; power <= 3; ++power )
+    {
+        for ( int64_t n = -200000; n <= 200000; n += 37 )
+        {
+            float v = float( double( n ) * std::pow( 10.0, power ) );
+            std::ostringstream expected;
+            expected << v;
+            r &= string( buf, Util::formatNumber( buf, v, power ) ) == expected.str();
+        }
+    }
+
+    const double odd_values[] = {0.0, -0.0, 1.0 / 3.0, -2.0 / 3.0, 1e-5, 123456.5, 1234567.0, 9.999995, 1e300, -1e-300};
+    for ( double v : odd_values )
+    {
+        std::ostringstream expected;
+        expected << v;
+        r &= string( buf, Util::formatNumber( buf, v, -1 ) ) == expected.str();
+    }
+    r &= string( buf, Util::formatNumber( buf, std::numeric_limits<int64_t>::min() ) ) == "-9223372036854775808";
+
+    const char *texts[]
+        = {"-6.5", " 12", "+3.25e2 dB", "0.000123", "1e-3", "abc", "", "-", "5.", ".5", "12345678901234567890123"};
+    for ( const char *text : texts )
+    {
+        std::istringstream is_float( text ), is_double( text ), is_int( text );
+        float expected_float = 0;
+        double expected_double = 0;
+        int32_t expected_int = 0;
+        is_float >> expected_float;
+        is_double >> expected_double;
+        is_int >> expected_int;
+
+        float f;
+        double d;
+        int32_t i;
+        Util::parseNumber( string( text ), f );
+        Util::parseNumber( string( text ), d );
+        Util::parseNumber( string( text ), i );
+        r &= f == expected_float && d == expected_double && i == expected_int;
+    }
+
+    Gain g;
+    r &= g.setUnencodedValueString( "-6.5", false ) == true;
+    r &= g.getValue() == -6.5f;
+    r &= g.getUnencodedValueString( false ) == "-6.5";
+    r &= g.getUnencodedValueString( true ) == "-6.5 dB";
+    r &= g.getUnencodedMinimumString( false ) == "-90" && g.getUnencodedStepString( false ) == "1";
+    return r;
+}
+
+///
+/// \brief test_RangedValue_Encoding
+///
+/// Test that the compile time factors and limits match the decoded values,
+/// that encoding rounds and that a float encoding accepts a negative range
+///
+/// \return true on pass
+///
+bool test_RangedValue_Encoding()
+{
+    bool r = true;
+    using Level = RangedValue<UnitsCode::LevelDb, -9000, 1000, 0, 1, -2, int16_t, float>;
+    using Signed = RangedValue<UnitsCode::Unitless, -1000, 1000, 0, 1, -1, float, float>;
+    static_assert( Level::encoding_multiplier == 100.0f && Level::decoding_divider == 100.0f, "factors" );
+    static_assert( Level::isMaxEncodableAs<int16_t>() && !Level::isMaxEncodableAs<int8_t>(), "max encodable" );
+    static_assert( Signed::isMinEncodableAs<float>() && !Signed::isMinEncodableAs<uint32_t>(), "min encodable" );
+
+    Level level;
+    r &= level.getMinValue() == -90.0f && level.getMaxValue() == 10.0f && level.getStepValue() == 0.01f;
+    r &= level.setValue( -12.34f ) == true && level.getEncodedValueInt16() == -1234;
+    r &= level.setFromEncodedValueInt16( -601 ) == true && level.getValue() == -6.01f;
+    r &= level.setFromEncodedValueWithClampInt32( 5000 ) == true && level.getValue() == 10.0f;
+
+    Signed s;
+    r &= s.setValue( -50.5f ) == true && s.getEncodedValueFloat() == -505.0f;
+
+    bool threw = false;
+    try
+    {
+        level.getEncodedValueInt8();
+    }
+    catch ( std::domain_error const & )
+    {
+        threw = true;
+    }
+    r &= threw;
+    return r;
+}
+
+///
+/// \brief test_RangedValue_BulkEncoding
+///
+/// Test that every bulk encoding kernel gives the same octets as encoding
+/// each Gain by itself, at an odd length and alignment, rounds halves away
+/// from zero, clamps, and decodes to the same values as decoding each one
+///
+/// \return true on pass
+///
+bool test_RangedValue_BulkEncoding()
+{
+    bool r = true;
+    static const size_t count = 1001;
+    std::vector<Gain> gains( count );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        gains[i].setValue( -90.0f + float( i % 1001 ) / 10.0f );
+    }
+    std::vector<uint8_t> expected( count * 4 );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        uint32_t v = uint32_t( gains[i].getEncodedValueInt32() );
+        uint8_t *p = &expected[i * 4];
+        p[0] = uint8_t( v >> 24 );
+        p[1] = uint8_t( v >> 16 );
+        p[2] = uint8_t( v >> 8 );
+        p[3] = uint8_t( v );
+    }
+
+    const float odd_values[] = {0.25f, 0.5f, -0.5f, 1.5f, -2.5f, 0.49999997f, 1e9f, -1e9f, -7.75f};
+    const int32_t odd_expected[] = {0, 1, -1, 2, -3, 0, 100, -900, -8};
+
+    BulkEncodingKernel best = getBulkEncodingKernel();
+    for ( BulkEncodingKernel kernel : {BulkEncodingKernel::Scalar, BulkEncodingKernel::SSE2, BulkEncodingKernel::AVX2} )
+    {
+        BulkEncodingKernel used = setBulkEncodingKernel( kernel );
+        r &= used == getBulkEncodingKernel() && used <= kernel;
+
+        std::vector<uint8_t> encoded( count * 4 + 1 );
+        encodeRangedValuesInt32BigEndian( &encoded[1], gains.data(), count );
+        r &= memcmp( &encoded[1], expected.data(), count * 4 ) == 0;
+
+        std::vector<Gain> decoded( count );
+        r &= decodeRangedValuesInt32BigEndianWithClamp( decoded.data(), &encoded[1], count ) > 0;
+        for ( size_t i = 0; i < count; ++i )
+        {
+            Gain one;
+            one.setFromEncodedValueWithClampInt32( gains[i].getEncodedValueInt32() );
+            r &= decoded[i].getValue() == one.getValue();
+        }
+
+        uint8_t odd[sizeof( odd_values ) / sizeof( float ) * 4];
+        encodeInt32BigEndian( odd, odd_values, sizeof( odd_values ) / sizeof( float ), 1.0f, 1.0f, -900, 100 );
+        for ( size_t i = 0; i < sizeof( odd_values ) / sizeof( float ); ++i )
+        {
+            uint32_t v = ( uint32_t( odd[i * 4] ) << 24 ) | ( uint32_t( odd[i * 4 + 1] ) << 16 )
+                         | ( uint32_t( odd[i * 4 + 2] ) << 8 ) | uint32_t( odd[i * 4 + 3] );
+            r &= int32_t( v ) == odd_expected[i];
+        }
+    }
+    setBulkEncodingKernel( best );
+    return r;
+}
+
 int main()
 {
     bool r = true;
 
+    TEST( "inc/dec", test_RangedValue_IncDecClamp(), true );
+    TEST( "storage", test_RangedValue_Storage(), true );
+    TEST( "atomic", test_RangedValue_ConcurrentInc(), true );
+    TEST( "strings", test_RangedValue_NumberStrings(), true );
+    TEST( "encoding", test_RangedValue_Encoding(), true );
+    TEST( "bulk", test_RangedValue_BulkEncoding(), true );
+
     return r == true ? 0 : 255;
 }
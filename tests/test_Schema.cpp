@@ -0,0 +1,1097 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/ChangeNotifier.hpp"
+#include "ControlPlane/SchemaSnapshot.hpp"
+#include "ControlPlane/Text.hpp"
+#include "TestSchema.hpp"
+
+#define TEST( testname, func, expected )                                                                                       \
+    do                                                                                                                         \
+    {                                                                                                                          \
+        bool e = ( func == expected );                                                                                         \
+        r &= e;                                                                                                                \
+        std::cout << ( e ? "PASS" : "FAIL" ) << " : " << testname << " : " << #func << std::endl;                              \
+    } while ( false )
+
+///
+/// \brief test_Schema_TrieMatchesAddressMap
+///
+/// Test that every address in the address map resolves to the same identity through the trie
+///
+/// \return true on pass
+///
+bool test_Schema_TrieMatchesAddressMap()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    for ( auto const &i : schema.getAddressMap() )
+    {
+        ControlIdentity identity;
+        if ( !schema.getAddressTrie().find( i.first, &identity ) || !( identity == i.second ) )
+        {
+            std::cout << "trie mismatch for " << schemaAddressToString( i.first ) << std::endl;
+            r = false;
+        }
+
+        SchemaAddressTrie::AtomPath path;
+        if ( !schema.getAddressTrie().toAtomPath( i.first, &path ) || !schema.getAddressTrie().find( path, &identity )
+             || !( identity == i.second ) )
+        {
+            std::cout << "atom path mismatch for " << schemaAddressToString( i.first ) << std::endl;
+            r = false;
+        }
+    }
+    return r && schema.getAddressMap().size() > 16 * 2 + 3 * 4;
+}
+
+///
+/// \brief test_Schema_IdentityForPath
+///
+/// Test resolving separator delimited paths, including the matrix cells and missing paths
+///
+/// \return true on pass
+///
+bool test_Schema_IdentityForPath()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    r &= schema.getIdentityForPath( "/input/3/gain" ) == schema.getIdentityForAddress( SchemaAddress{"input", "3", "gain"} );
+    r &= schema.getIdentityForPath( "input//3/gain/" ) == schema.getIdentityForAddress( SchemaAddress{"input", "3", "gain"} );
+    r &= schema.getIdentityForPath( "/matrix/2/4" ).m_h_pos == 1;
+    r &= schema.getIdentityForPath( "/matrix/2/4" ).m_w_pos == 3;
+
+    for ( auto const &missing : {"/input/17/gain", "/input/3", "/input/3/gainx", "", "/"} )
+    {
+        try
+        {
+            schema.getIdentityForPath( missing );
+            std::cout << "found missing path " << missing << std::endl;
+            r = false;
+        }
+        catch ( SchemaErrorNoSuchDescriptorForAddress const & )
+        {
+        }
+    }
+    return r;
+}
+
+///
+/// \brief test_Schema_ValueIndex
+///
+/// Test that values set through the schema land in the expected storage
+///
+/// \return true on pass
+///
+bool test_Schema_ValueIndex()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), -12.0f, SchemaAddress{"input", "5", "gain"} );
+    r &= t.m_processing.m_input[4].m_gain.getValue() == -12.0f;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), true, SchemaAddress{"input", "16", "mute"} );
+    r &= t.m_processing.m_input[15].m_mute.getValue() == true;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), -3.0f, SchemaAddress{"matrix", "3", "2"} );
+    r &= t.m_processing.m_matrix[2][1].getValue() == -3.0f;
+
+    float v = 0.0f;
+    schema.getValue( &v, SchemaAddress{"matrix", "3", "2"} );
+    r &= v == -3.0f;
+
+    r &= schema.getValueIndex().size() == schema.getIdentityMap().size();
+    return r;
+}
+
+struct StaticTestProcessing
+{
+    ChannelProcessing m_input[16];
+};
+
+StaticTestProcessing static_test_processing;
+
+extern constexpr StaticControlInfo static_test_gain{
+    "gain", "Gain", AVDECC_AEM_CONTROL_TYPE_GAIN, AVDECC_CONTROL_VALUE_LINEAR_INT32};
+extern constexpr StaticControlInfo static_test_mute{
+    "mute", "Mute", AVDECC_AEM_CONTROL_TYPE_MUTE, AVDECC_CONTROL_VALUE_LINEAR_UINT8};
+extern constexpr StaticChannelGroupInfo static_test_input{"input", "Input"};
+
+using StaticTestLayout = StaticSchemaLayout<
+    StaticChannelGroup<StaticTestProcessing,
+                       static_test_processing,
+                       ChannelProcessing,
+                       16,
+                       &StaticTestProcessing::m_input,
+                       static_test_input,
+                       StaticControl<ChannelProcessing, Gain, &ChannelProcessing::m_gain, static_test_gain>,
+                       StaticControl<ChannelProcessing, Mute, &ChannelProcessing::m_mute, static_test_mute> > >;
+
+///
+/// \brief test_Schema_StaticLayout
+///
+/// Test that a Schema constructed from a StaticSchemaLayout gives the same
+/// identities and descriptors as the equivalent runtime generated schema,
+/// and that values set through it land in the static storage
+///
+/// \return true on pass
+///
+bool test_Schema_StaticLayout()
+{
+    bool r = true;
+    TestSchema t;
+    Schema schema( StaticTestLayout::getTable() );
+
+    r &= schema.isStatic() && !t.m_schema->isStatic();
+    r &= schema.getValueIndex().size() == 32;
+
+    for ( auto const &i : t.m_schema->getAddressMap() )
+    {
+        if ( i.first[0] == "input" )
+        {
+            ControlIdentity identity = schema.getIdentityForAddress( i.first );
+            r &= ControlIdentityKey( identity ) == ControlIdentityKey( i.second );
+            r &= schema.getDescriptor( identity )->getDescription()
+                 == t.m_schema->getDescriptor( i.second )->getDescription();
+        }
+    }
+
+    schema.setValue( nullptr, Milliseconds( 0 ), -12.0f, schema.getIdentityForPath( "/input/12/gain" ) );
+    r &= static_test_processing.m_input[11].m_gain.getValue() == -12.0f;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), true, SchemaAddress{"input", "3", "mute"} );
+    r &= static_test_processing.m_input[2].m_mute.getValue() == true;
+
+    r &= schema.getAddressMap().size() == 32 && schema.getIdentityMap().size() == 32;
+    return r;
+}
+
+///
+/// \brief test_Schema_ApplyBatch
+///
+/// Test that a batch sets every value, reports the changed count and
+/// notifies a subscriber once with the whole set of changed controls
+///
+/// \return true on pass
+///
+bool test_Schema_ApplyBatch()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    size_t notifications = 0;
+    size_t notified_items = 0;
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorAll>( schema ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+        ++notifications;
+        notified_items += items.size();
+    } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+
+    std::vector<ControlValueChange> batch;
+    for ( size_t chan = 0; chan < t.m_processing.m_input.size(); ++chan )
+    {
+        batch.push_back( ControlValueChange( schema.getIdentityForPath( formstring( "/input/", chan + 1, "/gain" ) ),
+                                             -float( chan ) ) );
+        batch.push_back( ControlValueChange( schema.getIdentityForPath( formstring( "/input/", chan + 1, "/mute" ) ), true ) );
+    }
+
+    // the gain of input 1 is already 0
+    r &= schema.applyBatch( nullptr, Milliseconds( 5 ), batch ) == batch.size() - 1;
+    r &= t.m_processing.m_input[7].m_gain.getValue() == -7.0f;
+    r &= t.m_processing.m_input[15].m_mute.getValue() == true;
+
+    schema.getChangeManager().tick( Milliseconds( 10 ) );
+    r &= notifications == 1;
+    r &= notified_items == batch.size() - 1;
+
+    r &= schema.applyBatch( nullptr, Milliseconds( 20 ), batch ) == 0;
+    schema.getChangeManager().removeChangeNotifier( notifier );
+    return r;
+}
+
+///
+/// \brief test_Schema_NotifierSchedule
+///
+/// Test that a subscription with changes is notified once its max update
+/// period has passed, and that a periodic subscription is refreshed every
+/// min update period
+///
+/// \return true on pass
+///
+bool test_Schema_NotifierSchedule()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentity gain2 = schema.getIdentityForPath( "/input/2/gain" );
+
+    size_t changes_notifications = 0;
+    size_t changes_items = 0;
+    size_t periodic_notifications = 0;
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain1 ),
+                               Milliseconds( 50 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 1 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+        ++changes_notifications;
+        changes_items += items.size();
+    } );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain2 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 30 ),
+                               Milliseconds( 1 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const & )
+                               {
+        ++periodic_notifications;
+    } );
+
+    // the first notification of a new subscription is due after its max update period
+    notifier->tick( Milliseconds( 49 ) );
+    r &= changes_notifications == 0 && periodic_notifications == 1;
+    notifier->tick( Milliseconds( 50 ) );
+    r &= changes_notifications == 1 && changes_items == 0;
+
+    notifier->controlChanged( Milliseconds( 60 ), gain1 );
+    notifier->tick( Milliseconds( 70 ) );
+    r &= changes_notifications == 1 && periodic_notifications == 1;
+    notifier->tick( Milliseconds( 79 ) );
+    r &= periodic_notifications == 2;
+    notifier->tick( Milliseconds( 100 ) );
+    r &= changes_notifications == 2 && changes_items == 1;
+
+    // nothing is pending after a removed subscription
+    notifier->removeSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain2 ) );
+    notifier->controlChanged( Milliseconds( 110 ), gain2 );
+    notifier->tick( Milliseconds( 200 ) );
+    r &= changes_notifications == 2 && periodic_notifications == 2;
+    return r;
+}
+
+///
+/// \brief test_Schema_NotifierIndex
+///
+/// Test that changed controls reach only the subscriptions whose comparators contain them
+///
+/// \return true on pass
+///
+bool test_Schema_NotifierIndex()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentity gain2 = schema.getIdentityForPath( "/input/2/gain" );
+    ControlIdentity mute2 = schema.getIdentityForPath( "/input/2/mute" );
+
+    std::map<std::string, ControlIdentitySet> notified;
+    auto subscribe = [&]( ChangeNotifier &notifier, std::string name, ControlIdentityComparatorPtr comparator )
+    {
+        notifier.addSubscription(
+            comparator,
+            Milliseconds( 1 ),
+            Milliseconds( 0 ),
+            Milliseconds( 0 ),
+            [&notified, name]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+            {
+                notified[name].insert( items.begin(), items.end() );
+            } );
+    };
+
+    ControlIdentityComparatorSetPtr set = std::make_shared<ControlIdentityComparatorSet>();
+    set->addItem( gain2 );
+    set->addItem( mute2 );
+
+    ChangeNotifier notifier( Milliseconds( 0 ) );
+    subscribe( notifier, "unique", std::make_shared<ControlIdentityComparatorUnique>( gain1 ) );
+    subscribe( notifier, "set", set );
+    subscribe( notifier, "all", std::make_shared<ControlIdentityComparatorAll>( schema ) );
+    subscribe( notifier, "none", std::make_shared<ControlIdentityComparatorNone>() );
+
+    notifier.controlsChanged( Milliseconds( 5 ), ControlIdentitySet{gain1, mute2} );
+    notifier.tick( Milliseconds( 10 ) );
+    r &= notified["unique"] == ControlIdentitySet{gain1};
+    r &= notified["set"] == ControlIdentitySet{mute2};
+    r &= notified["all"] == ( ControlIdentitySet{gain1, mute2} );
+    r &= notified["none"].empty();
+
+    notified.clear();
+    notifier.removeSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain1 ) );
+    notifier.controlChanged( Milliseconds( 20 ), gain1 );
+    notifier.controlChanged( Milliseconds( 20 ), gain2 );
+    notifier.tick( Milliseconds( 30 ) );
+    r &= notified.count( "unique" ) == 0;
+    r &= notified["set"] == ControlIdentitySet{gain2};
+    r &= notified["all"] == ( ControlIdentitySet{gain1, gain2} );
+    return r;
+}
+
+///
+/// \brief test_Schema_ChangedBitmap
+///
+/// Test that a ControlIdentityBitmap over the value index holds, iterates and clears identities,
+/// including identities which are not in the index
+///
+/// \return true on pass
+///
+bool test_Schema_ChangedBitmap()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentityKey gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentityKey mute16 = schema.getIdentityForPath( "/input/16/mute" );
+    ControlIdentityKey other = ControlIdentity( AVDECC_DESCRIPTOR_CONTROL, 0xfff0 );
+
+    ControlIdentityBitmap items( &schema.getValueIndex() );
+    items.insert( mute16 );
+    items.insert( other );
+    items.insert( gain1 );
+    items.insert( gain1 );
+    r &= items.size() == 3;
+    r &= items.contains( gain1 ) && items.contains( other ) && !items.contains( schema.getIdentityForPath( "/input/2/gain" ) );
+    r &= ControlIdentitySet( items.begin(), items.end() ) == ( ControlIdentitySet{gain1, mute16, other} );
+    r &= *items.begin() == std::min( gain1, mute16 );
+
+    items.setIndex( nullptr );
+    r &= ControlIdentitySet( items.begin(), items.end() ) == ( ControlIdentitySet{gain1, mute16, other} );
+    items.setIndex( &schema.getValueIndex() );
+
+    items.clear();
+    r &= items.empty() && items.begin() == items.end();
+
+    items.insertAll();
+    r &= items.size() == schema.getValueIndex().size();
+    r &= size_t( std::distance( items.begin(), items.end() ) ) == schema.getValueIndex().size();
+    return r;
+}
+
+///
+/// \brief test_Schema_MeterSubscription
+///
+/// Test that a meter subscription receives one frame of the encoded levels
+/// of its group per period, that subscribers share the frame sampled at a
+/// time, and that a group of controls which are not meters is refused
+///
+/// \return true on pass
+///
+bool test_Schema_MeterSubscription()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    auto group = std::make_shared<MeterGroup>( schema, schema.getIdentityForPath( "/meter/1" ), 16 );
+    r &= group->size() == 16 && t.m_processing.m_meter[0].isReadOnly();
+    r &= group->getMeters().back() == ControlIdentityKey( schema.getIdentityForPath( "/meter/16" ) );
+
+    for ( size_t chan = 0; chan < t.m_processing.m_meter.size(); ++chan )
+    {
+        t.m_processing.m_meter[chan].setValue( -float( chan ) / 2 );
+    }
+
+    ChangeNotifier notifier( Milliseconds( 30 ) );
+    ChangeNotifier other( Milliseconds( 30 ) );
+    std::vector<MeterFrame> frames;
+    uint64_t other_sequence = 0;
+    notifier.addMeterSubscription( group,
+                                   Milliseconds( 33 ),
+                                   Milliseconds( 0 ),
+                                   [&]( MeterFrame const &frame )
+                                   {
+                                       frames.push_back( frame );
+                                   } );
+    other.addMeterSubscription( group,
+                                Milliseconds( 100 ),
+                                Milliseconds( 0 ),
+                                [&]( MeterFrame const &frame )
+                                {
+                                    other_sequence = frame.m_sequence;
+                                } );
+
+    for ( int64_t now = 1; now <= 100; ++now )
+    {
+        notifier.tick( Milliseconds( now ) );
+        if ( now == 1 )
+        {
+            other.tick( Milliseconds( now ) );
+            r &= other_sequence == 1;
+        }
+    }
+
+    // the first tick, then every 33 ms from the time of the subscription
+    r &= frames.size() == 4;
+    if ( r )
+    {
+        r &= frames[1].m_time_in_milliseconds == Milliseconds( 33 ) && frames[3].m_time_in_milliseconds == Milliseconds( 99 );
+        r &= frames[1].m_sequence == 2;
+        r &= frames[0].m_levels.size() == 16;
+        for ( size_t chan = 0; chan < t.m_processing.m_meter.size(); ++chan )
+        {
+            r &= frames[0].m_levels[chan] == t.m_processing.m_meter[chan].getEncodedValueInt8();
+        }
+    }
+
+    notifier.removeMeterSubscription( group );
+    notifier.tick( Milliseconds( 200 ) );
+    r &= frames.size() == 4;
+
+    try
+    {
+        MeterGroup gains( schema, schema.getIdentityForPath( "/input/1/gain" ), 2 );
+        r = false;
+    }
+    catch ( SchemaErrorNotAMeter const & )
+    {
+    }
+    return r;
+}
+
+///
+/// \brief test_Schema_ChangeJournal
+///
+/// Test that changes are numbered and journaled, that a subscriber can
+/// resume from a sequence number, also through the text protocol, and that
+/// it is told to resync once the changes it missed have left the ring
+///
+/// \return true on pass
+///
+bool test_Schema_ChangeJournal()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ChangeJournal const &journal = schema.getChangeManager().getJournal();
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentity gain2 = schema.getIdentityForPath( "/input/2/gain" );
+
+    r &= journal.getSequence() == 0;
+    schema.setValue( nullptr, Milliseconds( 1 ), -3.0f, gain1 );
+    schema.setValue( nullptr, Milliseconds( 2 ), -4.0f, gain2 );
+    schema.setValue( nullptr, Milliseconds( 3 ), -5.0f, gain1 );
+    r &= journal.getSequence() == 3;
+
+    std::vector<ChangeJournal::Entry> entries;
+    uint64_t last_sequence = 0;
+    r &= journal.readSince( 0, entries, last_sequence );
+    r &= last_sequence == 3 && entries.size() == 2;
+    if ( r )
+    {
+        r &= entries[0].m_key == ControlIdentityKey( gain2 ) && entries[0].m_sequence == 2;
+        r &= entries[1].m_key == ControlIdentityKey( gain1 ) && entries[1].m_sequence == 3;
+    }
+
+    r &= journal.readSince( 1, entries, last_sequence, false ) && entries.size() == 2;
+    r &= journal.readSince( 3, entries, last_sequence ) && entries.empty();
+    r &= !journal.readSince( 4, entries, last_sequence ) && entries.empty();
+
+    struct CaptureIO : public Text::TextIO
+    {
+        std::vector<std::string> m_lines;
+        void sendLine( std::string const &line ) override { m_lines.push_back( line ); }
+        bool receiveLine( std::string * ) override { return false; }
+    } io;
+    Text::SchemaTextAdaptor adaptor( schema, Text::getTextAddressForIdentity );
+    Text::TextProtocolSession session( io, adaptor );
+    session.handleLine( Milliseconds( 4 ), ":resume 2" );
+    r &= io.m_lines.size() == 2;
+    if ( r )
+    {
+        r &= io.m_lines[0].find( "/input/1/gain=" ) == 0;
+        r &= io.m_lines[1] == ":seq 3";
+    }
+
+    ChangeJournal small( 4 );
+    for ( uint16_t i = 0; i < 6; ++i )
+    {
+        small.record( ControlIdentity( AVDECC_DESCRIPTOR_CONTROL, i ) );
+    }
+    r &= !small.readSince( 1, entries, last_sequence ) && last_sequence == 6;
+    r &= small.readSince( 2, entries, last_sequence ) && entries.size() == 4 && entries[0].m_sequence == 3;
+    return r;
+}
+
+///
+/// \brief test_Schema_HoldCoalesces
+///
+/// Test that the changes made while a ChangeNotifierManagerHold is alive,
+/// including a snapshot restore, reach a subscription as one notification
+/// of each changed control once the hold is released
+///
+/// \return true on pass
+///
+bool test_Schema_HoldCoalesces()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentity mute1 = schema.getIdentityForPath( "/input/1/mute" );
+
+    schema.setValue( nullptr, Milliseconds( 0 ), -6.0f, gain1 );
+    SchemaSnapshot scene = SchemaSnapshot::capture( schema );
+    schema.setValue( nullptr, Milliseconds( 0 ), 0.0f, gain1 );
+
+    std::vector<ControlIdentitySet> notified;
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorAll>( schema ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+                                   notified.push_back( ControlIdentitySet( items.begin(), items.end() ) );
+                               } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+    uint64_t sequence = schema.getChangeManager().getJournal().getSequence();
+
+    {
+        ChangeNotifierManagerHold hold( schema.getChangeManager() );
+        for ( int i = 1; i <= 10; ++i )
+        {
+            schema.setValue( nullptr, Milliseconds( i ), -float( i ), gain1 );
+            schema.getChangeManager().tick( Milliseconds( i ) );
+        }
+        schema.setValue( nullptr, Milliseconds( 11 ), true, mute1 );
+        scene.restore( schema, nullptr, Milliseconds( 12 ) );
+        schema.getChangeManager().tick( Milliseconds( 20 ) );
+        r &= notified.empty() && schema.getChangeManager().getJournal().getSequence() == sequence;
+    }
+
+    schema.getChangeManager().tick( Milliseconds( 30 ) );
+    r &= notified.size() == 1;
+    r &= !notified.empty() && notified[0] == ( ControlIdentitySet{gain1, mute1} );
+    r &= schema.getChangeManager().getJournal().getSequence() == sequence + 2;
+    r &= t.m_processing.m_input[0].m_gain.getValue() == -6.0f;
+
+    schema.getChangeManager().removeChangeNotifier( notifier );
+    return r;
+}
+
+///
+/// \brief test_Schema_ControlHandle
+///
+/// Test that a handle writes the same value as Schema::setValue(), that its
+/// writes reach the notifiers directly and through a real time ingress, and
+/// that resolving a read only control or the wrong type throws
+///
+/// \return true on pass
+///
+bool test_Schema_ControlHandle()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+
+    ControlHandle<Gain> gain = schema.getControlHandle<Gain>( nullptr, "/input/1/gain" );
+    ControlHandle<Mute> mute = schema.getControlHandle<Mute>( nullptr, SchemaAddress{"input", "2", "mute"} );
+    r &= gain.isValid() && gain.getIdentity() == gain1 && &gain.getRangedValue() == &t.m_processing.m_input[0].m_gain;
+
+    std::vector<ControlIdentitySet> notified;
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorAll>( schema ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+                                   notified.push_back( ControlIdentitySet( items.begin(), items.end() ) );
+                               } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+
+    r &= gain.setValue( Milliseconds( 1 ), -6.0f ) == true && gain.setValue( Milliseconds( 1 ), -6.0f ) == false;
+    r &= mute.setValue( Milliseconds( 1 ), true ) == true;
+    float value = 0.0f;
+    schema.getValue( &value, gain1 );
+    r &= value == -6.0f && gain.getValue() == -6.0f && t.m_processing.m_input[1].m_mute.getValue() == true;
+    schema.getChangeManager().tick( Milliseconds( 10 ) );
+    r &= notified.size() == 1
+         && notified[0] == ( ControlIdentitySet{gain1, schema.getIdentityForPath( "/input/2/mute" )} );
+
+    r &= gain.setValueWithClamp( Milliseconds( 20 ), 100.0f ) == true && gain.getValue() == 10.0f;
+    RealtimeChangeIngressPtr ingress = schema.getChangeManager().addRealtimeIngress( 16 );
+    r &= gain.setValueRealtime( *ingress, -20.0f ) == true && gain.getValue() == -20.0f;
+    schema.getChangeManager().tick( Milliseconds( 30 ) );
+    r &= notified.size() == 2 && notified[1] == ( ControlIdentitySet{gain1} );
+
+    bool threw = false;
+    try
+    {
+        schema.getControlHandle<Mute>( nullptr, gain1 );
+    }
+    catch ( SchemaErrorWrongValueType const & )
+    {
+        threw = true;
+    }
+    r &= threw;
+
+    threw = false;
+    try
+    {
+        auto read_only = std::make_shared<ControlIdentityComparatorUnique>( gain1 );
+        schema.getControlHandle<Gain>( read_only, gain1 );
+    }
+    catch ( SchemaErrorReadOnly const & )
+    {
+        threw = true;
+    }
+    r &= threw;
+
+    schema.getChangeManager().removeRealtimeIngress( ingress );
+    schema.getChangeManager().removeChangeNotifier( notifier );
+    return r;
+}
+
+///
+/// \brief test_Schema_RangePrefixComparators
+///
+/// Test that range and prefix comparators fill the same controls as asking
+/// containsControl() about each control in the schema, that equal ones are
+/// deduplicated in a map, and that a range subscription is notified only
+/// of its own controls
+///
+/// \return true on pass
+///
+bool test_Schema_RangePrefixComparators()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentity gain2 = schema.getIdentityForPath( "/input/2/gain" );
+    ControlIdentity gain4 = schema.getIdentityForPath( "/input/4/gain" );
+    ControlIdentity gain5 = schema.getIdentityForPath( "/input/5/gain" );
+    ControlIdentity matrix = schema.getIdentityForPath( "/matrix/1/1" );
+
+    ControlIdentityComparatorPtr range = std::make_shared<ControlIdentityComparatorRange>(
+        schema, gain1.m_descriptor_type, gain1.m_descriptor_index, gain4.m_descriptor_index, gain1.m_section );
+    ControlIdentityComparatorPtr prefix = std::make_shared<ControlIdentityComparatorPrefix>(
+        schema, matrix, ControlIdentityComparatorPrefix::Depth::DescriptorIndex );
+    ControlIdentityComparatorPtr type_prefix = std::make_shared<ControlIdentityComparatorPrefix>(
+        schema, gain1, ControlIdentityComparatorPrefix::Depth::DescriptorType );
+    std::vector<ControlIdentityComparatorPtr> comparators{range, prefix, type_prefix};
+
+    for ( auto const &comparator : comparators )
+    {
+        ControlIdentitySet expected;
+        for ( auto const &e : schema.getValueIndex().getEntries() )
+        {
+            if ( comparator->containsControl( e.m_key.toIdentity() ) )
+            {
+                expected.insert( e.m_key );
+            }
+        }
+        ControlIdentitySet filled;
+        comparator->fillSet( filled );
+        ControlIdentityBitmap bitmap( &schema.getValueIndex() );
+        comparator->fillBitmap( bitmap );
+        r &= !expected.empty() && filled == expected && ControlIdentitySet( bitmap.begin(), bitmap.end() ) == expected;
+    }
+    r &= range->containsControl( gain1 ) && range->containsControl( gain4 ) && !range->containsControl( gain5 );
+    r &= prefix->containsControl( matrix ) && !prefix->containsControl( gain1 );
+
+    // equal comparators are one key, whatever the order of insertion
+    std::map<ControlIdentityComparatorPtr, int, ControlIdentityComparator_compare> subscriptions;
+    subscriptions[range] = 1;
+    subscriptions[std::make_shared<ControlIdentityComparatorUnique>( gain1 )] = 2;
+    subscriptions[std::make_shared<ControlIdentityComparatorAll>( schema )] = 3;
+    subscriptions[prefix] = 4;
+    subscriptions[std::make_shared<ControlIdentityComparatorRange>(
+        schema, gain1.m_descriptor_type, gain1.m_descriptor_index, gain4.m_descriptor_index, gain1.m_section )] = 5;
+    subscriptions[std::make_shared<ControlIdentityComparatorPrefix>(
+        schema, matrix, ControlIdentityComparatorPrefix::Depth::DescriptorIndex )] = 6;
+    r &= subscriptions.size() == 4 && subscriptions[range] == 5 && subscriptions[prefix] == 6;
+
+    // ranges starting past the largest packable item are empty, and compare equal
+    ControlIdentityComparatorPtr past_a = std::make_shared<ControlIdentityComparatorRange>(
+        schema, gain1.m_descriptor_type, gain1.m_descriptor_index, gain4.m_descriptor_index, gain1.m_section, 0x2000, 0x3000 );
+    ControlIdentityComparatorPtr past_b = std::make_shared<ControlIdentityComparatorRange>(
+        schema, gain1.m_descriptor_type, gain1.m_descriptor_index, gain4.m_descriptor_index, gain1.m_section, 0x4000, 0xffff );
+    ControlIdentitySet past_filled;
+    past_a->fillSet( past_filled );
+    r &= past_filled.empty() && !past_a->containsControl( gain1 ) && past_a->compare( *past_b ) == 0;
+
+    std::vector<ControlIdentitySet> notified;
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorRange>( schema,
+                                                                                 gain1.m_descriptor_type,
+                                                                                 gain1.m_descriptor_index,
+                                                                                 gain4.m_descriptor_index,
+                                                                                 gain1.m_section ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+                                   notified.push_back( ControlIdentitySet( items.begin(), items.end() ) );
+                               } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+    schema.setValue( nullptr, Milliseconds( 1 ), -3.0f, gain2 );
+    schema.setValue( nullptr, Milliseconds( 1 ), -3.0f, gain5 );
+    schema.getChangeManager().tick( Milliseconds( 10 ) );
+    r &= notified.size() == 1 && notified[0] == ( ControlIdentitySet{gain2} );
+    schema.getChangeManager().removeChangeNotifier( notifier );
+
+    return r;
+}
+
+///
+/// \brief test_Schema_NotifierStats
+///
+/// Test that the stats of the notifiers count the changes, the subscriptions
+/// they match and the callbacks, measure the latency of the notifications,
+/// and are reported by the :stats text command
+///
+/// \return true on pass
+///
+bool test_Schema_NotifierStats()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain1 = schema.getIdentityForPath( "/input/1/gain" );
+    ControlIdentity gain2 = schema.getIdentityForPath( "/input/2/gain" );
+
+    r &= StatsHistogram::getBucket( 0 ) == 0 && StatsHistogram::getBucket( 1 ) == 1 && StatsHistogram::getBucket( 3 ) == 2
+         && StatsHistogram::getBucket( 4 ) == 3
+         && StatsHistogram::getBucket( ~uint64_t( 0 ) ) == StatsHistogram::num_buckets - 1;
+
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    auto callback = []( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const & )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+    };
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorAll>( schema ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               callback );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain1 ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               callback );
+    schema.getChangeManager().addChangeNotifier( notifier );
+
+    r &= notifier->getStats().m_changes_ingested == 0;
+    schema.getChangeManager().setStatsEnabled( true );
+    r &= notifier->isStatsEnabled();
+
+    schema.setValue( nullptr, Milliseconds( 1 ), -3.0f, gain1 );
+    schema.setValue( nullptr, Milliseconds( 1 ), -3.0f, gain2 );
+    schema.getChangeManager().tick( Milliseconds( 5 ) );
+
+    ChangeNotifierStats::Snapshot stats = schema.getChangeManager().getStats();
+    r &= stats.m_changes_ingested == 2;
+    r &= stats.m_subscriptions_matched == 3;
+    r &= stats.m_callbacks_delivered == 2;
+    r &= stats.m_latency_in_microseconds.m_count == 2;
+    r &= stats.m_callback_duration_in_microseconds.m_count == 2;
+    r &= stats.m_callback_duration_in_microseconds.getPercentile( 0.5 ) >= 1000;
+    r &= stats.m_callback_duration_in_microseconds.getPercentile( 0.5 ) <= stats.m_callback_duration_in_microseconds.m_max;
+
+    struct CaptureIO : public Text::TextIO
+    {
+        std::vector<std::string> m_lines;
+        void sendLine( std::string const &line ) override { m_lines.push_back( line ); }
+        bool receiveLine( std::string * ) override { return false; }
+    } io;
+    Text::SchemaTextAdaptor adaptor( schema, Text::getTextAddressForIdentity );
+    Text::TextProtocolSession session( io, adaptor );
+    session.handleLine( Milliseconds( 6 ), ":stats" );
+    session.handleLine( Milliseconds( 6 ), ":stats reset" );
+    r &= io.m_lines.size() == 2;
+    if ( r )
+    {
+        r &= io.m_lines[0].find( ":stats on changes=2 matched=3 delivered=2 " ) == 0;
+        r &= io.m_lines[1].find( ":stats on changes=0 " ) == 0;
+    }
+
+    schema.getChangeManager().setStatsEnabled( false );
+    r &= !notifier->isStatsEnabled();
+    schema.getChangeManager().removeChangeNotifier( notifier );
+    return r;
+}
+
+///
+/// \brief test_Schema_ApplyBatchRollback
+///
+/// Test that a batch with an out of range value leaves every value unchanged
+///
+/// \return true on pass
+///
+bool test_Schema_ApplyBatchRollback()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    std::vector<ControlValueChange> batch;
+    batch.push_back( ControlValueChange( schema.getIdentityForPath( "/input/1/gain" ), -6.0f ) );
+    batch.push_back( ControlValueChange( schema.getIdentityForPath( "/input/1/mute" ), true ) );
+    batch.push_back( ControlValueChange( schema.getIdentityForPath( "/input/1/gain" ), -12.0f ) );
+    batch.push_back( ControlValueChange( schema.getIdentityForPath( "/matrix/1/1" ), 50.0f ) );
+
+    try
+    {
+        schema.applyBatch( nullptr, Milliseconds( 0 ), batch );
+        r = false;
+    }
+    catch ( std::range_error const & )
+    {
+    }
+
+    r &= t.m_processing.m_input[0].m_gain.getValue() == 0.0f;
+    r &= t.m_processing.m_input[0].m_mute.getValue() == false;
+    r &= t.m_processing.m_matrix[0][0].getValue() == 0.0f;
+
+    // the out of range value is found before anything is written
+    r &= batch[0].validate( t.m_processing.m_input[0].m_gain ) && batch[1].validate( t.m_processing.m_input[0].m_mute );
+    r &= !batch[3].validate( t.m_processing.m_matrix[0][0] );
+    r &= !ControlValueChange( ControlIdentity(), "-100" ).validate( t.m_processing.m_matrix[0][0] );
+    return r;
+}
+
+///
+/// \brief test_Schema_MatrixValues
+///
+/// Test that the values of a matrix are found by column and row, whether
+/// added cell by cell, as an owned array or as a strided array of the
+/// caller's, and that storeValuesToPDU() encodes a region in row major order
+///
+/// \return true on pass
+///
+bool test_Schema_MatrixValues()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    ControlIdentity cell = schema.getIdentityForPath( "/matrix/2/3" );
+    Descriptor::DescriptorPtr d = schema.getDescriptor( cell );
+    r &= d->getWidth() == 4 && d->getHeight() == 3 && d->getNumValues() == 1 && d->getValueName( 0, 3, 2 ) == "gain";
+    for ( size_t row = 0; row < 3; ++row )
+    {
+        for ( size_t col = 0; col < 4; ++col )
+        {
+            r &= d->getRangedValue( 0, col, row ) == &t.m_processing.m_matrix[row][col];
+        }
+    }
+    r &= schema.setValue( nullptr, Milliseconds( 0 ), -3.0f, cell ) && t.m_processing.m_matrix[1][2].getValue() == -3.0f;
+
+    Descriptor::MatrixPtr matrix
+        = Descriptor::makeMatrix( AVDECC_AEM_CONTROL_TYPE_GAIN, "Mix Matrix", AVDECC_CONTROL_VALUE_LINEAR_INT32 );
+    Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+    for ( uint16_t row = 0; row < 3; ++row )
+    {
+        matrix->addRow( configuration, row );
+    }
+    Gain *gains = matrix->addValues<Gain>( "gain", 5 );
+    // the caller's mutes are column major
+    std::array<Mute, 15> mutes;
+    matrix->addValues( "mute", mutes.data(), mutes.size(), 5, 1, 3 );
+    r &= matrix->getWidth() == 5 && matrix->getHeight() == 3 && matrix->getNumValues() == 2;
+    r &= matrix->getValueName( 1, 4, 2 ) == "mute" && matrix->getValue( 0, 1, 1 ).m_ranged_value == &gains[6];
+    r &= matrix->getRangedValue( 1, 4, 1 ) == &mutes[13];
+    r &= matrix->getValues( 0 ).getRow<Gain>( 2 ) == gains + 10 && matrix->getValues( 0 ).getRow<Mute>( 2 ) == nullptr;
+    r &= matrix->getValues( 1 ).getRow<Mute>( 2 ) == &mutes[2] && matrix->getValues( 1 ).getColumnStride() == 3;
+
+    for ( size_t i = 0; i < 15; ++i )
+    {
+        gains[i].setValue( -float( i ) );
+        mutes[i].setValue( i % 2 == 1 );
+    }
+
+    uint8_t buf[64];
+    FixedBuffer pdu( buf, sizeof( buf ) );
+    matrix->storeValuesToPDU( pdu, 0, 1, 1, 3, 2 );
+    matrix->storeValuesToPDU( pdu, 1, 3, 0, 2, 3 );
+    r &= pdu.getLength() == 3 * 2 * 4 + 2 * 3;
+    for ( uint16_t row = 1; row < 3; ++row )
+    {
+        for ( uint16_t col = 1; col < 4; ++col )
+        {
+            r &= int32_t( pdu.getQuadlet( ( ( row - 1 ) * 3 + col - 1 ) * 4 ) ) == gains[row * 5 + col].getEncodedValueInt32();
+        }
+    }
+    for ( uint16_t row = 0; row < 3; ++row )
+    {
+        for ( uint16_t col = 3; col < 5; ++col )
+        {
+            r &= pdu.getOctet( 24 + row * 2 + col - 3 ) == mutes[col * 3 + row].getEncodedValueUInt8();
+        }
+    }
+
+    bool threw = false;
+    try
+    {
+        matrix->storeValuesToPDU( pdu, 0, 4, 0, 2, 1 );
+    }
+    catch ( std::range_error const & )
+    {
+        threw = true;
+    }
+    r &= threw;
+
+    threw = false;
+    try
+    {
+        matrix->addRow( configuration, 3 );
+    }
+    catch ( std::runtime_error const & )
+    {
+        threw = true;
+    }
+    r &= threw && matrix->getHeight() == 3;
+
+    threw = false;
+    try
+    {
+        matrix->addValues( "mute", mutes.data(), mutes.size() - 1, 5, 1, 3 );
+    }
+    catch ( std::runtime_error const & )
+    {
+        threw = true;
+    }
+    r &= threw && matrix->getNumValues() == 2;
+
+    // control_value_type comes before control_type, and the value details of both kinds follow the header
+    uint8_t descriptor_buf[256];
+    FixedBuffer descriptor( descriptor_buf, sizeof( descriptor_buf ) );
+    matrix->storeToPDU( descriptor );
+    r &= descriptor.getDoublet( 80 ) == AVDECC_CONTROL_VALUE_LINEAR_INT32
+         && descriptor.getEUI64( 82 ) == Eui64( AVDECC_AEM_CONTROL_TYPE_GAIN ) && descriptor.getDoublet( 90 ) == 5
+         && descriptor.getDoublet( 92 ) == 3 && descriptor.getDoublet( 94 ) == 102 && descriptor.getDoublet( 96 ) == 2
+         && descriptor.getDoublet( 98 ) == 3;
+    r &= descriptor.getLength() == 102 + ( 5 * 4 + 4 ) + ( 5 * 1 + 4 );
+    r &= int32_t( descriptor.getQuadlet( 102 ) ) == -900 && int32_t( descriptor.getQuadlet( 114 ) ) == 0;
+
+    return r;
+}
+
+///
+/// \brief test_Schema_SnapshotRestore
+///
+/// Test that a snapshot restores the captured values, writes only the
+/// controls which differ, and survives a round trip through its blob
+///
+/// \return true on pass
+///
+bool test_Schema_SnapshotRestore()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), -12.0f, SchemaAddress{"input", "2", "gain"} );
+    schema.setValue( nullptr, Milliseconds( 0 ), true, SchemaAddress{"input", "9", "mute"} );
+    schema.setValue( nullptr, Milliseconds( 0 ), -3.0f, SchemaAddress{"matrix", "3", "4"} );
+
+    SchemaSnapshot snapshot = SchemaSnapshot::capture( schema );
+    r &= snapshot.getNumItems() == schema.getValueIndex().size();
+
+    // nothing differs from live state
+    r &= snapshot.restore( schema, nullptr, Milliseconds( 0 ) ) == 0;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), 0.0f, SchemaAddress{"input", "2", "gain"} );
+    schema.setValue( nullptr, Milliseconds( 0 ), false, SchemaAddress{"input", "9", "mute"} );
+    schema.setValue( nullptr, Milliseconds( 0 ), -20.0f, SchemaAddress{"input", "4", "gain"} );
+
+    SchemaSnapshot reloaded( snapshot.getBlob() );
+    r &= reloaded.getNumItems() == snapshot.getNumItems();
+    r &= reloaded.restore( schema, nullptr, Milliseconds( 0 ) ) == 3;
+    r &= t.m_processing.m_input[1].m_gain.getValue() == -12.0f;
+    r &= t.m_processing.m_input[8].m_mute.getValue() == true;
+    r &= t.m_processing.m_input[3].m_gain.getValue() == 0.0f;
+    r &= t.m_processing.m_matrix[2][3].getValue() == -3.0f;
+    return r;
+}
+
+///
+/// \brief test_Schema_SnapshotPartial
+///
+/// Test a snapshot of the controls selected by a comparator, and that
+/// malformed blobs are rejected
+///
+/// \return true on pass
+///
+bool test_Schema_SnapshotPartial()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+
+    ControlIdentityComparatorSetPtr selection = std::make_shared<ControlIdentityComparatorSet>();
+    selection->addItem( schema.getIdentityForPath( "/input/1/gain" ) );
+    selection->addItem( schema.getIdentityForPath( "/input/1/mute" ) );
+
+    schema.setValue( nullptr, Milliseconds( 0 ), -6.0f, SchemaAddress{"input", "1", "gain"} );
+    SchemaSnapshot snapshot = SchemaSnapshot::capture( schema, selection );
+    r &= snapshot.getNumItems() == 2;
+
+    schema.setValue( nullptr, Milliseconds( 0 ), 0.0f, SchemaAddress{"input", "1", "gain"} );
+    schema.setValue( nullptr, Milliseconds( 0 ), 0.0f, SchemaAddress{"input", "2", "gain"} );
+    schema.setValue( nullptr, Milliseconds( 0 ), -1.0f, SchemaAddress{"input", "2", "gain"} );
+
+    // restoring into a read only control is skipped
+    r &= snapshot.restore( schema, selection, Milliseconds( 0 ) ) == 0;
+    r &= snapshot.restore( schema, nullptr, Milliseconds( 0 ) ) == 1;
+    r &= t.m_processing.m_input[0].m_gain.getValue() == -6.0f;
+    r &= t.m_processing.m_input[1].m_gain.getValue() == -1.0f;
+
+    std::vector<uint8_t> truncated = snapshot.getBlob();
+    truncated.pop_back();
+    for ( auto const &blob : {truncated, std::vector<uint8_t>{'C', 'P', 'S', 'S'}} )
+    {
+        try
+        {
+            SchemaSnapshot bad( blob );
+            r = false;
+        }
+        catch ( SchemaErrorSnapshot const & )
+        {
+        }
+    }
+    return r;
+}
+
+int main()
+{
+    bool r = true;
+
+    TEST( "address trie", test_Schema_TrieMatchesAddressMap(), true );
+    TEST( "address trie", test_Schema_IdentityForPath(), true );
+    TEST( "value index", test_Schema_ValueIndex(), true );
+    TEST( "static layout", test_Schema_StaticLayout(), true );
+    TEST( "batch", test_Schema_ApplyBatch(), true );
+    TEST( "batch", test_Schema_ApplyBatchRollback(), true );
+    TEST( "notifier", test_Schema_NotifierSchedule(), true );
+    TEST( "notifier", test_Schema_NotifierIndex(), true );
+    TEST( "notifier", test_Schema_ChangedBitmap(), true );
+    TEST( "notifier", test_Schema_MeterSubscription(), true );
+    TEST( "notifier", test_Schema_ChangeJournal(), true );
+    TEST( "notifier", test_Schema_HoldCoalesces(), true );
+    TEST( "notifier", test_Schema_NotifierStats(), true );
+    TEST( "notifier", test_Schema_RangePrefixComparators(), true );
+    TEST( "handle", test_Schema_ControlHandle(), true );
+    TEST( "matrix", test_Schema_MatrixValues(), true );
+    TEST( "snapshot", test_Schema_SnapshotRestore(), true );
+    TEST( "snapshot", test_Schema_SnapshotPartial(), true );
+
+    return r == true ? 0 : 255;
+}
@@ -0,0 +1,458 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/ChangeNotifier.hpp"
+#include "TestSchema.hpp"
+
+#define TEST( testname, func, expected )                                                                                       \
+    do                                                                                                                         \
+    {                                                                                                                          \
+        bool e = ( func == expected );                                                                                         \
+        r &= e;                                                                                                                \
+        std::cout << ( e ? "PASS" : "FAIL" ) << " : " << testname << " : " << #func << std::endl;                              \
+    } while ( false )
+
+static const std::chrono::milliseconds run_time( 150 );
+
+///
+/// \brief runReaders
+///
+/// Run num_readers threads that read every input gain and mute as fast as
+/// they can while one writer thread keeps changing them
+///
+/// \param t The schema under test
+/// \param num_readers The number of reader threads
+/// \param reads Filled in with the total number of reads done
+/// \return true if every value read was inside its range
+///
+static bool runReaders( TestSchema &t, unsigned num_readers, uint64_t *reads )
+{
+    Schema &schema = *t.m_schema;
+    std::vector<ControlIdentity> gains;
+    std::vector<ControlIdentity> mutes;
+    for ( size_t chan = 0; chan < t.m_processing.m_input.size(); ++chan )
+    {
+        gains.push_back( schema.getIdentityForAddress( SchemaAddress{"input", formstring( chan + 1 ), "gain"} ) );
+        mutes.push_back( schema.getIdentityForAddress( SchemaAddress{"input", formstring( chan + 1 ), "mute"} ) );
+    }
+
+    Gain const limits;
+    std::atomic<bool> running( true );
+    std::atomic<bool> valid( true );
+    std::atomic<uint64_t> total_reads( 0 );
+
+    std::vector<std::thread> threads;
+    for ( unsigned n = 0; n < num_readers; ++n )
+    {
+        threads.push_back( std::thread( [&]()
+                                        {
+            uint64_t count = 0;
+            while ( running )
+            {
+                for ( size_t chan = 0; chan < gains.size(); ++chan )
+                {
+                    float gain = 0.0f;
+                    bool mute = false;
+                    schema.getValue( &gain, gains[chan] );
+                    schema.getValue( &mute, mutes[chan] );
+                    if ( gain < limits.getMinValue() || gain > limits.getMaxValue() )
+                    {
+                        valid = false;
+                    }
+                    count += 2;
+                }
+            }
+            total_reads += count;
+        } ) );
+    }
+
+    std::thread writer( [&]()
+                        {
+        float gain = 0.0f;
+        while ( running )
+        {
+            for ( size_t chan = 0; chan < gains.size(); ++chan )
+            {
+                schema.setValue( nullptr, Milliseconds( 0 ), gain, gains[chan] );
+                schema.setValue( nullptr, Milliseconds( 0 ), gain < -20.0f, mutes[chan] );
+            }
+            gain = gain < -39.0f ? 0.0f : gain - 1.0f;
+            std::this_thread::yield();
+        }
+    } );
+
+    std::this_thread::sleep_for( run_time );
+    running = false;
+    writer.join();
+    for ( auto &i : threads )
+    {
+        i.join();
+    }
+
+    *reads = total_reads;
+    return valid;
+}
+
+///
+/// \brief test_SchemaConcurrency_ReaderScaling
+///
+/// Run the readers with 1, 2, 4 and hardware_concurrency threads and report
+/// the read throughput of each relative to a single reader. The scaling is
+/// only reported since it depends on the machine; the test checks that all
+/// of the values read were valid.
+///
+/// \return true on pass
+///
+bool test_SchemaConcurrency_ReaderScaling()
+{
+    bool r = true;
+    TestSchema t;
+
+    std::vector<unsigned> reader_counts{1, 2, 4};
+    unsigned cores = std::thread::hardware_concurrency();
+    if ( cores > 4 )
+    {
+        reader_counts.push_back( cores );
+    }
+
+    double single_rate = 0.0;
+    for ( unsigned num_readers : reader_counts )
+    {
+        uint64_t reads = 0;
+        r &= runReaders( t, num_readers, &reads );
+
+        double rate = double( reads ) / ( double( run_time.count() ) / 1000.0 );
+        if ( num_readers == 1 )
+        {
+            single_rate = rate;
+        }
+        std::cout << "readers: " << num_readers << " reads/sec: " << uint64_t( rate )
+                  << " speedup: " << ( single_rate > 0.0 ? rate / single_rate : 0.0 ) << std::endl;
+        r &= reads > 0;
+    }
+    return r;
+}
+
+///
+/// \brief test_SchemaConcurrency_NotifyWhileWriting
+///
+/// Test that a change notification callback which reads back through the
+/// schema can run on one thread while another thread writes values,
+/// without deadlocking on the schema and change manager locks
+///
+/// \return true on pass
+///
+bool test_SchemaConcurrency_NotifyWhileWriting()
+{
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain_identity = schema.getIdentityForAddress( SchemaAddress{"input", "1", "gain"} );
+
+    std::atomic<uint64_t> notifications( 0 );
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorAll>( schema ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+        float gain = 0.0f;
+        for ( auto const &i : items )
+        {
+            if ( i.toIdentity() == gain_identity )
+            {
+                schema.getValue( &gain, gain_identity );
+            }
+        }
+        ++notifications;
+    } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+
+    std::atomic<bool> running( true );
+    std::atomic<int64_t> now( 0 );
+    std::thread writer( [&]()
+                        {
+        int64_t count = 0;
+        while ( running )
+        {
+            schema.setValue( nullptr, Milliseconds( now ), float( -( ++count % 40 ) ), gain_identity );
+        }
+    } );
+
+    auto end_time = std::chrono::steady_clock::now() + run_time;
+    while ( std::chrono::steady_clock::now() < end_time )
+    {
+        schema.getChangeManager().tick( Milliseconds( ++now ) );
+        std::this_thread::yield();
+    }
+    running = false;
+    writer.join();
+
+    schema.getChangeManager().removeChangeNotifier( notifier->getIdentity() );
+    return notifications > 0;
+}
+
+///
+/// \brief test_SchemaConcurrency_AsyncDelivery
+///
+/// Test that with a ChangeDeliveryPool a blocked subscriber does not stall
+/// tick() or a fast subscriber, that its changes are merged while its
+/// queue is full instead of being lost, and that a throwing subscriber is
+/// counted and does not stop delivery
+///
+/// \return true on pass
+///
+bool test_SchemaConcurrency_AsyncDelivery()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain_identity = schema.getIdentityForAddress( SchemaAddress{"input", "1", "gain"} );
+    ControlIdentity mute_identity = schema.getIdentityForAddress( SchemaAddress{"input", "1", "mute"} );
+
+    ChangeDeliveryPoolPtr pool = std::make_shared<ChangeDeliveryPool>( 2 );
+
+    std::atomic<uint64_t> fast_notifications( 0 );
+    std::atomic<uint64_t> slow_notifications( 0 );
+    std::atomic<bool> slow_saw_mute( false );
+
+    // the slow subscriber blocks its worker until the latch is opened
+    std::mutex latch_mutex;
+    std::condition_variable latch_condition;
+    bool latch_open = false;
+
+    ChangeNotifierPtr fast = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    fast->setDeliveryPool( pool );
+    fast->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain_identity ),
+                           Milliseconds( 1 ),
+                           Milliseconds( 0 ),
+                           Milliseconds( 0 ),
+                           [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const & )
+                           {
+        ++fast_notifications;
+    } );
+
+    ChangeNotifierPtr slow = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    slow->setDeliveryPool( pool, 1 );
+    slow->addSubscription( std::make_shared<ControlIdentityComparatorAll>( schema ),
+                           Milliseconds( 1 ),
+                           Milliseconds( 0 ),
+                           Milliseconds( 0 ),
+                           [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                           {
+        if ( items.contains( mute_identity ) )
+        {
+            slow_saw_mute = true;
+        }
+        ++slow_notifications;
+        std::unique_lock<std::mutex> lock( latch_mutex );
+        latch_condition.wait( lock, [&]()
+                              {
+            return latch_open;
+        } );
+    } );
+
+    std::atomic<uint64_t> failing_notifications( 0 );
+    ChangeNotifierPtr failing = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    failing->setDeliveryPool( pool );
+    failing->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain_identity ),
+                              Milliseconds( 1 ),
+                              Milliseconds( 0 ),
+                              Milliseconds( 0 ),
+                              [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const & )
+                              {
+        // alternate between a std::exception and something else
+        if ( ++failing_notifications % 2 )
+        {
+            throw std::runtime_error( "subscriber failed" );
+        }
+        throw 1;
+    } );
+
+    schema.getChangeManager().addChangeNotifier( fast );
+    schema.getChangeManager().addChangeNotifier( slow );
+    schema.getChangeManager().addChangeNotifier( failing );
+
+    // while the slow subscriber is blocked, tick() keeps returning and the fast subscriber keeps being delivered
+    int64_t now = 0;
+    int i = 0;
+    auto end_time = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+    while ( ( i < 50 || fast_notifications < 10 || failing_notifications < 2 ) && std::chrono::steady_clock::now() < end_time )
+    {
+        schema.setValue( nullptr, Milliseconds( ++now ), float( -( i % 40 ) - 1 ), gain_identity );
+        if ( i == 10 )
+        {
+            schema.setValue( nullptr, Milliseconds( now ), true, mute_identity );
+        }
+        schema.getChangeManager().tick( Milliseconds( ++now ) );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        ++i;
+    }
+    r &= fast_notifications >= 10;
+    r &= slow_notifications == 1 && !slow_saw_mute;
+
+    {
+        std::lock_guard<std::mutex> lock( latch_mutex );
+        latch_open = true;
+    }
+    latch_condition.notify_all();
+
+    // keep ticking until the slow subscriber has caught up with the merged changes
+    end_time = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+    while ( !slow_saw_mute && std::chrono::steady_clock::now() < end_time )
+    {
+        schema.getChangeManager().tick( Milliseconds( ++now ) );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+    }
+
+    schema.getChangeManager().removeChangeNotifier( fast );
+    schema.getChangeManager().removeChangeNotifier( slow );
+    schema.getChangeManager().removeChangeNotifier( failing );
+    uint64_t failures = failing->getCallbackFailures();
+    fast.reset();
+    slow.reset();
+    failing.reset();
+    pool.reset();
+
+    std::cout << "async delivery: fast " << fast_notifications << " slow " << slow_notifications << std::endl;
+
+    r &= slow_saw_mute;
+    // a callback may still be running when the failures are read
+    r &= failures > 1;
+    r &= failures <= failing_notifications;
+    return r;
+}
+
+///
+/// \brief test_SchemaConcurrency_ReenterDuringClose
+///
+/// Test that the delivery pool of a notifier can be removed while one of
+/// its callbacks is running and calls back into the notifier
+///
+/// \return true on pass
+///
+bool test_SchemaConcurrency_ReenterDuringClose()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain_identity = schema.getIdentityForAddress( SchemaAddress{"input", "1", "gain"} );
+
+    ChangeDeliveryPoolPtr pool = std::make_shared<ChangeDeliveryPool>( 1 );
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    ChangeNotifier *raw_notifier = notifier.get();
+    std::atomic<bool> entered( false );
+    std::atomic<bool> reentered( false );
+
+    notifier->setDeliveryPool( pool );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain_identity ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const & )
+                               {
+        entered = true;
+        // give setDeliveryPool() below time to start waiting for this callback
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+        raw_notifier->isStatsEnabled();
+        reentered = true;
+    } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+
+    schema.setValue( nullptr, Milliseconds( 1 ), -6.0f, gain_identity );
+    schema.getChangeManager().tick( Milliseconds( 2 ) );
+    while ( !entered )
+    {
+        std::this_thread::yield();
+    }
+
+    // waits for the callback, which must be able to take the notifier's lock meanwhile
+    notifier->setDeliveryPool( nullptr );
+    r &= reentered;
+
+    schema.getChangeManager().removeChangeNotifier( notifier );
+    return r;
+}
+
+///
+/// \brief test_SchemaConcurrency_RealtimeIngress
+///
+/// Test that changes reported by a real time thread through a
+/// RealtimeChangeIngress reach a subscriber when the manager ticks
+///
+/// \return true on pass
+///
+bool test_SchemaConcurrency_RealtimeIngress()
+{
+    bool r = true;
+    TestSchema t;
+    Schema &schema = *t.m_schema;
+    ControlIdentity gain_identity = schema.getIdentityForAddress( SchemaAddress{"input", "1", "gain"} );
+    ControlIdentityKey gain_key( gain_identity );
+
+    std::atomic<uint64_t> notifications( 0 );
+    std::atomic<float> last_gain( 0.0f );
+    ChangeNotifierPtr notifier = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+    notifier->addSubscription( std::make_shared<ControlIdentityComparatorUnique>( gain_identity ),
+                               Milliseconds( 1 ),
+                               Milliseconds( 0 ),
+                               Milliseconds( 0 ),
+                               [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const &items )
+                               {
+        if ( items.contains( gain_key ) )
+        {
+            last_gain = t.m_processing.m_input[0].m_gain.getValue();
+            ++notifications;
+        }
+    } );
+    schema.getChangeManager().addChangeNotifier( notifier );
+    RealtimeChangeIngressPtr ingress = schema.getChangeManager().addRealtimeIngress( 64 );
+
+    std::atomic<bool> running( true );
+    std::atomic<uint64_t> pushed( 0 );
+    std::thread dsp( [&]()
+                     {
+        int count = 0;
+        while ( running )
+        {
+            t.m_processing.m_input[0].m_gain.setValue( float( -( ++count % 40 ) ) );
+            if ( ingress->controlChanged( gain_key ) )
+            {
+                ++pushed;
+            }
+            std::this_thread::yield();
+        }
+        t.m_processing.m_input[0].m_gain.setValue( -6.0f );
+        ingress->controlChanged( gain_key );
+    } );
+
+    int64_t now = 0;
+    auto end_time = std::chrono::steady_clock::now() + run_time;
+    while ( std::chrono::steady_clock::now() < end_time )
+    {
+        schema.getChangeManager().tick( Milliseconds( ++now ) );
+        std::this_thread::yield();
+    }
+    running = false;
+    dsp.join();
+    schema.getChangeManager().tick( Milliseconds( ++now ) );
+
+    r &= pushed > 0 && notifications > 0;
+    r &= last_gain == -6.0f;
+
+    schema.getChangeManager().removeRealtimeIngress( ingress );
+    schema.getChangeManager().removeChangeNotifier( notifier );
+    return r;
+}
+
+int main()
+{
+    bool r = true;
+
+    TEST( "reader scaling", test_SchemaConcurrency_ReaderScaling(), true );
+    TEST( "notify while writing", test_SchemaConcurrency_NotifyWhileWriting(), true );
+    TEST( "async delivery", test_SchemaConcurrency_AsyncDelivery(), true );
+    TEST( "reenter during close", test_SchemaConcurrency_ReenterDuringClose(), true );
+    TEST( "realtime ingress", test_SchemaConcurrency_RealtimeIngress(), true );
+
+    return r == true ? 0 : 255;
+}
@@ -0,0 +1,191 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaPersistentStore.hpp"
+#include "TestSchema.hpp"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#define TEST( testname, func, expected )                                                                                       \
+    do                                                                                                                         \
+    {                                                                                                                          \
+        bool e = ( func == expected );                                                                                         \
+        r &= e;                                                                                                                \
+        std::cout << ( e ? "PASS" : "FAIL" ) << " : " << testname << " : " << #func << std::endl;                              \
+    } while ( false )
+
+///
+/// \brief makeStorePath
+/// \return a path in the system temporary directory which is unique to this process
+///
+static std::string makeStorePath()
+{
+#ifdef _WIN32
+    char dir[MAX_PATH + 1];
+    DWORD length = GetTempPathA( sizeof( dir ), dir );
+    std::string r = formstring( std::string( dir, length ), "test_SchemaPersistentStore_", _getpid(), ".bin" );
+#else
+    const char *dir = getenv( "TMPDIR" );
+    std::string r = formstring( dir && *dir ? dir : "/tmp", "/test_SchemaPersistentStore_", getpid(), ".bin" );
+#endif
+    return r;
+}
+
+static const std::string store_path_string = makeStorePath();
+static const char *store_path = store_path_string.c_str();
+
+///
+/// \brief test_SchemaPersistentStore_Reload
+///
+/// Test that values written through the schema are in the file and are
+/// loaded again by a new schema with the same layout
+///
+/// \return true on pass
+///
+bool test_SchemaPersistentStore_Reload()
+{
+    bool r = true;
+    remove( store_path );
+    {
+        TestSchema t;
+        Schema &schema = *t.m_schema;
+        SchemaPersistentStorePtr store = std::make_shared<SchemaPersistentStore>( schema, store_path );
+        r &= store->open() == SchemaPersistentStore::OpenResult::Created;
+        schema.getChangeManager().addChangeNotifier( store );
+        store->sync();
+        r &= store->getLastSyncRangeCount() == 0;
+
+        schema.setValue( nullptr, Milliseconds( 10 ), -12.0f, SchemaAddress{"input", "2", "gain"} );
+        schema.setValue( nullptr, Milliseconds( 10 ), true, SchemaAddress{"input", "16", "mute"} );
+        schema.setValue( nullptr, Milliseconds( 10 ), -3.0f, SchemaAddress{"matrix", "3", "4"} );
+
+        // not flushed before the sync period has passed
+        schema.getChangeManager().tick( Milliseconds( 50 ) );
+        r &= store->getLastSyncRangeCount() == 0;
+        schema.getChangeManager().tick( Milliseconds( 150 ) );
+        r &= store->getLastSyncRangeCount() >= 1;
+
+        schema.getChangeManager().removeChangeNotifier( store );
+    }
+    {
+        TestSchema t;
+        SchemaPersistentStore store( *t.m_schema, store_path );
+        r &= store.open() == SchemaPersistentStore::OpenResult::Loaded;
+        r &= t.m_processing.m_input[1].m_gain.getValue() == -12.0f;
+        r &= t.m_processing.m_input[15].m_mute.getValue() == true;
+        r &= t.m_processing.m_matrix[2][3].getValue() == -3.0f;
+        r &= t.m_processing.m_input[0].m_gain.getValue() == 0.0f;
+    }
+    remove( store_path );
+    return r;
+}
+
+///
+/// \brief test_SchemaPersistentStore_Coalesce
+///
+/// Test that adjacent dirty slots are flushed as a single range
+///
+/// \return true on pass
+///
+bool test_SchemaPersistentStore_Coalesce()
+{
+    bool r = true;
+    remove( store_path );
+    {
+        TestSchema t;
+        Schema &schema = *t.m_schema;
+        SchemaPersistentStorePtr store = std::make_shared<SchemaPersistentStore>( schema, store_path );
+        store->open();
+        schema.getChangeManager().addChangeNotifier( store );
+
+        std::vector<ControlValueChange> batch;
+        for ( size_t chan = 0; chan < t.m_processing.m_input.size(); ++chan )
+        {
+            batch.push_back( ControlValueChange( schema.getIdentityForPath( formstring( "/input/", chan + 1, "/mute" ) ), true ) );
+        }
+        schema.applyBatch( nullptr, Milliseconds( 0 ), batch );
+        store->sync();
+        r &= store->getLastSyncRangeCount() == 1;
+
+        store->sync();
+        r &= store->getLastSyncRangeCount() == 0;
+        schema.getChangeManager().removeChangeNotifier( store );
+    }
+    remove( store_path );
+    return r;
+}
+
+///
+/// \brief test_SchemaPersistentStore_LayoutChange
+///
+/// Test that a file with a different schema hash has its matching values
+/// migrated, and that an unusable file is replaced by the live values
+///
+/// \return true on pass
+///
+bool test_SchemaPersistentStore_LayoutChange()
+{
+    bool r = true;
+    remove( store_path );
+    {
+        TestSchema t;
+        SchemaPersistentStore store( *t.m_schema, store_path );
+        store.open();
+        t.m_schema->setValue( nullptr, Milliseconds( 0 ), -20.0f, SchemaAddress{"input", "5", "gain"} );
+        store.controlChanged( Milliseconds( 0 ), t.m_schema->getIdentityForPath( "/input/5/gain" ) );
+    }
+
+    // pretend the file was written by firmware with a different schema
+    FILE *f = fopen( store_path, "r+b" );
+    fseek( f, offsetof( SchemaPersistentStore::FileHeader, m_schema_hash ), SEEK_SET );
+    uint64_t other_hash = 1234;
+    fwrite( &other_hash, sizeof( other_hash ), 1, f );
+    fclose( f );
+
+    {
+        TestSchema t;
+        SchemaPersistentStore store( *t.m_schema, store_path );
+        r &= store.open() == SchemaPersistentStore::OpenResult::Migrated;
+        r &= t.m_processing.m_input[4].m_gain.getValue() == -20.0f;
+
+        // the new layout was written beside the old file and renamed over it
+        FILE *temp = fopen( ( std::string( store_path ) + ".tmp" ).c_str(), "rb" );
+        r &= temp == nullptr;
+        if ( temp )
+        {
+            fclose( temp );
+        }
+    }
+    {
+        TestSchema t;
+        SchemaPersistentStore store( *t.m_schema, store_path );
+        r &= store.open() == SchemaPersistentStore::OpenResult::Loaded;
+        r &= t.m_processing.m_input[4].m_gain.getValue() == -20.0f;
+    }
+
+    f = fopen( store_path, "r+b" );
+    fwrite( "XXXX", 4, 1, f );
+    fclose( f );
+    {
+        TestSchema t;
+        SchemaPersistentStore store( *t.m_schema, store_path );
+        r &= store.open() == SchemaPersistentStore::OpenResult::Created;
+        r &= t.m_processing.m_input[4].m_gain.getValue() == 0.0f;
+    }
+    remove( store_path );
+    return r;
+}
+
+int main()
+{
+    bool r = true;
+
+    TEST( "persistence", test_SchemaPersistentStore_Reload(), true );
+    TEST( "persistence", test_SchemaPersistentStore_Coalesce(), true );
+    TEST( "persistence", test_SchemaPersistentStore_LayoutChange(), true );
+
+    return r == true ? 0 : 255;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ControlPlane/World.hpp"
+
+///
+/// Counting replacements of every form of the global operator new and
+/// operator delete, for the benchmarks which report the heap allocations
+/// of a phase. Include it in the one source file of a tools-dev program.
+///
+/// The operators only call countedAllocate() and countedFree(), which are
+/// kept out of line so that the compiler does not pair an inlined free()
+/// with the operator new of the caller.
+///
+
+static size_t allocation_count = 0;
+static size_t allocation_bytes = 0;
+
+#if defined( __GNUC__ )
+#define CONTROLPLANE_ALLOCATION_COUNTER_NOINLINE __attribute__( ( noinline ) )
+#elif defined( _MSC_VER )
+#define CONTROLPLANE_ALLOCATION_COUNTER_NOINLINE __declspec( noinline )
+#else
+#define CONTROLPLANE_ALLOCATION_COUNTER_NOINLINE
+#endif
+
+CONTROLPLANE_ALLOCATION_COUNTER_NOINLINE static void *countedAllocate( size_t size ) noexcept
+{
+    ++allocation_count;
+    allocation_bytes += size;
+    return malloc( size ? size : 1 );
+}
+
+CONTROLPLANE_ALLOCATION_COUNTER_NOINLINE static void countedFree( void *p ) noexcept { free( p ); }
+
+void *operator new( size_t size )
+{
+    void *p = countedAllocate( size );
+    if ( !p )
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[]( size_t size )
+{
+    void *p = countedAllocate( size );
+    if ( !p )
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new( size_t size, std::nothrow_t const & ) noexcept { return countedAllocate( size ); }
+
+void *operator new[]( size_t size, std::nothrow_t const & ) noexcept { return countedAllocate( size ); }
+
+void operator delete( void *p ) noexcept { countedFree( p ); }
+
+void operator delete[]( void *p ) noexcept { countedFree( p ); }
+
+void operator delete( void *p, std::nothrow_t const & ) noexcept { countedFree( p ); }
+
+void operator delete[]( void *p, std::nothrow_t const & ) noexcept { countedFree( p ); }
+
+#if defined( __cpp_sized_deallocation )
+void operator delete( void *p, size_t ) noexcept { countedFree( p ); }
+
+void operator delete[]( void *p, size_t ) noexcept { countedFree( p ); }
+#endif
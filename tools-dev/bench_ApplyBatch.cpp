@@ -0,0 +1,121 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of Schema::applyBatch() with a batch of about 5000 gain
+/// changes made by repeating every gain of the schema, against the same
+/// changes written one at a time with Schema::setValue()
+///
+
+static const size_t num_channels = 16;
+static const size_t batch_size = 5000;
+static const size_t iterations = 20;
+
+struct BenchChannel
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct BenchProcessing
+{
+    std::vector<BenchChannel> m_input;
+    Descriptor::EntityInfo m_entity;
+
+    BenchProcessing() : m_input( num_channels ) {}
+};
+
+class BenchSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    BenchProcessing *m_processing;
+
+  public:
+    BenchSchemaGenerator( ControlContainerPtr root, BenchProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Bench Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_input = m_root->addItem( "input" );
+        for ( size_t chan = 0; chan < m_processing->m_input.size(); ++chan )
+        {
+            ControlContainerPtr schema_chan = schema_input->addItem( formstring( chan + 1 ) );
+            Descriptor::ControlPtr gain = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_GAIN,
+                                                                   formstring( "Input ", chan + 1, " Gain" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_INT32,
+                                                                   ControlValue{"gain", &m_processing->m_input[chan].m_gain} );
+            configuration->addChildDescriptor( gain );
+            schema_chan->addItem( "gain", gain );
+
+            Descriptor::ControlPtr mute = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_MUTE,
+                                                                   formstring( "Input ", chan + 1, " Mute" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_UINT8,
+                                                                   ControlValue{"mute", &m_processing->m_input[chan].m_mute} );
+            configuration->addChildDescriptor( mute );
+            schema_chan->addItem( "mute", mute );
+        }
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+template <typename F>
+static double timeIt( F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        f();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( iterations );
+}
+
+int main()
+{
+    BenchProcessing processing;
+    ControlContainerPtr top = ControlContainer::create();
+    BenchSchemaGenerator generator( top, &processing );
+    generator.generate();
+    Schema schema( top );
+
+    std::vector<ControlValueChange> batch;
+    float gain = -1.0f;
+    while ( batch.size() < batch_size )
+    {
+        for ( size_t chan = 0; chan < num_channels; ++chan )
+        {
+            ControlIdentity identity = schema.getIdentityForPath( formstring( "/input/", chan + 1, "/gain" ) );
+            batch.push_back( ControlValueChange( identity, gain ) );
+        }
+        gain = gain < -80.0f ? -1.0f : gain - 1.0f;
+    }
+
+    double batch_us = timeIt( [&]() { schema.applyBatch( nullptr, Milliseconds( 0 ), batch ); } );
+    double single_us = timeIt( [&]()
+                               {
+        for ( auto const &change : batch )
+        {
+            schema.setValue( nullptr, Milliseconds( 0 ), change.getDouble(), change.getIdentity() );
+        }
+    } );
+    schema.getChangeManager().tick( Milliseconds( 0 ) );
+
+    std::cout << batch.size() << " changes: applyBatch " << batch_us << " us, setValue one at a time " << single_us << " us"
+              << std::endl;
+
+    return processing.m_input[0].m_gain.getValue() == float( batch.back().getDouble() ) ? 0 : 255;
+}
@@ -0,0 +1,122 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/BulkEncoding.hpp"
+#include "ControlPlane/FixedBuffer.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+
+///
+/// Benchmark of encoding the 65536 gains of a 256 x 256 matrix to big endian
+/// int32 and decoding them back, one value at a time through the virtual
+/// RangedValueBase interface and FixedBuffer::putQuadlet(), against the bulk
+/// functions with each kernel
+///
+
+static const size_t matrix_size = 256 * 256;
+static const size_t values_per_buffer = 8192;
+static const size_t iterations = 50;
+
+template <typename F>
+static double timeIt( F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        f();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( iterations );
+}
+
+static const char *getKernelName( BulkEncodingKernel kernel )
+{
+    return kernel == BulkEncodingKernel::AVX2 ? "AVX2" : kernel == BulkEncodingKernel::SSE2 ? "SSE2" : "scalar";
+}
+
+int main()
+{
+    std::vector<Gain> matrix( matrix_size );
+    std::vector<RangedValueBase *> bases;
+    for ( size_t i = 0; i < matrix_size; ++i )
+    {
+        matrix[i].setValue( -float( i % 900 ) / 10 );
+        bases.push_back( &matrix[i] );
+    }
+    std::vector<uint8_t> wire( matrix_size * 4 );
+    std::vector<Gain> decoded( matrix_size );
+
+    double virtual_encode_us = timeIt( [&]()
+                                       {
+        for ( size_t first = 0; first < matrix_size; first += values_per_buffer )
+        {
+            FixedBuffer buf( &wire[first * 4], uint16_t( values_per_buffer * 4 ) );
+            for ( size_t i = first; i < first + values_per_buffer; ++i )
+            {
+                buf.putQuadlet( uint32_t( bases[i]->getEncodedValueInt32() ) );
+            }
+        }
+    } );
+    std::vector<uint8_t> expected = wire;
+
+    std::vector<RangedValueBase *> decoded_bases;
+    for ( auto &v : decoded )
+    {
+        decoded_bases.push_back( &v );
+    }
+    double virtual_decode_us = timeIt( [&]()
+                                       {
+        for ( size_t first = 0; first < matrix_size; first += values_per_buffer )
+        {
+            FixedBuffer buf( &wire[first * 4], uint16_t( values_per_buffer * 4 ) );
+            for ( size_t i = first; i < first + values_per_buffer; ++i )
+            {
+                int32_t v = int32_t( buf.getQuadlet( uint16_t( ( i - first ) * 4 ) ) );
+                decoded_bases[i]->setFromEncodedValueWithClampInt32( v );
+            }
+        }
+    } );
+    std::cout << matrix_size << " gains, virtual per value: encode " << virtual_encode_us << " us, decode "
+              << virtual_decode_us << " us" << std::endl;
+
+    std::vector<float> floats( matrix_size );
+    for ( size_t i = 0; i < matrix_size; ++i )
+    {
+        floats[i] = matrix[i].getValue();
+    }
+
+    bool same = true;
+    BulkEncodingKernel best = getBulkEncodingKernel();
+    for ( BulkEncodingKernel kernel : {BulkEncodingKernel::Scalar, BulkEncodingKernel::SSE2, BulkEncodingKernel::AVX2} )
+    {
+        if ( setBulkEncodingKernel( kernel ) != kernel )
+        {
+            continue;
+        }
+
+        double encode_us = timeIt( [&]() { encodeRangedValuesInt32BigEndian( wire.data(), matrix.data(), matrix_size ); } );
+        same &= wire == expected;
+        double decode_us
+            = timeIt( [&]() { decodeRangedValuesInt32BigEndianWithClamp( decoded.data(), wire.data(), matrix_size ); } );
+
+        std::vector<float> out( matrix_size );
+        double float_encode_us = timeIt(
+            [&]()
+            {
+            encodeInt32BigEndian(
+                wire.data(), floats.data(), matrix_size, Gain::encoding_multiplier, Gain::encoding_divider, -900, 100 );
+        } );
+        same &= wire == expected;
+        double float_decode_us = timeIt(
+            [&]()
+            {
+            decodeInt32BigEndian( out.data(), wire.data(), matrix_size, Gain::decoding_multiplier, Gain::decoding_divider );
+        } );
+
+        std::cout << getKernelName( kernel ) << ": gains encode " << encode_us << " us, decode " << decode_us
+                  << " us; float arrays encode " << float_encode_us << " us, decode " << float_decode_us << " us" << std::endl;
+    }
+    setBulkEncodingKernel( best );
+
+    std::cout << ( same ? "all kernels match the virtual path" : "MISMATCH" ) << std::endl;
+    return same ? 0 : 255;
+}
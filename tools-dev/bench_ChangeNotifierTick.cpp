@@ -0,0 +1,81 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/ChangeNotifier.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of ChangeNotifier::controlChanged and ChangeNotifier::tick with
+/// many subscriptions, of which only a few have work to do on each tick: a
+/// number of controls change before each tick, and a small share of the
+/// subscriptions are refreshed periodically. The cost of a change should
+/// follow the number of subscriptions which want it, and the tick cost the
+/// number of changed and periodic subscriptions, not the total number of
+/// subscriptions.
+///
+
+static const size_t num_ticks = 1000;
+
+static void run( size_t num_subscriptions, size_t changes_per_tick, size_t num_periodic )
+{
+    size_t notifications = 0;
+    ChangeNotifier notifier( Milliseconds( 0 ) );
+    std::vector<ControlIdentity> identities;
+
+    for ( size_t i = 0; i < num_subscriptions; ++i )
+    {
+        ControlIdentity identity( AVDECC_DESCRIPTOR_CONTROL, uint16_t( i ) );
+        identities.push_back( identity );
+
+        bool periodic = i < num_periodic;
+        notifier.addSubscription( std::make_shared<ControlIdentityComparatorUnique>( identity ),
+                                  Milliseconds( periodic ? 0 : 5 ),
+                                  Milliseconds( periodic ? 100 : 0 ),
+                                  Milliseconds( 0 ),
+                                  [&]( Milliseconds, ControlIdentityComparatorPtr const &, ControlIdentityBitmap const & )
+                                  {
+                                      ++notifications;
+                                  } );
+    }
+
+    std::chrono::nanoseconds change_duration( 0 );
+    std::chrono::nanoseconds tick_duration( 0 );
+    size_t next_change = num_periodic;
+    size_t num_changes = 0;
+    for ( size_t tick = 1; tick <= num_ticks; ++tick )
+    {
+        Milliseconds now( tick );
+        auto change_start = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < changes_per_tick && num_subscriptions > num_periodic; ++i )
+        {
+            notifier.controlChanged( now, identities[next_change] );
+            if ( ++next_change == num_subscriptions )
+            {
+                next_change = num_periodic;
+            }
+            ++num_changes;
+        }
+        change_duration += std::chrono::steady_clock::now() - change_start;
+
+        auto start = std::chrono::steady_clock::now();
+        notifier.tick( now );
+        tick_duration += std::chrono::steady_clock::now() - start;
+    }
+
+    std::cout << std::setw( 8 ) << num_subscriptions << " subscriptions " << std::setw( 6 ) << changes_per_tick
+              << " changes/tick " << std::setw( 6 ) << num_periodic << " periodic: " << std::setw( 10 ) << std::fixed
+              << std::setprecision( 2 ) << double( tick_duration.count() ) / 1000.0 / num_ticks << " us/tick "
+              << std::setw( 10 ) << ( num_changes ? double( change_duration.count() ) / num_changes : 0.0 ) << " ns/change "
+              << std::setw( 10 ) << notifications << " notifications" << std::endl;
+}
+
+int main()
+{
+    for ( size_t num_subscriptions = 1000; num_subscriptions <= 64000; num_subscriptions *= 4 )
+    {
+        run( num_subscriptions, 0, 0 );
+        run( num_subscriptions, 10, 0 );
+        run( num_subscriptions, 10, 100 );
+    }
+    return 0;
+}
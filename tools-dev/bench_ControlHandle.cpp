@@ -0,0 +1,179 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of setting and getting the gains of a schema through
+/// Schema::setValue() and Schema::getValue() by identity, against the
+/// same through ControlHandle<Gain>, and through a ControlHandle writing
+/// to a RealtimeChangeIngress
+///
+
+static const size_t num_channels = 64;
+static const size_t num_rounds = 4000;
+
+struct BenchChannel
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct BenchProcessing
+{
+    std::vector<BenchChannel> m_input;
+    Descriptor::EntityInfo m_entity;
+
+    BenchProcessing() : m_input( num_channels ) {}
+};
+
+class BenchSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    BenchProcessing *m_processing;
+
+  public:
+    BenchSchemaGenerator( ControlContainerPtr root, BenchProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Bench Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_input = m_root->addItem( "input" );
+        for ( size_t chan = 0; chan < m_processing->m_input.size(); ++chan )
+        {
+            ControlContainerPtr schema_chan = schema_input->addItem( formstring( chan + 1 ) );
+            Descriptor::ControlPtr gain = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_GAIN,
+                                                                   formstring( "Input ", chan + 1, " Gain" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_INT32,
+                                                                   ControlValue{"gain", &m_processing->m_input[chan].m_gain} );
+            configuration->addChildDescriptor( gain );
+            schema_chan->addItem( "gain", gain );
+
+            Descriptor::ControlPtr mute = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_MUTE,
+                                                                   formstring( "Input ", chan + 1, " Mute" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_UINT8,
+                                                                   ControlValue{"mute", &m_processing->m_input[chan].m_mute} );
+            configuration->addChildDescriptor( mute );
+            schema_chan->addItem( "mute", mute );
+        }
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+template <typename F>
+static double timeIt( F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t round = 0; round < num_rounds; ++round )
+    {
+        f( round );
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( num_rounds * num_channels );
+}
+
+int main()
+{
+    BenchProcessing processing;
+    ControlContainerPtr top = ControlContainer::create();
+    BenchSchemaGenerator generator( top, &processing );
+    generator.generate();
+    Schema schema( top );
+
+    std::vector<ControlIdentity> identities;
+    std::vector<ControlHandle<Gain>> handles;
+    for ( size_t chan = 0; chan < num_channels; ++chan )
+    {
+        string path = formstring( "/input/", chan + 1, "/gain" );
+        identities.push_back( schema.getIdentityForPath( path ) );
+        handles.push_back( schema.getControlHandle<Gain>( nullptr, path ) );
+    }
+
+    // every write changes the value, so every write also reports a change
+    double schema_set_ns = timeIt( [&]( size_t round )
+                                   {
+        float v = -float( round % 900 ) / 10;
+        for ( auto const &identity : identities )
+        {
+            schema.setValue( nullptr, Milliseconds( 0 ), v, identity );
+        }
+        schema.getChangeManager().tick( Milliseconds( round ) );
+    } );
+
+    double handle_set_ns = timeIt( [&]( size_t round )
+                                   {
+        float v = -float( ( round + 1 ) % 900 ) / 10;
+        for ( auto &handle : handles )
+        {
+            handle.setValue( Milliseconds( 0 ), v );
+        }
+        schema.getChangeManager().tick( Milliseconds( round ) );
+    } );
+
+    RealtimeChangeIngressPtr ingress = schema.getChangeManager().addRealtimeIngress( num_channels );
+    double realtime_set_ns = timeIt( [&]( size_t round )
+                                     {
+        float v = -float( round % 900 ) / 10;
+        for ( auto &handle : handles )
+        {
+            handle.setValueRealtime( *ingress, v );
+        }
+        schema.getChangeManager().tick( Milliseconds( round ) );
+    } );
+    schema.getChangeManager().removeRealtimeIngress( ingress );
+
+    // writing the value a control already has reports nothing, leaving the cost of the write itself
+    double schema_same_ns = timeIt( [&]( size_t )
+                                    {
+        for ( auto const &identity : identities )
+        {
+            schema.setValue( nullptr, Milliseconds( 0 ), -1.0f, identity );
+        }
+    } );
+
+    double handle_same_ns = timeIt( [&]( size_t )
+                                    {
+        for ( auto &handle : handles )
+        {
+            handle.setValue( Milliseconds( 0 ), -1.0f );
+        }
+    } );
+
+    float sum = 0;
+    double schema_get_ns = timeIt( [&]( size_t )
+                                   {
+        for ( auto const &identity : identities )
+        {
+            float v;
+            schema.getValue( &v, identity );
+            sum += v;
+        }
+    } );
+
+    double handle_get_ns = timeIt( [&]( size_t )
+                                   {
+        for ( auto const &handle : handles )
+        {
+            sum += handle.getValue();
+        }
+    } );
+
+    std::cout << "set+tick per gain: Schema " << schema_set_ns << " ns, handle " << handle_set_ns << " ns, handle realtime "
+              << realtime_set_ns << " ns" << std::endl;
+    std::cout << "unchanged set per gain: Schema " << schema_same_ns << " ns, handle " << handle_same_ns << " ns" << std::endl;
+    std::cout << "get per gain: Schema " << schema_get_ns << " ns, handle " << handle_get_ns << " ns" << std::endl;
+
+    return sum != 0 ? 0 : 255;
+}
@@ -0,0 +1,177 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Descriptors.hpp"
+#include "ControlPlane/Values.hpp"
+#include "AllocationCounter.hpp"
+
+using namespace ControlPlane;
+
+///
+/// Benchmark of the storage of the values of a 256 x 256 gain matrix: the
+/// number and size of the heap allocations to build it, and the time to
+/// read every cross point and to encode every row to a PDU. The former
+/// nested vector<vector<vector<ControlValue>>> layout is compared with
+/// Matrix filled cell by cell with addValue(), and with Matrix holding the
+/// caller's array of Gain with addValues().
+///
+
+static const uint16_t matrix_size = 256;
+static const size_t iterations = 50;
+
+template <typename F>
+static double timeIt( F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        f();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( iterations );
+}
+
+template <typename F>
+static void countAllocations( const char *name, F f )
+{
+    size_t count = allocation_count;
+    size_t bytes = allocation_bytes;
+    f();
+    std::cout << name << ": " << ( allocation_count - count ) << " allocations, " << ( allocation_bytes - bytes ) / 1024
+              << " KiB" << std::endl;
+}
+
+int main()
+{
+    std::vector<Gain> gains( size_t( matrix_size ) * matrix_size );
+    for ( size_t i = 0; i < gains.size(); ++i )
+    {
+        gains[i].setValue( -float( i % 900 ) / 10 );
+    }
+
+    // the per cell name is longer than the small string buffer, as a descriptive name usually is
+    const string name = "crosspoint gain value";
+    Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+    vector<vector<vector<ControlValue> > > nested;
+    countAllocations( "nested vectors", [&]()
+                      {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            nested.emplace_back();
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                nested.back().emplace_back();
+                nested.back().back().push_back( ControlValue{name, &gains[row * matrix_size + col]} );
+            }
+        }
+    } );
+
+    Descriptor::MatrixPtr by_cell
+        = Descriptor::makeMatrix( AVDECC_AEM_CONTROL_TYPE_GAIN, "Mix Matrix", AVDECC_CONTROL_VALUE_LINEAR_INT32 );
+    countAllocations( "Matrix addValue()", [&]()
+                      {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            by_cell->addRow( configuration, row );
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                by_cell->addColumn();
+                by_cell->addValue( ControlValue{name, &gains[row * matrix_size + col]} );
+            }
+        }
+    } );
+
+    Descriptor::MatrixPtr by_array
+        = Descriptor::makeMatrix( AVDECC_AEM_CONTROL_TYPE_GAIN, "Mix Matrix", AVDECC_CONTROL_VALUE_LINEAR_INT32 );
+    countAllocations( "Matrix addValues()", [&]()
+                      {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            by_array->addRow( configuration, row );
+        }
+        by_array->addValues( name, gains.data(), gains.size(), matrix_size, matrix_size );
+    } );
+
+    float sum = 0;
+    double nested_read_us = timeIt( [&]()
+                                    {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                sum += nested[row][col][0].m_ranged_value->getUnencodedValueFloat();
+            }
+        }
+    } );
+    double by_cell_read_us = timeIt( [&]()
+                                     {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                sum += by_cell->getRangedValue( 0, col, row )->getUnencodedValueFloat();
+            }
+        }
+    } );
+    double by_array_read_us = timeIt( [&]()
+                                      {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                sum += by_array->getRangedValue( 0, col, row )->getUnencodedValueFloat();
+            }
+        }
+    } );
+    double typed_read_us = timeIt( [&]()
+                                   {
+        MatrixValues const &values = by_array->getValues( 0 );
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            Gain const *p = values.getRow<Gain>( row );
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                sum += p[col * values.getColumnStride()].getValue();
+            }
+        }
+    } );
+    std::cout << "read all: nested " << nested_read_us << " us, addValue() " << by_cell_read_us << " us, addValues() "
+              << by_array_read_us << " us, getRow<Gain>() " << typed_read_us << " us" << std::endl;
+
+    std::vector<uint8_t> expected( matrix_size * 4 );
+    std::vector<uint8_t> wire( matrix_size * 4 );
+    bool same = true;
+    double nested_encode_us = timeIt( [&]()
+                                      {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            FixedBuffer pdu( expected.data(), uint16_t( expected.size() ) );
+            for ( uint16_t col = 0; col < matrix_size; ++col )
+            {
+                pdu.putQuadlet( uint32_t( nested[row][col][0].m_ranged_value->getEncodedValueInt32() ) );
+            }
+        }
+    } );
+    double by_cell_encode_us = timeIt( [&]()
+                                       {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            FixedBuffer pdu( wire.data(), uint16_t( wire.size() ) );
+            by_cell->storeValuesToPDU( pdu, 0, 0, row, matrix_size, 1 );
+        }
+    } );
+    same &= wire == expected;
+    double by_array_encode_us = timeIt( [&]()
+                                        {
+        for ( uint16_t row = 0; row < matrix_size; ++row )
+        {
+            FixedBuffer pdu( wire.data(), uint16_t( wire.size() ) );
+            by_array->storeValuesToPDU( pdu, 0, 0, row, matrix_size, 1 );
+        }
+    } );
+    same &= wire == expected;
+    std::cout << "encode all rows: nested " << nested_encode_us << " us, addValue() " << by_cell_encode_us
+              << " us, addValues() " << by_array_encode_us << " us" << std::endl;
+
+    std::cout << ( same ? "all layouts encode the same" : "MISMATCH" ) << std::endl;
+    return same && sum != 0 ? 0 : 255;
+}
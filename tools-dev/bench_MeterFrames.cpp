@@ -0,0 +1,191 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of delivering 1000 VU meters at 30 Hz to 100 clients. The
+/// meters change on every 1 ms audio block. Each client either subscribes
+/// to the meters as a set of changed controls with a 33 ms max update
+/// period, and reads the value of each changed control it is given, or
+/// has a meter subscription to the group with a 33 ms period, and copies
+/// the frame it is given.
+///
+/// The share of one core used by the notifiers is reported, as the time
+/// taken over the simulated time.
+///
+
+static const size_t num_meters = 1000;
+static const size_t num_clients = 100;
+static const Milliseconds frame_period( 33 );
+
+struct MeterProcessing
+{
+    std::vector<VuMeterDbFsPeak> m_meter;
+    Descriptor::EntityInfo m_entity;
+
+    MeterProcessing() : m_meter( num_meters ) {}
+
+    ///
+    /// Write new levels as the audio thread would on each block
+    ///
+    void process( size_t block )
+    {
+        for ( size_t i = 0; i < m_meter.size(); ++i )
+        {
+            m_meter[i].setValue( -float( ( block + i ) % 128 ) / 10.0f );
+        }
+    }
+};
+
+class MeterSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    MeterProcessing *m_processing;
+
+  public:
+    MeterSchemaGenerator( ControlContainerPtr root, MeterProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Bench Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_meter = m_root->addItem( "meter" );
+        for ( size_t i = 0; i < m_processing->m_meter.size(); ++i )
+        {
+            Descriptor::ControlPtr meter = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_AUDIO_METERS,
+                                                                    formstring( "Meter ", i + 1 ),
+                                                                    AVDECC_CONTROL_VALUE_LINEAR_INT8,
+                                                                    ControlValue{"meter", &m_processing->m_meter[i]} );
+            configuration->addChildDescriptor( meter );
+            schema_meter->addItem( formstring( i + 1 ), meter );
+        }
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+///
+/// Run the blocks of duration_in_milliseconds, ticking the notifiers of schema after each, and report the time taken
+///
+static void run( const char *name,
+                 MeterProcessing &processing,
+                 Schema &schema,
+                 size_t duration_in_milliseconds,
+                 bool report_changes,
+                 size_t const &frames )
+{
+    ControlIdentitySet meters;
+    for ( auto const &e : schema.getValueIndex().getEntries() )
+    {
+        meters.insert( e.m_key );
+    }
+
+    std::chrono::nanoseconds duration( 0 );
+    for ( size_t block = 1; block <= duration_in_milliseconds; ++block )
+    {
+        Milliseconds now( block );
+        processing.process( block );
+
+        auto start = std::chrono::steady_clock::now();
+        if ( report_changes )
+        {
+            schema.getChangeManager().controlsChanged( now, meters );
+        }
+        schema.getChangeManager().tick( now );
+        duration += std::chrono::steady_clock::now() - start;
+    }
+
+    double ms_per_block = double( duration.count() ) / 1.0e6 / double( duration_in_milliseconds );
+    std::cout << std::left << std::setw( 18 ) << name << std::right << std::setw( 10 ) << std::fixed << std::setprecision( 1 )
+              << ms_per_block * 1000.0 << " us/block" << std::setw( 8 ) << ms_per_block * 100.0 << " % of a core"
+              << std::setw( 10 ) << frames << " frames" << std::endl;
+}
+
+int main( int argc, char **argv )
+{
+    size_t duration_in_milliseconds = argc > 1 ? size_t( atol( argv[1] ) ) : 300;
+
+    MeterProcessing processing;
+    ControlContainerPtr top = ControlContainer::create();
+    MeterSchemaGenerator generator( top, &processing );
+    generator.generate();
+    Schema schema( top );
+
+    std::cout << num_meters << " meters to " << num_clients << " clients every " << frame_period.count() << " ms for "
+              << duration_in_milliseconds << " ms of 1 ms blocks" << std::endl;
+
+    {
+        size_t frames = 0;
+        std::vector<ChangeNotifierPtr> clients;
+        for ( size_t i = 0; i < num_clients; ++i )
+        {
+            auto sub = std::make_shared<ControlIdentityComparatorSet>();
+            for ( auto const &e : schema.getValueIndex().getEntries() )
+            {
+                sub->addItem( e.m_key.toIdentity() );
+            }
+
+            auto client = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+            std::vector<int8_t> levels( num_meters );
+            client->addSubscription( sub,
+                                     frame_period,
+                                     Milliseconds( 0 ),
+                                     Milliseconds( 0 ),
+                                     [&schema, &frames, levels]( Milliseconds,
+                                                                 ControlIdentityComparatorPtr const &,
+                                                                 ControlIdentityBitmap const &items ) mutable
+                                     {
+                                         size_t i = 0;
+                                         for ( auto const &key : items )
+                                         {
+                                             levels[i++ % levels.size()]
+                                                 = schema.getValueIndex().find( key )->m_ranged_value->getEncodedValueInt8();
+                                         }
+                                         ++frames;
+                                     } );
+            schema.getChangeManager().addChangeNotifier( client );
+            clients.push_back( client );
+        }
+        run( "changed controls", processing, schema, duration_in_milliseconds, true, frames );
+        for ( auto const &client : clients )
+        {
+            schema.getChangeManager().removeChangeNotifier( client );
+        }
+    }
+
+    {
+        size_t frames = 0;
+        auto group = std::make_shared<MeterGroup>( schema, schema.getIdentityForPath( "/meter/1" ), num_meters );
+        std::vector<ChangeNotifierPtr> clients;
+        for ( size_t i = 0; i < num_clients; ++i )
+        {
+            auto client = std::make_shared<ChangeNotifier>( Milliseconds( 0 ) );
+            std::vector<int8_t> levels( num_meters );
+            client->addMeterSubscription( group,
+                                          frame_period,
+                                          Milliseconds( 0 ),
+                                          [&frames, levels]( MeterFrame const &frame ) mutable
+                                          {
+                                              std::copy( frame.m_levels.begin(), frame.m_levels.end(), levels.begin() );
+                                              ++frames;
+                                          } );
+            schema.getChangeManager().addChangeNotifier( client );
+            clients.push_back( client );
+        }
+
+        // the meters are not reported as changed, the group samples them
+        run( "meter frames", processing, schema, duration_in_milliseconds, false, frames );
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/RangedValue.hpp"
+
+using namespace ControlPlane;
+
+///
+/// Benchmark of setting a RangedValue and converting it to and from its
+/// encoded type, for a set of encoded and value type combinations
+///
+
+static const size_t num_values = 4096;
+static const size_t iterations = 2000;
+
+template <typename F>
+static double timeIt( F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        f();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( iterations * num_values );
+}
+
+template <typename RangedT>
+static void benchEncoding( const char *name )
+{
+    using value_type = typename RangedT::value_type;
+    using encoded_type = typename RangedT::encoded_type;
+
+    RangedT ranged;
+    std::vector<value_type> values;
+    std::vector<encoded_type> encoded;
+    int64_t steps = ( RangedT::max_value - RangedT::min_value ) / RangedT::step_value + 1;
+    for ( size_t i = 0; i < num_values; ++i )
+    {
+        int64_t step = int64_t( i * 7919 ) % steps;
+        values.push_back( ranged.getMinValue() + value_type( step ) * ranged.getStepValue() );
+        encoded.push_back( encoded_type( RangedT::min_value + step * RangedT::step_value ) );
+    }
+
+    size_t changes = 0;
+    double set_ns = timeIt( [&]()
+                            {
+        for ( value_type v : values )
+        {
+            changes += ranged.setValue( v ) ? 1 : 0;
+        }
+    } );
+
+    encoded_type sum = 0;
+    double encode_ns = timeIt( [&]()
+                               {
+        for ( value_type v : values )
+        {
+            ranged.setValue( v );
+            encoded_type e;
+            ranged.getEncodedValue( &e );
+            sum += e;
+        }
+    } );
+
+    double decode_ns = timeIt( [&]()
+                               {
+        for ( encoded_type e : encoded )
+        {
+            changes += ranged.setFromEncodedValue( e ) ? 1 : 0;
+        }
+    } );
+
+    std::cout << std::left << std::setw( 18 ) << name << " set " << std::fixed << std::setprecision( 2 ) << set_ns
+              << " ns, set+encode " << encode_ns << " ns, decode+set " << decode_ns << " ns"
+              << ( changes + size_t( sum ) == 0 ? " (no changes)" : "" ) << std::endl;
+}
+
+int main()
+{
+    benchEncoding<RangedValue<UnitsCode::LevelDbFsPeak, -128, 0, 0, 1, -1, int8_t, float>>( "int8/float" );
+    benchEncoding<RangedValue<UnitsCode::Unitless, 0, 255, 0, 1, 0, uint8_t, float>>( "uint8/float" );
+    benchEncoding<RangedValue<UnitsCode::LevelDb, -9000, 1000, 0, 1, -2, int16_t, float>>( "int16/float" );
+    benchEncoding<RangedValue<UnitsCode::LevelDb, -900, 100, 0, 10, -1, int32_t, float>>( "int32/float" );
+    benchEncoding<RangedValue<UnitsCode::LevelDb, -900, 100, 0, 10, -1, int32_t, float, RangedValuePlainStorage>>(
+        "int32/float plain" );
+    benchEncoding<RangedValue<UnitsCode::TimeSeconds, 0, 1000000, 0, 1, -3, int32_t, double>>( "int32/double" );
+    benchEncoding<RangedValue<UnitsCode::Unitless, 0, 65535, 0, 1, 0, uint16_t, int32_t>>( "uint16/int32" );
+    benchEncoding<RangedValue<UnitsCode::Unitless, -1000, 1000, 0, 1, -1, float, float>>( "float/float" );
+    return 0;
+}
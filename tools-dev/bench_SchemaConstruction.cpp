@@ -0,0 +1,199 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/Text.hpp"
+#include "ControlPlane/Values.hpp"
+#include "AllocationCounter.hpp"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of the start up of the control plane: SchemaGenerator::generate(),
+/// the Schema constructor and the SchemaTextAdaptor constructor, for
+/// synthesized schemas of about 1k, 10k, 100k and 1M controls. About half of
+/// the controls of the smaller schemas are CONTROL descriptors with a gain
+/// and a mute per channel, and the rest are a square gain matrix.
+///
+/// For each phase the elapsed time, the number of heap allocations, the
+/// resident set size after the phase and the peak resident set size of the
+/// process so far are reported. Pass the largest size to run as the first
+/// argument to stop early.
+///
+
+static size_t max_channels = 16384;
+
+struct BenchChannel
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct BenchProcessing
+{
+    std::vector<BenchChannel> m_input;
+    size_t m_matrix_size;
+    std::vector<Gain> m_matrix;
+    Descriptor::EntityInfo m_entity;
+
+    BenchProcessing( size_t num_channels, size_t matrix_size )
+        : m_input( num_channels ), m_matrix_size( matrix_size ), m_matrix( matrix_size * matrix_size )
+    {
+    }
+
+    size_t getNumControls() const { return m_input.size() * 2 + m_matrix.size(); }
+};
+
+class BenchSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    BenchProcessing *m_processing;
+
+  public:
+    BenchSchemaGenerator( ControlContainerPtr root, BenchProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Bench Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_input = m_root->addItem( "input" );
+        for ( size_t chan = 0; chan < m_processing->m_input.size(); ++chan )
+        {
+            ControlContainerPtr schema_chan = schema_input->addItem( formstring( chan + 1 ) );
+            Descriptor::ControlPtr gain = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_GAIN,
+                                                                   formstring( "Input ", chan + 1, " Gain" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_INT32,
+                                                                   ControlValue{"gain", &m_processing->m_input[chan].m_gain} );
+            configuration->addChildDescriptor( gain );
+            schema_chan->addItem( "gain", gain );
+
+            Descriptor::ControlPtr mute = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_MUTE,
+                                                                   formstring( "Input ", chan + 1, " Mute" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_UINT8,
+                                                                   ControlValue{"mute", &m_processing->m_input[chan].m_mute} );
+            configuration->addChildDescriptor( mute );
+            schema_chan->addItem( "mute", mute );
+        }
+
+        size_t matrix_size = m_processing->m_matrix_size;
+        Descriptor::MatrixPtr matrix
+            = Descriptor::makeMatrix( AVDECC_AEM_CONTROL_TYPE_GAIN, "Mix Matrix", AVDECC_CONTROL_VALUE_LINEAR_INT32 );
+        for ( size_t row = 0; row < matrix_size; ++row )
+        {
+            matrix->addRow( configuration, uint16_t( row ) );
+            for ( size_t col = 0; col < matrix_size; ++col )
+            {
+                matrix->addColumn();
+                matrix->addValue( ControlValue{"gain", &m_processing->m_matrix[row * matrix_size + col]} );
+            }
+        }
+        configuration->addChildDescriptor( matrix );
+        m_root->addItem( "matrix", matrix );
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+static double getResidentMegabytes()
+{
+    double r = 0.0;
+#ifdef __linux__
+    FILE *f = fopen( "/proc/self/statm", "r" );
+    if ( f )
+    {
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        if ( fscanf( f, "%lu %lu", &size, &resident ) == 2 )
+        {
+            r = double( resident ) * double( sysconf( _SC_PAGESIZE ) ) / ( 1024.0 * 1024.0 );
+        }
+        fclose( f );
+    }
+#endif
+    return r;
+}
+
+static double getPeakResidentMegabytes()
+{
+    double r = 0.0;
+#ifndef _WIN32
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+#ifdef __APPLE__
+        r = double( usage.ru_maxrss ) / ( 1024.0 * 1024.0 );
+#else
+        r = double( usage.ru_maxrss ) / 1024.0;
+#endif
+    }
+#endif
+    return r;
+}
+
+template <typename F>
+static void phase( const char *name, F f )
+{
+    size_t allocations = allocation_count;
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+    allocations = allocation_count - allocations;
+
+    std::cout << "  " << std::left << std::setw( 10 ) << name << std::right << std::setw( 10 ) << std::fixed
+              << std::setprecision( 1 ) << double( duration.count() ) / 1000.0 << " ms" << std::setw( 12 ) << allocations
+              << " allocs" << std::setw( 10 ) << getResidentMegabytes() << " MB rss" << std::setw( 10 )
+              << getPeakResidentMegabytes() << " MB peak" << std::endl;
+}
+
+static void run( size_t target_controls )
+{
+    size_t num_channels = std::min( target_controls / 4, max_channels );
+    size_t matrix_size = size_t( std::sqrt( double( target_controls - num_channels * 2 ) ) + 0.5 );
+
+    BenchProcessing processing( num_channels, matrix_size );
+    std::cout << "schema of " << processing.getNumControls() << " controls: " << num_channels * 2 << " in "
+              << num_channels << " channels, " << matrix_size << " x " << matrix_size << " matrix" << std::endl;
+
+    ControlContainerPtr top = ControlContainer::create();
+    std::unique_ptr<Schema> schema;
+    std::unique_ptr<Text::SchemaTextAdaptor> adaptor;
+
+    phase( "generate",
+           [&]()
+           {
+               BenchSchemaGenerator generator( top, &processing );
+               generator.generate();
+           } );
+    phase( "schema", [&]() { schema.reset( new Schema( top ) ); } );
+    phase( "adaptor", [&]() { adaptor.reset( new Text::SchemaTextAdaptor( *schema, Text::getTextAddressForIdentity ) ); } );
+    phase( "destroy",
+           [&]()
+           {
+               adaptor.reset();
+               schema.reset();
+               top.reset();
+           } );
+}
+
+int main( int argc, char **argv )
+{
+    size_t largest = argc > 1 ? size_t( atol( argv[1] ) ) : 1000000;
+
+    for ( size_t target_controls = 1000; target_controls <= largest; target_controls *= 10 )
+    {
+        run( target_controls );
+    }
+    return 0;
+}
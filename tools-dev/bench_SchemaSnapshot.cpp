@@ -0,0 +1,138 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/SchemaSnapshot.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of SchemaSnapshot capture and restore on a schema of about
+/// 50,000 controls: 1000 input channels with a gain and a mute each, and a
+/// 220 x 220 gain matrix
+///
+
+static const size_t num_channels = 1000;
+static const size_t matrix_size = 220;
+
+struct BenchChannel
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct BenchProcessing
+{
+    std::vector<BenchChannel> m_input;
+    std::vector<Gain> m_matrix;
+    Descriptor::EntityInfo m_entity;
+
+    BenchProcessing() : m_input( num_channels ), m_matrix( matrix_size * matrix_size ) {}
+};
+
+class BenchSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    BenchProcessing *m_processing;
+
+  public:
+    BenchSchemaGenerator( ControlContainerPtr root, BenchProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Bench Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_input = m_root->addItem( "input" );
+        for ( size_t chan = 0; chan < m_processing->m_input.size(); ++chan )
+        {
+            ControlContainerPtr schema_chan = schema_input->addItem( formstring( chan + 1 ) );
+            Descriptor::ControlPtr gain = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_GAIN,
+                                                                   formstring( "Input ", chan + 1, " Gain" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_INT32,
+                                                                   ControlValue{"gain", &m_processing->m_input[chan].m_gain} );
+            configuration->addChildDescriptor( gain );
+            schema_chan->addItem( "gain", gain );
+
+            Descriptor::ControlPtr mute = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_MUTE,
+                                                                   formstring( "Input ", chan + 1, " Mute" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_UINT8,
+                                                                   ControlValue{"mute", &m_processing->m_input[chan].m_mute} );
+            configuration->addChildDescriptor( mute );
+            schema_chan->addItem( "mute", mute );
+        }
+
+        Descriptor::MatrixPtr matrix
+            = Descriptor::makeMatrix( AVDECC_AEM_CONTROL_TYPE_GAIN, "Mix Matrix", AVDECC_CONTROL_VALUE_LINEAR_INT32 );
+        for ( size_t row = 0; row < matrix_size; ++row )
+        {
+            matrix->addRow( configuration, uint16_t( row ) );
+            for ( size_t col = 0; col < matrix_size; ++col )
+            {
+                matrix->addColumn();
+                matrix->addValue( ControlValue{"gain", &m_processing->m_matrix[row * matrix_size + col]} );
+            }
+        }
+        configuration->addChildDescriptor( matrix );
+        m_root->addItem( "matrix", matrix );
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+template <typename F>
+static double timeIt( size_t iterations, F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        f();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( iterations );
+}
+
+int main()
+{
+    static const size_t iterations = 20;
+
+    BenchProcessing processing;
+    ControlContainerPtr top = ControlContainer::create();
+    BenchSchemaGenerator generator( top, &processing );
+    generator.generate();
+
+    auto start = std::chrono::steady_clock::now();
+    Schema schema( top );
+    auto build_time = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+    std::cout << "schema: " << schema.getValueIndex().size() << " controls, built in " << build_time.count() << " ms"
+              << std::endl;
+
+    SchemaSnapshot snapshot;
+    double capture_us = timeIt( iterations, [&]() { snapshot = SchemaSnapshot::capture( schema ); } );
+    std::cout << "capture: " << capture_us << " us, " << snapshot.getBlob().size() << " bytes" << std::endl;
+
+    double unchanged_us = timeIt( iterations, [&]() { snapshot.restore( schema, nullptr, Milliseconds( 0 ) ); } );
+    std::cout << "restore, no changes: " << unchanged_us << " us, "
+              << double( snapshot.getNumItems() ) / unchanged_us << " controls/us" << std::endl;
+
+    size_t changed = 0;
+    double changed_us = timeIt( iterations,
+                                [&]()
+                                {
+        for ( auto &i : processing.m_matrix )
+        {
+            i.setValue( -6.0f );
+        }
+        changed = snapshot.restore( schema, nullptr, Milliseconds( 0 ) );
+    } );
+    std::cout << "restore, " << changed << " changes (including setup): " << changed_us << " us" << std::endl;
+
+    return changed == processing.m_matrix.size() ? 0 : 255;
+}
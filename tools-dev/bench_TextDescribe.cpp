@@ -0,0 +1,212 @@
+#include "ControlPlane/World.hpp"
+#include "ControlPlane/Schema.hpp"
+#include "ControlPlane/SchemaGenerator.hpp"
+#include "ControlPlane/Text.hpp"
+#include "ControlPlane/Values.hpp"
+
+using namespace ControlPlane;
+using namespace ControlPlane::Util;
+
+///
+/// Benchmark of the text protocol's describe and get of every control of a
+/// schema of 10,000 controls, 5000 input channels with a gain and a mute
+/// each, and of formatting and parsing their values with Util's number
+/// functions against a stringstream
+///
+
+static const size_t num_channels = 5000;
+
+struct BenchChannel
+{
+    Mute m_mute;
+    Gain m_gain;
+};
+
+struct BenchProcessing
+{
+    std::vector<BenchChannel> m_input;
+    Descriptor::EntityInfo m_entity;
+
+    BenchProcessing() : m_input( num_channels ) {}
+};
+
+class BenchSchemaGenerator : public SchemaGenerator
+{
+    Descriptor::DescriptorCounts m_counts;
+    BenchProcessing *m_processing;
+
+  public:
+    BenchSchemaGenerator( ControlContainerPtr root, BenchProcessing *processing )
+        : SchemaGenerator( root, m_counts ), m_processing( processing )
+    {
+    }
+
+    ControlContainerPtr generate() override
+    {
+        Descriptor::EntityPtr entity = makeEntity( "Bench Entity", &m_processing->m_entity );
+        Descriptor::DescriptorPtr configuration = Descriptor::makeConfiguration( "Default" );
+
+        ControlContainerPtr schema_input = m_root->addItem( "input" );
+        for ( size_t chan = 0; chan < m_processing->m_input.size(); ++chan )
+        {
+            ControlContainerPtr schema_chan = schema_input->addItem( formstring( chan + 1 ) );
+            Descriptor::ControlPtr gain = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_GAIN,
+                                                                   formstring( "Input ", chan + 1, " Gain" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_INT32,
+                                                                   ControlValue{"gain", &m_processing->m_input[chan].m_gain} );
+            configuration->addChildDescriptor( gain );
+            schema_chan->addItem( "gain", gain );
+
+            Descriptor::ControlPtr mute = Descriptor::makeControl( AVDECC_AEM_CONTROL_TYPE_MUTE,
+                                                                   formstring( "Input ", chan + 1, " Mute" ),
+                                                                   AVDECC_CONTROL_VALUE_LINEAR_UINT8,
+                                                                   ControlValue{"mute", &m_processing->m_input[chan].m_mute} );
+            configuration->addChildDescriptor( mute );
+            schema_chan->addItem( "mute", mute );
+        }
+
+        entity->addChildDescriptor( configuration );
+        entity->collectOwnedDescriptors( m_counts, m_root );
+
+        return m_root;
+    }
+};
+
+///
+/// Counts the lines and bytes of the responses instead of sending them
+///
+struct CountingIO : public Text::TextIO
+{
+    size_t m_lines = 0;
+    size_t m_bytes = 0;
+
+    void sendLine( string const &line ) override
+    {
+        ++m_lines;
+        m_bytes += line.size();
+    }
+
+    bool receiveLine( string * ) override { return false; }
+};
+
+template <typename F>
+static double timeIt( size_t iterations, F f )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        f();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start );
+    return double( duration.count() ) / double( iterations );
+}
+
+int main()
+{
+    static const size_t iterations = 10;
+
+    BenchProcessing processing;
+    for ( size_t chan = 0; chan < processing.m_input.size(); ++chan )
+    {
+        processing.m_input[chan].m_gain.setValue( -float( chan % 900 ) / 10 );
+    }
+    ControlContainerPtr top = ControlContainer::create();
+    BenchSchemaGenerator generator( top, &processing );
+    generator.generate();
+    Schema schema( top );
+
+    Text::SchemaTextAdaptor adaptor( schema, Text::getTextAddressForIdentity );
+    CountingIO io;
+    Text::TextProtocolSession session( io, adaptor, std::make_shared<ControlIdentityComparatorNone>() );
+
+    std::vector<string> describes;
+    std::vector<string> gets;
+    for ( auto const &i : adaptor.getAddressMap() )
+    {
+        describes.push_back( "?" + i.first.m_value );
+        gets.push_back( i.first.m_value );
+    }
+    std::cout << "schema: " << schema.getValueIndex().size() << " controls, " << describes.size() << " addresses" << std::endl;
+
+    double describe_us = timeIt( iterations,
+                                 [&]()
+                                 {
+        for ( auto const &line : describes )
+        {
+            session.handleLine( Milliseconds( 0 ), line );
+        }
+    } );
+    std::cout << "describe dump: " << describe_us / 1000.0 << " ms, " << io.m_bytes / iterations << " bytes" << std::endl;
+
+    double get_us = timeIt( iterations,
+                            [&]()
+                            {
+        for ( auto const &line : gets )
+        {
+            session.handleLine( Milliseconds( 0 ), line );
+        }
+    } );
+    std::cout << "get dump: " << get_us / 1000.0 << " ms" << std::endl;
+
+    std::vector<float> values;
+    for ( auto const &chan : processing.m_input )
+    {
+        values.push_back( chan.m_gain.getValue() );
+    }
+
+    size_t length = 0;
+    double stream_format_us = timeIt( iterations,
+                                      [&]()
+                                      {
+        for ( float v : values )
+        {
+            std::ostringstream buf;
+            buf << v;
+            length += buf.str().size();
+        }
+    } );
+    double util_format_us = timeIt( iterations,
+                                    [&]()
+                                    {
+        char buf[max_number_length];
+        for ( float v : values )
+        {
+            length += formatNumber( buf, v, Gain::multiplier_power );
+        }
+    } );
+    std::cout << "format " << values.size() << " gains: stringstream " << stream_format_us << " us, Util " << util_format_us
+              << " us" << std::endl;
+
+    std::vector<string> texts;
+    for ( float v : values )
+    {
+        char buf[max_number_length];
+        texts.push_back( string( buf, formatNumber( buf, v, Gain::multiplier_power ) ) );
+    }
+    float sum = 0;
+    double stream_parse_us = timeIt( iterations,
+                                     [&]()
+                                     {
+        for ( auto const &text : texts )
+        {
+            std::istringstream buf( text );
+            float v = 0;
+            buf >> v;
+            sum += v;
+        }
+    } );
+    double util_parse_us = timeIt( iterations,
+                                   [&]()
+                                   {
+        for ( auto const &text : texts )
+        {
+            float v;
+            parseNumber( text, v );
+            sum += v;
+        }
+    } );
+    std::cout << "parse " << texts.size() << " gains: stringstream " << stream_parse_us << " us, Util " << util_parse_us
+              << " us" << std::endl;
+
+    return length > 0 && sum != 0 ? 0 : 255;
+}